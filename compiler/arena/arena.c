@@ -5,43 +5,195 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 #include "arena/arena.h"
+#include "symbol_table/string_table.h"
+#include "symbol_table/type_table.h"
+#include "symbol_table/symbol_table.h"
+#include "ast/ast.h"
 
 
-static size_t alloc_count = 0;
+// regular chunks start at least this big and double up to ARENA_CHUNK_MAX, an allocation larger
+// than a quarter of the next regular chunk gets a chunk of its own
+#define ARENA_CHUNK_MIN (4 * 1024)
+#define ARENA_CHUNK_MAX (64 * 1024 * 1024)
 
-void* arena_alloc(Arena* arena, size_t old_data_size, Compiler* compiler) {
+// a reserved arena's range, mapped without access so it takes no memory until a commit makes part of
+// it writable. commits double from ARENA_COMMIT_MIN up to steps of ARENA_COMMIT_MAX, and the pages are
+// only backed once something is written to them
+#define ARENA_RESERVE ((size_t)16 * 1024 * 1024 * 1024)
+#define ARENA_COMMIT_MIN ((size_t)64 * 1024)
+#define ARENA_COMMIT_MAX ((size_t)2 * 1024 * 1024)
+
+static arena_chunk* new_chunk(size_t capacity) {
+    arena_chunk* chunk = malloc(sizeof(arena_chunk) + capacity);
+    if (!chunk) return NULL;
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    return chunk;
+}
+
+// makes enough of a reserved range writable for needed bytes of data, false when chunk is not the
+// reservation or the range is used up, the arena then grows by chunks like any other
+static bool commit_reserved(Arena* arena, arena_chunk* chunk, size_t needed) {
+    if (chunk != arena->reservation || needed > ARENA_RESERVE - sizeof(arena_chunk)) return false;
+    size_t committed = sizeof(arena_chunk) + chunk->capacity;
+    size_t target = committed + (committed < ARENA_COMMIT_MAX ? committed : ARENA_COMMIT_MAX);
+    size_t wanted = (sizeof(arena_chunk) + needed + ARENA_COMMIT_MIN - 1) / ARENA_COMMIT_MIN * ARENA_COMMIT_MIN;
+    if (target < wanted) target = wanted;
+    if (target > ARENA_RESERVE) target = ARENA_RESERVE;
+    if (mprotect((uint8_t*)chunk + committed, target - committed, PROT_READ | PROT_WRITE) != 0) return false;
+    arena->capacity += target - committed;
+    chunk->capacity = target - sizeof(arena_chunk);
+    arena->growths++;
+    return true;
+}
+
+void* arena_try_alloc(Arena* arena, size_t old_data_size) {
     size_t data_size = (old_data_size + 7) & ~7; // Align to 8 bytes
-    alloc_count++;
-    if (arena->current_size + data_size > arena->capacity) {
-        size_t new_capacity = arena->capacity;
-        
-        // Calculate new capacity (doubling until it fits the new data)
-        while (arena->current_size + data_size > new_capacity) {
-            new_capacity *= 2;
+    arena->allocations++;
+    arena->requested += old_data_size;
+    arena->padding += data_size - old_data_size;
+    arena_chunk* chunk = arena->chunks;
+    if (chunk->used + data_size > chunk->capacity && !commit_reserved(arena, chunk, chunk->used + data_size)) {
+        // nothing handed out moves, growing is one malloc however much the arena already holds
+        if (data_size > arena->next_chunk / 4) {
+            // linked in behind the current chunk, which keeps its free space for the small allocations
+            arena_chunk* large = new_chunk(data_size);
+            if (!large) return NULL;
+            large->used = data_size;
+            large->next = chunk->next;
+            chunk->next = large;
+            arena->capacity += data_size;
+            arena->current_size += data_size;
+            arena->chunk_count++;
+            arena->growths++;
+            if (arena->current_size > arena->high_water) arena->high_water = arena->current_size;
+            return large->data;
         }
-        void* new_data = malloc(new_capacity);
-        if (!new_data) {
-            panic(ERROR_MEMORY_ALLOCATION, "Not enough memory to grow arena", compiler);
+        arena->stranded += chunk->capacity - chunk->used;
+        if (arena->spare && arena->spare->capacity >= data_size) {
+            // a rewind gave this one back, it is still counted in capacity
+            chunk = arena->spare;
+            arena->spare = NULL;
+            chunk->used = 0;
         }
-        memcpy(new_data, arena->data, arena->current_size);
-        free(arena->data);
-        arena->data = (uint8_t*)new_data;
-        arena->capacity = new_capacity;
+        else {
+            chunk = new_chunk(arena->next_chunk);
+            if (!chunk) return NULL;
+            arena->capacity += chunk->capacity;
+            if (arena->next_chunk < ARENA_CHUNK_MAX) arena->next_chunk *= 2;
+        }
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->chunk_count++;
+        arena->growths++;
     }
 
-    void* data = &arena->data[arena->current_size];
+    void* data = &chunk->data[chunk->used];
+    chunk->used += data_size;
     arena->current_size += data_size;
+    if (arena->current_size > arena->high_water) arena->high_water = arena->current_size;
+    return data;
+}
+
+void* arena_alloc(Arena* arena, size_t old_data_size, Compiler* compiler) {
+    void* data = arena_try_alloc(arena, old_data_size);
+    if (!data) panic(ERROR_MEMORY_ALLOCATION, "Not enough memory to grow arena", compiler);
     return data;
 }
 
+arena_checkpoint arena_mark(Arena* arena) {
+    arena_checkpoint mark;
+    mark.chunk = arena->chunks;
+    mark.behind = arena->chunks->next;
+    mark.used = arena->chunks->used;
+    mark.current_size = arena->current_size;
+    return mark;
+}
+
+// a chunk allocated after the mark, the largest one is kept as the spare so functions that keep
+// crossing the same chunk boundary don't malloc and free it every time
+static void release_chunk(Arena* arena, arena_chunk* chunk) {
+    arena->chunk_count--;
+    if (!arena->spare || chunk->capacity > arena->spare->capacity) {
+        if (arena->spare) {
+            arena->capacity -= arena->spare->capacity;
+            free(arena->spare);
+        }
+        arena->spare = chunk;
+        return;
+    }
+    arena->capacity -= chunk->capacity;
+    free(chunk);
+}
+
+void arena_rewind(Arena* arena, arena_checkpoint mark) {
+    // chunks in front of the mark's chunk came after it
+    arena_chunk* chunk = arena->chunks;
+    while (chunk != mark.chunk) {
+        arena_chunk* next = chunk->next;
+        release_chunk(arena, chunk);
+        chunk = next;
+    }
+    // and so did dedicated chunks linked in right behind it
+    chunk = mark.chunk->next;
+    while (chunk != mark.behind) {
+        arena_chunk* next = chunk->next;
+        release_chunk(arena, chunk);
+        chunk = next;
+    }
+    mark.chunk->next = mark.behind;
+    mark.chunk->used = mark.used;
+    arena->chunks = mark.chunk;
+    arena->current_size = mark.current_size;
+}
+
+static void clear_arena_stats(Arena* arena) {
+    arena->allocations = 0;
+    arena->requested = 0;
+    arena->padding = 0;
+    arena->high_water = 0;
+    arena->growths = 0;
+    arena->stranded = 0;
+}
+
+// keeps the largest chunk for the next program and frees the rest, a reserved range is always kept
 void arena_reset(Arena* arena) {
+    arena_chunk* kept = arena->chunks;
+    for (arena_chunk* chunk = arena->chunks->next; chunk; chunk = chunk->next) {
+        if (chunk->capacity > kept->capacity) kept = chunk;
+    }
+    if (arena->reservation) kept = arena->reservation;
+    arena_chunk* chunk = arena->chunks;
+    while (chunk) {
+        arena_chunk* next = chunk->next;
+        if (chunk != kept) free(chunk);
+        chunk = next;
+    }
+    free(arena->spare);
+    arena->spare = NULL;
+    kept->next = NULL;
+    kept->used = 0;
+    arena->chunks = kept;
+    arena->capacity = kept->capacity;
     arena->current_size = 0;
+    arena->chunk_count = 1;
+    clear_arena_stats(arena);
 }
 
 void free_arena(Arena* arena) {
     if (arena) {
-        free(arena->data);
+        arena_chunk* chunk = arena->chunks;
+        while (chunk) {
+            arena_chunk* next = chunk->next;
+            if (chunk == arena->reservation) munmap(chunk, ARENA_RESERVE);
+            else free(chunk);
+            chunk = next;
+        }
+        free(arena->spare);
         free(arena);
     }
 }
@@ -50,45 +202,152 @@ Arena* initialize_arena(size_t capacity) {
     Arena* arena = malloc(sizeof(Arena));
     if (!arena) return NULL;
     
-    arena->data = malloc(capacity);
-    if (!arena->data) {
+    if (capacity < ARENA_CHUNK_MIN) capacity = ARENA_CHUNK_MIN;
+    arena->chunks = new_chunk(capacity);
+    if (!arena->chunks) {
         free(arena);
         return NULL;
     }
     
     arena->capacity = capacity;
     arena->current_size = 0;
+    arena->chunk_count = 1;
+    arena->next_chunk = capacity < ARENA_CHUNK_MAX ? capacity : ARENA_CHUNK_MAX;
+    arena->spare = NULL;
+    arena->reservation = NULL;
+    clear_arena_stats(arena);
     return arena;
 }
 
+Arena* reserve_arena(void) {
+    void* range = mmap(NULL, ARENA_RESERVE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (range == MAP_FAILED) return NULL;
+    Arena* arena = malloc(sizeof(Arena));
+    if (!arena || mprotect(range, ARENA_COMMIT_MIN, PROT_READ | PROT_WRITE) != 0) {
+        free(arena);
+        munmap(range, ARENA_RESERVE);
+        return NULL;
+    }
+
+    arena_chunk* chunk = range;
+    chunk->next = NULL;
+    chunk->capacity = ARENA_COMMIT_MIN - sizeof(arena_chunk);
+    chunk->used = 0;
+    arena->chunks = chunk;
+    arena->reservation = chunk;
+    arena->capacity = chunk->capacity;
+    arena->current_size = 0;
+    arena->chunk_count = 1;
+    // only used once the whole range is taken
+    arena->next_chunk = ARENA_CHUNK_MAX;
+    arena->spare = NULL;
+    clear_arena_stats(arena);
+    return arena;
+}
+
+// a reserved arena when the compiler asks for one and the address space can be had, capacity is only
+// a hint for a malloced one
+static Arena* make_arena(Compiler* compiler, size_t capacity) {
+    Arena* arena = compiler->backing == ARENA_RESERVED ? reserve_arena() : NULL;
+    return arena ? arena : initialize_arena(capacity);
+}
+
+// memory sized for one program rather than kept across programs
+static void free_program(Compiler* arenas) {
+    // the token arrays, line index and AST arrays are malloced but hang off structs that live in the arenas
+    if (arenas->tokens) {
+        free(arenas->tokens->types);
+        free(arenas->tokens->offsets);
+        free(arenas->tokens->payloads);
+        free(arenas->tokens->function_tokens);
+        free(arenas->tokens->line_starts);
+    }
+    if (arenas->ast) {
+        free(arenas->ast->nodes);
+        free(arenas->ast->function_nodes);
+        free(arenas->ast->function_bodies);
+        free_ast(arenas->ast);
+    }
+    for (size_t a = 0; a < arenas->body_arena_count; a++) free_arena(arenas->body_arenas[a]);
+    free(arenas->body_arenas);
+    if (arenas->output) fclose(arenas->output);
+}
+
 void free_global_arenas(Compiler* arenas) {
+    free_program(arenas);
     if (arenas->token_arena) free_arena(arenas->token_arena);
     if (arenas->statements_arena) free_arena(arenas->statements_arena);
     if (arenas->expressions_arena) free_arena(arenas->expressions_arena);
     if(arenas->symbol_arena) free_arena(arenas->symbol_arena);
+    if (arenas->strings) free_string_table(arenas->strings);
+    if (arenas->types) free_type_table(arenas->types);
+    if (arenas->function_map) free_function_map(arenas->function_map);
     
     if (arenas->symbol_table_stack) {
         if (arenas->symbol_table_stack->storage) {
             free(arenas->symbol_table_stack->storage);
         }
+        free_scope_bindings(arenas->symbol_table_stack);
         free(arenas->symbol_table_stack);
     }
 
+    if (arenas->parse_stack) {
+        free(arenas->parse_stack->storage);
+        free(arenas->parse_stack);
+    }
+
     if(arenas->counters) {
-        free(arenas->counters->end_whiles_stack);
-        free(arenas->counters->end_ifs_stack);
         free(arenas->counters);
     }
 
     free(arenas);
 }
 
-Compiler* init_compiler_arenas(size_t file_length) {
+void reset_compiler_arenas(Compiler* arenas) {
+    free_program(arenas);
+    arenas->tokens = NULL;
+    arenas->ast = NULL;
+    arenas->parser = NULL;
+    arenas->body_arenas = NULL;
+    arenas->body_arena_count = 0;
+    arenas->output = NULL;
+    arenas->failure = 0;
+
+    // everything else keeps the memory it grew to, init_parse_arenas reuses the parse arenas
+    arena_reset(arenas->token_arena);
+    if (arenas->statements_arena) arena_reset(arenas->statements_arena);
+    if (arenas->expressions_arena) arena_reset(arenas->expressions_arena);
+    if (arenas->symbol_arena) arena_reset(arenas->symbol_arena);
+    reset_string_table(arenas->strings);
+    reset_type_table(arenas->types);
+    arenas->symbol_table_stack->current_size = 0;
+    reset_scope_bindings(arenas->symbol_table_stack);
+    reset_function_map(arenas->function_map);
+    arenas->parse_stack->current_size = 0;
+
+    arenas->currentsize = 0;
+    arenas->counters->if_statements = 0;
+    arenas->counters->while_statements = 0;
+    arenas->counters->enclosing_while = 0;
+    arenas->return_context = false;
+    arenas->current_function_offset = 0;
+    arenas->current_function_symbol_table = NULL;
+}
+
+Compiler* init_compiler_arenas(arena_backing backing) {
     Compiler* arenas = malloc(sizeof(Compiler));
-    arenas->token_arena = initialize_arena((file_length + 1) * 10 * sizeof(token));
-    arenas->statements_arena = initialize_arena(file_length * 10 * (sizeof(statement) + sizeof(node)));
-    arenas->expressions_arena = initialize_arena(file_length * 10 * sizeof(expression));
-    arenas->symbol_arena = initialize_arena(1024 * 1024 * 8);
+    arenas->backing = backing;
+    arenas->diagnostics = stderr;
+    arenas->recover = NULL;
+    arenas->failure = 0;
+    arenas->output = NULL;
+    // the token arena only holds the token_stream header, the token arrays grow on their own,
+    // the other arenas are sized from the real token count once tokenizing is done (init_parse_arenas)
+    arenas->token_arena = initialize_arena(4 * 1024);
+    arenas->statements_arena = NULL;
+    arenas->expressions_arena = NULL;
+    arenas->symbol_arena = NULL;
+    arenas->tokens = NULL;
 
     // make the stack struct
     arenas->symbol_table_stack = malloc(sizeof(symbol_table_stack));
@@ -98,20 +357,28 @@ Compiler* init_compiler_arenas(size_t file_length) {
     arenas->symbol_table_stack->storage = malloc(16 * sizeof(symbol_table*));
     if (!arenas->symbol_table_stack->storage) panic(ERROR_MEMORY_ALLOCATION, "Symbol table stack allocation failed", arenas);
     
-    // initialize capacity
+    // initialize capacity, the global scope is pushed by init_parse_arenas
     arenas->symbol_table_stack->capacity = 16;
-    
-    // initialize global stack
-    arenas->symbol_table_stack->storage[0] = arena_alloc(arenas->symbol_arena, sizeof(symbol_table), arenas);
-    arenas->symbol_table_stack->storage[0]->parent_scope = NULL;
-    arenas->symbol_table_stack->storage[0]->scope_offset = 0;
-    arenas->symbol_table_stack->storage[0]->symbol_map = arena_alloc(arenas->symbol_arena, BUCKETS_GLOBAL_SYMBOLTABLE * sizeof(symbol_node*), arenas);
-    memset(arenas->symbol_table_stack->storage[0]->symbol_map, 0, BUCKETS_GLOBAL_SYMBOLTABLE * sizeof(symbol_node*));
+    arenas->symbol_table_stack->current_size = 0;
+    // every scope's names share one table, it grows with the names the program declares
+    init_scope_bindings(arenas->symbol_table_stack, NULL, arenas);
+    arenas->function_map = make_function_map(arenas);
 
-    arenas->symbol_table_stack->current_size = 1;
+    // list elements waiting for their list to close, grows with the longest open lists
+    arenas->parse_stack = malloc(sizeof(parse_stack));
+    if (!arenas->parse_stack) panic(ERROR_MEMORY_ALLOCATION, "Parse stack allocation failed", arenas);
+    arenas->parse_stack->storage = malloc(64 * sizeof(uint32_t));
+    if (!arenas->parse_stack->storage) panic(ERROR_MEMORY_ALLOCATION, "Parse stack allocation failed", arenas);
+    arenas->parse_stack->capacity = 64;
+    arenas->parse_stack->current_size = 0;
 
-    arenas->function_map = arena_alloc(arenas->symbol_arena, BUCKETS_FUNCTION_TABLE * sizeof(function_node**), arenas);
-    memset(arenas->function_map, 0, BUCKETS_FUNCTION_TABLE * sizeof(function_node**));
+    // identifiers are interned by the tokenizer, the table grows as new names show up
+    arenas->strings = make_string_table(1024, arenas);
+    arenas->types = make_type_table(arenas);
+    arenas->threads = 1;
+    arenas->body_arenas = NULL;
+    arenas->body_arena_count = 0;
+    arenas->parse_worker = false;
 
     // initialize parser and AST
     arenas->parser = NULL;
@@ -124,71 +391,162 @@ Compiler* init_compiler_arenas(size_t file_length) {
     arenas->counters = malloc(sizeof(counters));
     arenas->counters->if_statements = 0;
     arenas->counters->while_statements = 0;
-
-    // set all counter stacks
-    arenas->counters->end_whiles_stack = malloc(32 * sizeof(size_t)); // start with 32 nested scopes
-    arenas->counters->end_whiles_capacity = 32;
-    arenas->counters->end_whiles_current = 0;
-
-    arenas->counters->end_ifs_stack = malloc(32 * sizeof(size_t)); // start with 32 nested scopes
-    arenas->counters->end_ifs_capacity = 32;
-    arenas->counters->end_ifs_current = 0;
+    arenas->counters->enclosing_while = 0;
     
     arenas->return_context = false;
     
     return arenas;
 }
 
-void push_to_while_stack(size_t counter, Compiler* compiler) {
-    if (compiler->counters->end_whiles_current + 1 > compiler->counters->end_whiles_capacity) {
-        size_t* tmp_stack = realloc(compiler->counters->end_whiles_stack, compiler->counters->end_whiles_capacity * 2 * sizeof(size_t));
-        if (!tmp_stack) panic(ERROR_RUNTIME, "nested too many scopes, not enough memory for more", compiler);
-        else {
-            compiler->counters->end_whiles_stack = tmp_stack;
-            compiler->counters->end_whiles_capacity *= 2;
-        }
+// the AST nodes live in ast/ast.c's arrays and the data types in the type table, the statements arena only
+// holds the parser and AST headers and the expressions arena is left for whatever a phase needs per program.
+// measured on the test programs and generated files up to 4.5M tokens, the parser uses about 13 bytes of
+// symbol arena per token
+#define SYMBOL_BYTES_PER_TOKEN 32
+#define PARSE_ARENA_BASE (64 * 1024)
+
+void make_parse_arenas(Compiler* compiler, size_t token_count) {
+    compiler->statements_arena = make_arena(compiler, PARSE_ARENA_BASE);
+    compiler->expressions_arena = make_arena(compiler, PARSE_ARENA_BASE);
+    compiler->symbol_arena = make_arena(compiler, PARSE_ARENA_BASE + token_count * SYMBOL_BYTES_PER_TOKEN);
+    if (!compiler->statements_arena || !compiler->expressions_arena || !compiler->symbol_arena) {
+        panic(ERROR_MEMORY_ALLOCATION, "Parser arena allocation failed", compiler);
     }
-    compiler->counters->end_whiles_stack[compiler->counters->end_whiles_current] = counter;
-    compiler->counters->end_whiles_current += 1;
 }
 
-void pop_from_while_stack(Compiler* compiler) {
-    if (compiler->counters->end_whiles_current == 0) {
-        panic(ERROR_UNDEFINED, "Trying to pop end_while counter from no scope", compiler);
-    }
-    compiler->counters->end_whiles_current -= 1;
+void init_parse_arenas(Compiler* compiler, size_t token_count) {
+    // arenas reset_compiler_arenas kept are reused as they are, a bigger program just grows them
+    if (!compiler->statements_arena) make_parse_arenas(compiler, token_count);
+
+    // initialize global stack
+    compiler->symbol_table_stack->storage[0] = arena_alloc(compiler->symbol_arena, sizeof(symbol_table), compiler);
+    compiler->symbol_table_stack->storage[0]->parent_scope = NULL;
+    compiler->symbol_table_stack->storage[0]->scope_offset = 0;
+    compiler->symbol_table_stack->storage[0]->undo_mark = 0;
+
+    compiler->symbol_table_stack->current_size = 1;
+
+    compiler->ast = arena_alloc(compiler->statements_arena, sizeof(AST), compiler);
+    init_ast(compiler->ast, token_count, compiler);
 }
 
-size_t peek_while_stack(Compiler* compiler) {
-    if (compiler->counters->end_whiles_current == 0) {
-        panic(ERROR_UNDEFINED, "Trying to peek end_while counter from no scope pushed", compiler);
-    }
-    return compiler->counters->end_whiles_stack[compiler->counters->end_whiles_current - 1];
+static void print_memory_line(const char* name, size_t reserved, size_t used, size_t old_reserved) {
+    printf("  %-12s %14zu %14zu %14zu\n", name, reserved, used, old_reserved);
 }
 
-void push_to_if_stack(size_t counter, Compiler* compiler) {
-    if (compiler->counters->end_ifs_current + 1 > compiler->counters->end_ifs_capacity) {
-        size_t* tmp_stack = realloc(compiler->counters->end_ifs_stack, compiler->counters->end_ifs_capacity * 2 * sizeof(size_t));
-        if (!tmp_stack) panic(ERROR_RUNTIME, "nested too many scopes, not enough memory for more", compiler);
-        else {
-            compiler->counters->end_ifs_stack = tmp_stack;
-            compiler->counters->end_ifs_capacity *= 2;
+void print_memory_report(Compiler* compiler, size_t file_length) {
+    size_t token_count = compiler->tokens ? compiler->tokens->count : 0;
+
+    printf("memory report (bytes)\n");
+    printf("  %-12s %14s %14s %14s\n", "", "reserved", "used", "old sizing");
+
+    size_t token_reserved = compiler->token_arena->capacity;
+    size_t token_used = compiler->token_arena->current_size;
+    if (compiler->tokens && compiler->tokens->window) {
+        // a streaming window holds at most window tokens with one payload slot each
+        size_t held = token_count < compiler->tokens->window ? token_count : compiler->tokens->window;
+        token_reserved += compiler->tokens->window * (sizeof(uint8_t) + sizeof(uint32_t) + sizeof(token_payload));
+        token_used += held * (sizeof(uint8_t) + sizeof(uint32_t) + sizeof(token_payload));
+    }
+    else if (compiler->tokens) {
+        token_reserved += compiler->tokens->capacity * (sizeof(uint8_t) + sizeof(uint32_t)) + compiler->tokens->payload_capacity * sizeof(token_payload)
+            + compiler->tokens->function_capacity * sizeof(uint32_t);
+        token_used += token_count * (sizeof(uint8_t) + sizeof(uint32_t)) + compiler->tokens->payload_count * sizeof(token_payload)
+            + compiler->tokens->function_count * sizeof(uint32_t);
+    }
+    // the old token arena reserved ten tokens per source byte and tokenize() took another token per byte out of it
+    print_memory_line("tokens", token_reserved, token_used, (file_length + 1) * 10 * sizeof(token));
+
+    if (compiler->statements_arena) {
+        // the old sizing counted a statement and the node wrapping it per slot, that wrapper is gone
+        print_memory_line("statements", compiler->statements_arena->capacity, compiler->statements_arena->current_size, file_length * 10 * (sizeof(statement) + 2 * sizeof(void*)));
+    }
+    if (compiler->expressions_arena) {
+        print_memory_line("expressions", compiler->expressions_arena->capacity, compiler->expressions_arena->current_size, file_length * 10 * sizeof(expression));
+    }
+    if (compiler->symbol_arena) {
+        print_memory_line("symbols", compiler->symbol_arena->capacity, compiler->symbol_arena->current_size, 1024 * 1024 * 8);
+    }
+    if (compiler->body_arena_count) {
+        size_t reserved = 0, used = 0;
+        for (size_t a = 0; a < compiler->body_arena_count; a++) {
+            reserved += compiler->body_arenas[a]->capacity;
+            used += compiler->body_arenas[a]->current_size;
         }
+        print_memory_line("bodies", reserved, used, 0);
+    }
+    if (compiler->ast) {
+        // the node list used to be one pointer per token inside the statements arena
+        AST* ast = compiler->ast;
+        print_memory_line("ast nodes", ast->node_capacity * sizeof(stmt_id), ast->node_count * sizeof(stmt_id), token_count * sizeof(void*));
+        print_memory_line("ast exprs", ast->expression_capacity * sizeof(expression), ast->expression_count * sizeof(expression), 0);
+        print_memory_line("ast stmts", ast->statement_capacity * sizeof(statement), ast->statement_count * sizeof(statement), 0);
+        print_memory_line("ast lists", ast->list_capacity * sizeof(uint32_t), ast->list_count * sizeof(uint32_t), 0);
     }
-    compiler->counters->end_ifs_stack[compiler->counters->end_ifs_current] = counter;
-    compiler->counters->end_ifs_current += 1;
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        printf("  peak rss     %14ld KB\n", usage.ru_maxrss);
+    }
+}
+
+static void add_arena_stats(arena_stats* stats, const Arena* arena) {
+    if (!arena) return;
+    stats->allocations += arena->allocations;
+    stats->requested += arena->requested;
+    stats->padding += arena->padding;
+    stats->used += arena->current_size;
+    stats->high_water += arena->high_water;
+    stats->reserved += arena->capacity;
+    stats->stranded += arena->stranded;
+    stats->chunks += arena->chunk_count;
+    stats->growths += arena->growths;
+}
+
+void snapshot_memory_phase(Compiler* compiler, memory_phase* phase, const char* name) {
+    memset(phase, 0, sizeof(*phase));
+    phase->name = name;
+    add_arena_stats(&phase->arenas[REPORT_TOKENS], compiler->token_arena);
+    add_arena_stats(&phase->arenas[REPORT_STATEMENTS], compiler->statements_arena);
+    add_arena_stats(&phase->arenas[REPORT_EXPRESSIONS], compiler->expressions_arena);
+    add_arena_stats(&phase->arenas[REPORT_SYMBOLS], compiler->symbol_arena);
+    for (size_t a = 0; a < compiler->body_arena_count; a++) add_arena_stats(&phase->arenas[REPORT_BODIES], compiler->body_arenas[a]);
 }
 
-void pop_from_if_stack(Compiler* compiler) {
-    if (compiler->counters->end_ifs_current == 0) {
-        panic(ERROR_UNDEFINED, "Trying to pop end_if counter from no scope", compiler);
+static const char* report_arena_names[REPORT_ARENA_COUNT] = { "tokens", "statements", "expressions", "symbols", "bodies" };
+
+void print_memory_phase(const memory_phase* phase) {
+    printf("arenas after %s (bytes)\n", phase->name);
+    printf("  %-12s %10s %12s %10s %12s %12s %12s %12s %7s %8s\n", "", "allocs", "requested", "padding", "used", "high water", "reserved", "wasted", "chunks", "growths");
+    for (size_t a = 0; a < REPORT_ARENA_COUNT; a++) {
+        const arena_stats* stats = &phase->arenas[a];
+        // an arena that does not exist yet, or parse workers that never ran
+        if (stats->chunks == 0) continue;
+        printf("  %-12s %10zu %12zu %10zu %12zu %12zu %12zu %12zu %7zu %8zu\n", report_arena_names[a], stats->allocations, stats->requested,
+            stats->padding, stats->used, stats->high_water, stats->reserved, stats->reserved - stats->used, stats->chunks, stats->growths);
     }
-    compiler->counters->end_ifs_current -= 1;
 }
 
-size_t peek_if_stack(Compiler* compiler) {
-    if (compiler->counters->end_ifs_current == 0) {
-        panic(ERROR_UNDEFINED, "Trying to peek end_if counter from no scope pushed", compiler);
+bool write_memory_json(const char* path, const memory_phase* phases, size_t phase_count, size_t file_length) {
+    FILE* json = fopen(path, "w");
+    if (!json) return false;
+    fprintf(json, "{\n  \"source_bytes\": %zu,\n  \"phases\": [", file_length);
+    for (size_t p = 0; p < phase_count; p++) {
+        fprintf(json, "%s\n    {\n      \"phase\": \"%s\",\n      \"arenas\": {", p ? "," : "", phases[p].name);
+        bool first = true;
+        for (size_t a = 0; a < REPORT_ARENA_COUNT; a++) {
+            const arena_stats* stats = &phases[p].arenas[a];
+            if (stats->chunks == 0) continue;
+            fprintf(json, "%s\n        \"%s\": { \"allocations\": %zu, \"requested\": %zu, \"padding\": %zu, \"used\": %zu, \"high_water\": %zu, "
+                "\"reserved\": %zu, \"wasted\": %zu, \"stranded\": %zu, \"chunks\": %zu, \"growths\": %zu }",
+                first ? "" : ",", report_arena_names[a], stats->allocations, stats->requested, stats->padding, stats->used,
+                stats->high_water, stats->reserved, stats->reserved - stats->used, stats->stranded, stats->chunks, stats->growths);
+            first = false;
+        }
+        fprintf(json, "\n      }\n    }");
     }
-    return compiler->counters->end_ifs_stack[compiler->counters->end_ifs_current - 1];
+    struct rusage usage;
+    long peak = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+    fprintf(json, "\n  ],\n  \"peak_rss_kb\": %ld\n}\n", peak);
+    return fclose(json) == 0;
 }
@@ -4,20 +4,32 @@
 #include "utilities/utils.h"
 #include <stddef.h>
 
-Compiler* init_compiler_arenas(size_t file_length);\
+// ARENA_RESERVED reserves address space for each arena instead of mallocing chunks, an arena whose
+// range can't be reserved falls back to malloc
+Compiler* init_compiler_arenas(arena_backing backing);
 void arena_reset(Arena* arena);
 void free_arena(Arena* arena);
 Arena* initialize_arena(size_t capacity);
+// an arena in a reserved range that is committed as it fills, NULL if the range can't be had
+Arena* reserve_arena(void);
 void free_global_arenas(Compiler* arenas);
+// readies a compiler that finished (or panicked out of) a program for the next one, keeping its memory
+void reset_compiler_arenas(Compiler* arenas);
 void* arena_alloc(Arena* arena, size_t old_data_size, Compiler* compiler);
+// arena_alloc without the panic, NULL when the arena can't grow, for callers that must clean up first
+void* arena_try_alloc(Arena* arena, size_t old_data_size);
+// everything allocated after arena_mark is given back by arena_rewind, marks are rewound newest first
+arena_checkpoint arena_mark(Arena* arena);
+void arena_rewind(Arena* arena, arena_checkpoint mark);
+void make_parse_arenas(Compiler* compiler, size_t token_count);
+void init_parse_arenas(Compiler* compiler, size_t token_count);
+void print_memory_report(Compiler* compiler, size_t file_length);
+// --mem-report's per arena numbers at the end of each compile phase, phase names must outlive the phases
+void snapshot_memory_phase(Compiler* compiler, memory_phase* phase, const char* name);
+void print_memory_phase(const memory_phase* phase);
+// the phases and the peak rss as one JSON object, false if the file could not be written
+bool write_memory_json(const char* path, const memory_phase* phases, size_t phase_count, size_t file_length);
 
-void push_to_while_stack(size_t counter, Compiler* compiler);
-void pop_from_while_stack(Compiler* compiler);
-size_t peek_while_stack(Compiler* compiler);
-
-void push_to_if_stack(size_t counter, Compiler* compiler);
-void pop_from_if_stack(Compiler* compiler);
-size_t peek_if_stack(Compiler* compiler);
 
 
 #endif
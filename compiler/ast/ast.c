@@ -0,0 +1,209 @@
+#include "utilities/utils.h"
+#include "ast/ast.h"
+#include "error_handler/error_handler.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// measured on the test programs and generated files, a program parses into an expression every 2 to 4
+// tokens, a statement every 6 to 25 and a list entry every 3 to 10 (call heavy code is the dense end),
+// these leave room on top of that
+#define TOKENS_PER_EXPRESSION 2
+#define TOKENS_PER_STATEMENT 4
+#define TOKENS_PER_LIST_ENTRY 2
+#define AST_ARRAY_BASE 64
+
+static uint32_t reserve_count(size_t token_count, size_t tokens_per_node)
+{
+    size_t count = AST_ARRAY_BASE + token_count / tokens_per_node;
+    return count > UINT32_MAX ? UINT32_MAX : (uint32_t)count;
+}
+
+void init_ast(AST* ast, size_t token_count, Compiler* compiler)
+{
+    ast->parser = NULL;
+    ast->nodes = NULL;
+    ast->node_capacity = 0;
+    ast->node_count = 0;
+    ast->function_nodes = NULL;
+    ast->function_node_capacity = 0;
+    ast->function_node_count = 0;
+    ast->function_bodies = NULL;
+
+    ast->expression_capacity = reserve_count(token_count, TOKENS_PER_EXPRESSION);
+    ast->statement_capacity = reserve_count(token_count, TOKENS_PER_STATEMENT);
+    ast->list_capacity = reserve_count(token_count, TOKENS_PER_LIST_ENTRY);
+    ast->expressions = malloc(sizeof(expression) * ast->expression_capacity);
+    ast->statements = malloc(sizeof(statement) * ast->statement_capacity);
+    ast->lists = malloc(sizeof(uint32_t) * ast->list_capacity);
+    if (!ast->expressions || !ast->statements || !ast->lists) panic(ERROR_MEMORY_ALLOCATION, "AST allocation failed", compiler);
+
+    // slot 0 is the missing node, reading it gives a zeroed node instead of garbage
+    memset(&ast->expressions[0], 0, sizeof(expression));
+    memset(&ast->statements[0], 0, sizeof(statement));
+    ast->expression_count = 1;
+    ast->statement_count = 1;
+    ast->list_count = 0;
+}
+
+void free_ast(AST* ast)
+{
+    free(ast->expressions);
+    free(ast->statements);
+    free(ast->lists);
+    ast->expressions = NULL;
+    ast->statements = NULL;
+    ast->lists = NULL;
+}
+
+// makes room for extra more elements, doubling the array
+static void* grow_array(void* array, uint32_t count, uint32_t* capacity, size_t extra, size_t element_size, Compiler* compiler)
+{
+    if (count + extra <= *capacity) return array;
+    if (count + extra > UINT32_MAX) panic(ERROR_MEMORY_ALLOCATION, "Program has too many AST nodes", compiler);
+    size_t new_capacity = *capacity ? *capacity : AST_ARRAY_BASE;
+    while (new_capacity < count + extra) new_capacity *= 2;
+    if (new_capacity > UINT32_MAX) new_capacity = UINT32_MAX;
+    void* grown = realloc(array, new_capacity * element_size);
+    if (!grown) panic(ERROR_MEMORY_ALLOCATION, "Not enough memory to grow the AST", compiler);
+    *capacity = (uint32_t)new_capacity;
+    return grown;
+}
+
+expr_id new_expression(Compiler* compiler, ExpressionType type)
+{
+    AST* ast = compiler->ast;
+    ast->expressions = grow_array(ast->expressions, ast->expression_count, &ast->expression_capacity, 1, sizeof(expression), compiler);
+    expr_id id = ast->expression_count++;
+    memset(&ast->expressions[id], 0, sizeof(expression));
+    ast->expressions[id].type = type;
+    return id;
+}
+
+stmt_id new_statement(Compiler* compiler, StatementType type)
+{
+    AST* ast = compiler->ast;
+    ast->statements = grow_array(ast->statements, ast->statement_count, &ast->statement_capacity, 1, sizeof(statement), compiler);
+    stmt_id id = ast->statement_count++;
+    memset(&ast->statements[id], 0, sizeof(statement));
+    ast->statements[id].type = type;
+    return id;
+}
+
+uint32_t new_id_list(Compiler* compiler, const uint32_t* ids, size_t count)
+{
+    AST* ast = compiler->ast;
+    ast->lists = grow_array(ast->lists, ast->list_count, &ast->list_capacity, count, sizeof(uint32_t), compiler);
+    uint32_t start = ast->list_count;
+    if (count) memcpy(&ast->lists[start], ids, sizeof(uint32_t) * count);
+    ast->list_count += (uint32_t)count;
+    return start;
+}
+
+static inline uint32_t moved(uint32_t id, uint32_t shift)
+{
+    return id ? id + shift : 0;
+}
+
+static void move_list(uint32_t* lists, uint32_t* start, uint32_t count, uint32_t id_shift, uint32_t list_shift)
+{
+    for (uint32_t i = 0; i < count; i++) lists[*start + i] = moved(lists[*start + i], id_shift);
+    *start += list_shift;
+}
+
+uint32_t merge_ast(AST* into, AST* from, Compiler* compiler)
+{
+    // from's slot 0 is not copied, its first real node lands right after into's last one
+    uint32_t expression_shift = into->expression_count - 1;
+    uint32_t statement_shift = into->statement_count - 1;
+    uint32_t list_shift = into->list_count;
+
+    for (uint32_t e = 1; e < from->expression_count; e++) {
+        expression* expr = &from->expressions[e];
+        switch (expr->type) {
+        case EXPR_BINARY:
+            expr->binary.left = moved(expr->binary.left, expression_shift);
+            expr->binary.right = moved(expr->binary.right, expression_shift);
+            break;
+        case EXPR_UNARY:
+            expr->unary.operand = moved(expr->unary.operand, expression_shift);
+            break;
+        case EXPR_ADDRESS:
+            expr->address.operand = moved(expr->address.operand, expression_shift);
+            break;
+        case EXPR_POINTER_DEREF:
+            expr->dereference.operand = moved(expr->dereference.operand, expression_shift);
+            break;
+        case EXPR_ARR_INDEX:
+            expr->array_index.array = moved(expr->array_index.array, expression_shift);
+            expr->array_index.index = moved(expr->array_index.index, expression_shift);
+            break;
+        case EXPR_FUNCTION_CALL:
+            move_list(from->lists, &expr->func_call.arguments, expr->func_call.parameter_count, expression_shift, list_shift);
+            break;
+        case EXPR_INIT_LIST:
+            move_list(from->lists, &expr->init_list.elements, expr->init_list.count, expression_shift, list_shift);
+            break;
+        default:
+            break;
+        }
+    }
+
+    for (uint32_t s = 1; s < from->statement_count; s++) {
+        statement* stmt = &from->statements[s];
+        switch (stmt->type) {
+        case STMT_EXIT:
+            stmt->stmnt_exit.exit_code = moved(stmt->stmnt_exit.exit_code, expression_shift);
+            break;
+        case STMT_LET:
+            stmt->stmnt_let.value = moved(stmt->stmnt_let.value, expression_shift);
+            break;
+        case STMT_ASSIGNMENT:
+            stmt->stmnt_assign.value = moved(stmt->stmnt_assign.value, expression_shift);
+            break;
+        case STMT_EXPRESSION:
+            stmt->stmnt_expression.value = moved(stmt->stmnt_expression.value, expression_shift);
+            break;
+        case STMT_RETURN:
+            stmt->stmnt_return.value = moved(stmt->stmnt_return.value, expression_shift);
+            break;
+        case STMT_BLOCK:
+            move_list(from->lists, &stmt->stmnt_block.statements, stmt->stmnt_block.statement_count, statement_shift, list_shift);
+            break;
+        case STMT_IF:
+            stmt->stmnt_if.condition = moved(stmt->stmnt_if.condition, expression_shift);
+            stmt->stmnt_if.then = moved(stmt->stmnt_if.then, statement_shift);
+            stmt->stmnt_if.or_else = moved(stmt->stmnt_if.or_else, statement_shift);
+            break;
+        case STMT_WHILE:
+            stmt->stmnt_while.condition = moved(stmt->stmnt_while.condition, expression_shift);
+            stmt->stmnt_while.body = moved(stmt->stmnt_while.body, statement_shift);
+            break;
+        case STMT_FOR:
+            stmt->stmnt_for.initializer = moved(stmt->stmnt_for.initializer, statement_shift);
+            stmt->stmnt_for.condition = moved(stmt->stmnt_for.condition, expression_shift);
+            stmt->stmnt_for.increment = moved(stmt->stmnt_for.increment, expression_shift);
+            stmt->stmnt_for.body = moved(stmt->stmnt_for.body, statement_shift);
+            break;
+        default:
+            break;
+        }
+    }
+
+    uint32_t expressions = from->expression_count - 1;
+    uint32_t statements = from->statement_count - 1;
+    into->expressions = grow_array(into->expressions, into->expression_count, &into->expression_capacity, expressions, sizeof(expression), compiler);
+    into->statements = grow_array(into->statements, into->statement_count, &into->statement_capacity, statements, sizeof(statement), compiler);
+    into->lists = grow_array(into->lists, into->list_count, &into->list_capacity, from->list_count, sizeof(uint32_t), compiler);
+    memcpy(&into->expressions[into->expression_count], &from->expressions[1], sizeof(expression) * expressions);
+    memcpy(&into->statements[into->statement_count], &from->statements[1], sizeof(statement) * statements);
+    if (from->list_count) memcpy(&into->lists[into->list_count], from->lists, sizeof(uint32_t) * from->list_count);
+    into->expression_count += expressions;
+    into->statement_count += statements;
+    into->list_count += from->list_count;
+
+    from->expression_count = 1;
+    from->statement_count = 1;
+    from->list_count = 0;
+    return statement_shift;
+}
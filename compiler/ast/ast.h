@@ -0,0 +1,43 @@
+#ifndef AST_H
+#define AST_H
+
+#include "utilities/utils.h"
+#include <stddef.h>
+
+// empty node arrays with room for about what a program of token_count tokens parses into
+void init_ast(AST* ast, size_t token_count, Compiler* compiler);
+void free_ast(AST* ast);
+
+// a zeroed node of the given type in compiler->ast. the arrays move when they grow, so a pointer
+// taken out of them before one of these calls must be fetched again after it
+expr_id new_expression(Compiler* compiler, ExpressionType type);
+stmt_id new_statement(Compiler* compiler, StatementType type);
+// copies count ids into the id lists and returns where they start
+uint32_t new_id_list(Compiler* compiler, const uint32_t* ids, size_t count);
+
+// appends every node of from to into and fixes the ids inside them, from's statement id s is
+// into's s + the returned shift. from is left empty
+uint32_t merge_ast(AST* into, AST* from, Compiler* compiler);
+
+// read only traversal for the code generators, the AST does not change while they walk it
+static inline expression* ast_expression(const AST* ast, expr_id id){
+    return &ast->expressions[id];
+}
+
+static inline statement* ast_statement(const AST* ast, stmt_id id){
+    return &ast->statements[id];
+}
+
+static inline statement* ast_block_statement(const AST* ast, const statement* block, size_t i){
+    return &ast->statements[ast->lists[block->stmnt_block.statements + i]];
+}
+
+static inline expression* ast_call_argument(const AST* ast, const expression* call, size_t i){
+    return &ast->expressions[ast->lists[call->func_call.arguments + i]];
+}
+
+static inline expression* ast_init_element(const AST* ast, const expression* list, size_t i){
+    return &ast->expressions[ast->lists[list->init_list.elements + i]];
+}
+
+#endif
@@ -2,6 +2,8 @@
 #include "backend/assembly_generator/x86_64/x86_64.h"
 // #include "frontend/expression_creation/expressions.h"
 #include "symbol_table/symbol_table.h"
+#include "symbol_table/type_table.h"
+#include "ast/ast.h"
 #include "utilities/utils.h"
 #include "error_handler/error_handler.h"
 #include <stddef.h>
@@ -35,7 +37,7 @@ Conversion_type find_conversion_type(data_type* to, data_type* from){
         return CONVERT_NONE;
 
     if (Data_type_sizes_from_data_types[from->general_data_type] < Data_type_sizes_from_data_types[to->general_data_type]) {
-        if (Data_is_signed[from->general_data_type])
+        if (from->is_signed)
             return CONVERT_SIGN_EXTEND;
         else
             return CONVERT_ZERO_EXTEND;
@@ -207,18 +209,9 @@ static void load_variable_from_storage( symbol_node* var_node, data_type* wanted
     }
 }
 
-const bool is_signed_type[] = {
-    [DATA_TYPE_CHAR] = true,
-    [DATA_TYPE_INT] = true,
-    [DATA_TYPE_LONG] = true,
-    [DATA_TYPE_POINTER] = false,
-    [DATA_TYPE_ARRAY] = false,
-     // add other types as needed
-};
-
-const char* get_load_instruction(data_type* type, Compiler* compiler) {
-    size_t size = get_data_type_size(type, compiler);
-    bool is_signed = is_signed_type[type->general_data_type];
+const char* get_load_instruction(data_type* type) {
+    size_t size = get_data_type_size(type);
+    bool is_signed = type->is_signed;
     switch (size) {
         case 1: 
             if (is_signed) {
@@ -260,7 +253,7 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
 
     case EXPR_ADDRESS:
     {
-        symbol_node* var_node = expr->address.operand->variable.node_in_table;
+        symbol_node* var_node = ast_expression(compiler->ast, expr->address.operand)->variable.node_in_table;
         if (compiler->return_context) {
             warning( "function returns address of local variable-- it will be invalid after the function returns", compiler);
         }
@@ -298,7 +291,8 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
 
     case EXPR_POINTER_DEREF:
     {
-        evaluate_expression_x86_64(expr->dereference.operand, compiler, output, conditional, expr->dereference.operand->result_type);
+        expression* operand = ast_expression(compiler->ast, expr->dereference.operand);
+        evaluate_expression_x86_64(operand, compiler, output, conditional, operand->result_type);
         len = snprintf(buffer, BUFFER_SIZE, "mov %s, %s[rax]\n", get_reg(REG_RAX, wanted_output_result), size_prefix[Data_type_sizes_from_data_types[wanted_output_result->general_data_type]]);
         write_to_buffer(buffer, len, output, compiler);
         break;
@@ -329,8 +323,7 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
     
     case EXPR_FUNCTION_CALL:
     {
-        data_type* long_data_type = malloc(sizeof(data_type));
-        long_data_type->general_data_type = DATA_TYPE_LONG;
+        data_type* long_data_type = intern_flat_type(DATA_TYPE_LONG, compiler);
         size_t param_count = expr->func_call.parameter_count;
         write_to_buffer("push r9\npush r8\npush rcx\npush rdx\npush rsi\npush rdi\n", 52, output, compiler);
         
@@ -338,9 +331,9 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
             
             for (size_t i = 0; i < param_count; i++)
             {
-                data_type* argument_data_type = expr->func_call.arguments[i].result_type;
+                expression* argument = ast_call_argument(compiler->ast, expr, i);
 
-                evaluate_expression_x86_64(&(expr->func_call.arguments[i]), compiler, output, false, argument_data_type);
+                evaluate_expression_x86_64(argument, compiler, output, false, argument->result_type);
                 len = snprintf(buffer, BUFFER_SIZE, "push rax\n");
                 write_to_buffer(buffer, len, output, compiler);
                 
@@ -356,9 +349,9 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
         else {
             for (int i = 0; i < 6; i++)
             {
-                data_type* argument_data_type = expr->func_call.arguments[i].result_type;
+                expression* argument = ast_call_argument(compiler->ast, expr, i);
 
-                evaluate_expression_x86_64(&(expr->func_call.arguments[i]), compiler, output, false, argument_data_type);
+                evaluate_expression_x86_64(argument, compiler, output, false, argument->result_type);
                 len = snprintf(buffer, BUFFER_SIZE, "push rax\n");
                 write_to_buffer(buffer, len, output, compiler);
                 
@@ -372,9 +365,9 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
 /////////////////////////////////////////
             for (size_t j = param_count - 1; j >= 6; j--)
             {
-                data_type* argument_data_type = expr->func_call.arguments[j].result_type;
+                expression* argument = ast_call_argument(compiler->ast, expr, j);
 
-                evaluate_expression_x86_64(&(expr->func_call.arguments[j]), compiler, output, false, argument_data_type);
+                evaluate_expression_x86_64(argument, compiler, output, false, argument->result_type);
                 len = snprintf(buffer, BUFFER_SIZE, "push rax\n");
                 write_to_buffer(buffer, len, output, compiler);
             }
@@ -392,16 +385,16 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
         }
 
         write_to_buffer("pop rdi\npop rsi\npop rdx\npop rcx\npop r8\npop r9\n", 46, output, compiler);
-       
-        free(long_data_type);
         break;
     }
 
     case EXPR_ARR_INDEX:
     {
-        if (expr->array_index.array->type == EXPR_IDENTIFIER) {
-            symbol_node* var_node = expr->array_index.array->variable.node_in_table;
-            int element_size = get_data_type_size(expr->result_type, compiler);
+        expression* array = ast_expression(compiler->ast, expr->array_index.array);
+        expression* index = ast_expression(compiler->ast, expr->array_index.index);
+        if (array->type == EXPR_IDENTIFIER) {
+            symbol_node* var_node = array->variable.node_in_table;
+            int element_size = get_data_type_size(expr->result_type);
 
              if (var_node->data_type->data_type_family == FAMILY_ARRAY) {
                 load_address_from_storage(var_node, compiler, output, buffer, REG_R10);
@@ -412,7 +405,7 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
             len = snprintf(buffer, BUFFER_SIZE, "push r10\n"); // save base
             write_to_buffer(buffer, len, output, compiler);
 
-            evaluate_expression_x86_64(expr->array_index.index, compiler, output, false, expr->array_index.index->result_type);       // index → rax, may trash r10
+            evaluate_expression_x86_64(index, compiler, output, false, index->result_type);       // index → rax, may trash r10
             len = snprintf(buffer, BUFFER_SIZE, "pop r10\n");  // restore base
             write_to_buffer(buffer, len, output, compiler);
             len = snprintf(buffer, BUFFER_SIZE, "imul rax, %d\n", element_size);
@@ -424,11 +417,11 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
 
         else {
             // now the base node is at rax
-            evaluate_expression_x86_64(expr->array_index.array, compiler, output, false, expr->array_index.array->result_type);
-            int element_size = get_data_type_size(expr->result_type, compiler);
+            evaluate_expression_x86_64(array, compiler, output, false, array->result_type);
+            int element_size = get_data_type_size(expr->result_type);
             len = snprintf(buffer, BUFFER_SIZE, "push rax\n"); // save base
             write_to_buffer(buffer, len, output, compiler);
-            evaluate_expression_x86_64(expr->array_index.index, compiler, output, false, expr->array_index.index->result_type);
+            evaluate_expression_x86_64(index, compiler, output, false, index->result_type);
             len = snprintf(buffer, BUFFER_SIZE, "pop r10\n");  // restore base
             write_to_buffer(buffer, len, output, compiler);
             len = snprintf(buffer, BUFFER_SIZE, "imul rax, %d\n", element_size);
@@ -437,7 +430,7 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
             write_to_buffer(buffer, len, output, compiler);
         }
         if (expr->result_type->data_type_family != FAMILY_ARRAY) {
-            len = snprintf(buffer, BUFFER_SIZE, "%s %s[rax]\n", get_load_instruction(expr->result_type, compiler), size_prefix[Data_type_sizes_from_data_types[expr->result_type->general_data_type]]);
+            len = snprintf(buffer, BUFFER_SIZE, "%s %s[rax]\n", get_load_instruction(expr->result_type), size_prefix[Data_type_sizes_from_data_types[expr->result_type->general_data_type]]);
             write_to_buffer(buffer, len, output, compiler);
         }
         break;
@@ -454,12 +447,12 @@ void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* outp
 int evaluate_bin(expression* binary_exp, Compiler* compiler, FILE* output, int conditional, data_type* wanted_output_result)
 {
     char buffer[BUFFER_SIZE];
-    evaluate_expression_x86_64(binary_exp->binary.right, compiler, output, false, wanted_output_result); //right value
+    evaluate_expression_x86_64(ast_expression(compiler->ast, binary_exp->binary.right), compiler, output, false, wanted_output_result); //right value
 
     int len0 = snprintf(buffer, BUFFER_SIZE, "push rax\n");
     write_to_buffer(buffer, len0, output, compiler);
 
-    evaluate_expression_x86_64(binary_exp->binary.left, compiler, output, false, wanted_output_result); // left value
+    evaluate_expression_x86_64(ast_expression(compiler->ast, binary_exp->binary.left), compiler, output, false, wanted_output_result); // left value
 
     switch (binary_exp->binary.op)
     {
@@ -630,7 +623,7 @@ int evaluate_unary(expression* unary_exp, Compiler* compiler, FILE* output, data
     switch (unary_exp->unary.op)
     {
     case TOK_SUB:
-        evaluate_expression_x86_64(unary_exp->unary.operand, compiler, output, false, wanted_output_result);
+        evaluate_expression_x86_64(ast_expression(compiler->ast, unary_exp->unary.operand), compiler, output, false, wanted_output_result);
         int len0 = snprintf(buffer, BUFFER_SIZE, "neg %s\n", get_reg(0,  wanted_output_result));
         write_to_buffer(buffer, len0, output, compiler);
         break;
@@ -3,6 +3,8 @@
 #include "error_handler/error_handler.h"
 #include "backend/assembly_generator/x86_64/x86_64.h"
 #include "symbol_table/symbol_table.h"
+#include "ast/ast.h"
+#include "utilities/heap_check.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
@@ -35,8 +37,9 @@ void write_to_buffer(const char* code, size_t code_length, FILE* output, Compile
 }
 
 
-static char num_buffer[32];
-static char buffer[128];
+// scratch space for formatting one instruction, per thread since batch workers generate code side by side
+static _Thread_local char num_buffer[32];
+static _Thread_local char buffer[128];
 
 
 char* _u64_to_str(size_t number, size_t* num_len)
@@ -59,36 +62,19 @@ char* _u64_to_str(size_t number, size_t* num_len)
 
 void nums_to_str(size_t number, FILE* output, Compiler* compiler)
 {
-    size_t* num_len = malloc(sizeof(size_t));
-    char* num_as_str = _u64_to_str(number, num_len);
-    write_to_buffer(num_as_str, *num_len, output, compiler);
-    free(num_len);
+    size_t num_len = 0;
+    char* num_as_str = _u64_to_str(number, &num_len);
+    write_to_buffer(num_as_str, num_len, output, compiler);
 }
 
 static void generate_statement_code(statement* stmt, FILE* output, Compiler* compiler);
 
-void enter_existing_scope(symbol_table* new_table, bool independent, Compiler* compiler) {
-    if (!compiler) panic(ERROR_UNDEFINED, "Compiler not initialized", compiler);
-    if (compiler->symbol_table_stack->current_size + 1 >= compiler->symbol_table_stack->capacity) {
-        compiler->symbol_table_stack->storage = realloc(compiler->symbol_table_stack->storage, compiler->symbol_table_stack->capacity * 2 * sizeof(symbol_table*));
-        compiler->symbol_table_stack->capacity *= 2;
-    }
-    if (!compiler->symbol_table_stack->storage) panic(ERROR_MEMORY_ALLOCATION, "Entered too many scopes for your memory", compiler);
-
-    if (!new_table) panic(ERROR_MEMORY_ALLOCATION, "New symbol table allocation failed", compiler);
-    
-    if (independent) new_table->parent_scope = compiler->symbol_table_stack->storage[0];
-    else new_table->parent_scope = peek_symbol_stack(compiler);
-    compiler->symbol_table_stack->storage[compiler->symbol_table_stack->current_size] = new_table;
-    compiler->symbol_table_stack->current_size++;
-}
-
 void generate_array_initialization_code(Compiler* compiler, data_type* data_type, size_t base_rbp_offset, FILE* output, expression* expression) {
     if (expression->type == EXPR_INIT_LIST) {
-        size_t element_size = get_data_type_size(data_type->array_type.array_of, compiler);
+        size_t element_size = get_data_type_size(data_type->array_type.array_of);
         
         for (size_t i = 0; i < expression->init_list.count; i++ ) {
-            generate_array_initialization_code(compiler, data_type->array_type.array_of, base_rbp_offset - element_size * i, output, &(expression->init_list.elements[i]));
+            generate_array_initialization_code(compiler, data_type->array_type.array_of, base_rbp_offset - element_size * i, output, ast_init_element(compiler->ast, expression, i));
         }
     }
     else
@@ -100,17 +86,17 @@ void generate_array_initialization_code(Compiler* compiler, data_type* data_type
     }
 }
 
+// the statements carry the variables they use, the scopes are not entered again
 static void generate_block_code (statement* stmt, FILE* output, Compiler* compiler) {
-    enter_existing_scope(stmt->stmnt_block.table, false, compiler);
     for (size_t i = 0; i < stmt->stmnt_block.statement_count; i++)
     {
-        generate_statement_code(stmt->stmnt_block.statements[i], output, compiler);
+        generate_statement_code(ast_block_statement(compiler->ast, stmt, i), output, compiler);
     }
-    exit_current_scope(compiler);
 }
 
 static inline void generate_function_code(statement* stmt, FILE* output, Compiler* compiler) {
     function_node* func_node = stmt->stmnt_function_declaration.function_node;
+    statement* code_block = ast_statement(compiler->ast, func_node->code_block);
     write_to_buffer(func_node->name, func_node->name_length, output, compiler);
     
     if ((strncmp(func_node->name, "main", func_node->name_length) == 0)) {
@@ -121,10 +107,8 @@ static inline void generate_function_code(statement* stmt, FILE* output, Compile
     }
     write_to_buffer("push rbp\nmov rbp, rsp\n", 22, output, compiler);
 
-    enter_existing_scope(func_node->code_block->stmnt_block.table, true, compiler);
-
     write_to_buffer("sub rsp, ", 9, output, compiler);
-    nums_to_str(func_node->code_block->stmnt_block.table->scope_offset, output, compiler);
+    nums_to_str(code_block->stmnt_block.table->scope_offset, output, compiler);
     write_to_buffer("\n", 1, output, compiler);
     
     
@@ -132,9 +116,7 @@ static inline void generate_function_code(statement* stmt, FILE* output, Compile
     // {
     //     generate_statement_code(func_node->code_block->stmnt_block.statements[i], num_len, output, compiler);
     // }
-    generate_block_code(func_node->code_block, output, compiler);
-
-    exit_current_scope(compiler);
+    generate_block_code(code_block, output, compiler);
 }
 
 static void generate_statement_code(statement* stmt, FILE* output, Compiler* compiler) {
@@ -145,7 +127,8 @@ static void generate_statement_code(statement* stmt, FILE* output, Compiler* com
             // always int
           
             
-            evaluate_expression_x86_64(stmt->stmnt_exit.exit_code, compiler, output, 0, stmt->stmnt_exit.exit_code->result_type);
+            expression* exit_code = ast_expression(compiler->ast, stmt->stmnt_exit.exit_code);
+            evaluate_expression_x86_64(exit_code, compiler, output, 0, exit_code->result_type);
             int len = snprintf(buffer, sizeof(buffer), "\nmov rdi, rax\nmov rax, 60\nsyscall\n");
             write_to_buffer(buffer, len, output, compiler);
             break;
@@ -153,24 +136,25 @@ static void generate_statement_code(statement* stmt, FILE* output, Compiler* com
 
     case STMT_RETURN:
         compiler->return_context = true;
-        evaluate_expression_x86_64(stmt->stmnt_return.value, compiler, output, false, stmt->stmnt_return.return_data_type); // now result is stored in rax
+        evaluate_expression_x86_64(ast_expression(compiler->ast, stmt->stmnt_return.value), compiler, output, false, stmt->stmnt_return.return_data_type); // now result is stored in rax
         write_to_buffer("leave\nret\n", 10, output, compiler);
         compiler->return_context = false;
         break;
 
     case STMT_LET:
         {
-            symbol_node* var = find_variable(compiler, hash_function(stmt->stmnt_let.name,  stmt->stmnt_let.name_length), stmt->stmnt_let.name,  stmt->stmnt_let.name_length);
+            symbol_node* var = stmt->stmnt_let.variable;
+            expression* value = ast_expression(compiler->ast, stmt->stmnt_let.value);
             if (!var) {
                 panic(ERROR_UNDEFINED_VARIABLE, "Variable not found", compiler);
             }
             if (var->data_type->data_type_family == FAMILY_ARRAY) {
-                generate_array_initialization_code(compiler, var->data_type, var->offset, output, stmt->stmnt_let.value);
+                generate_array_initialization_code(compiler, var->data_type, var->offset, output, value);
             }
             else 
             {
-                evaluate_expression_x86_64(stmt->stmnt_let.value, compiler, output, 0, var->data_type);
-                int len = snprintf(buffer, sizeof(buffer), "mov [rbp - %lu], %s\n", var->offset, get_reg_x86(0,  stmt->stmnt_let.value->result_type->general_data_type));
+                evaluate_expression_x86_64(value, compiler, output, 0, var->data_type);
+                int len = snprintf(buffer, sizeof(buffer), "mov [rbp - %lu], %s\n", var->offset, get_reg_x86(0,  value->result_type->general_data_type));
                 write_to_buffer(buffer, len, output, compiler);
             }
             break;
@@ -178,12 +162,12 @@ static void generate_statement_code(statement* stmt, FILE* output, Compiler* com
 
     case STMT_ASSIGNMENT:
         {
-            symbol_node* var = find_variable(compiler, stmt->stmnt_assign.hash, stmt->stmnt_assign.name, stmt->stmnt_assign.name_length);
+            symbol_node* var = stmt->stmnt_assign.variable;
             if (!var) {
                 panic(ERROR_UNDEFINED_VARIABLE, "Variable not found while assigning value", compiler);
             }
 
-            evaluate_expression_x86_64(stmt->stmnt_assign.value, compiler, output, 0, var->data_type); // now the expression is in rax
+            evaluate_expression_x86_64(ast_expression(compiler->ast, stmt->stmnt_assign.value), compiler, output, 0, var->data_type); // now the expression is in rax
             
             if (var->where_it_is_stored == STORE_IN_STACK)
             {
@@ -210,9 +194,8 @@ static void generate_statement_code(statement* stmt, FILE* output, Compiler* com
     case STMT_IF: {
 
         size_t current_if_id = compiler->counters->if_statements++;
-        push_to_if_stack(current_if_id, compiler);
-        data_type* condition_type = stmt->stmnt_if.condition->result_type;
-        evaluate_expression_x86_64(stmt->stmnt_if.condition, compiler, output, 1, condition_type);
+        expression* condition = ast_expression(compiler->ast, stmt->stmnt_if.condition);
+        evaluate_expression_x86_64(condition, compiler, output, 1, condition->result_type);
         // till now what is printed:
         //cmp rax, rbx
         //jne 
@@ -227,8 +210,9 @@ static void generate_statement_code(statement* stmt, FILE* output, Compiler* com
         write_to_buffer("\n", 1, output, compiler);
 
         // generate the code itself
-        if (stmt->stmnt_if.then->type == STMT_BLOCK) generate_block_code(stmt->stmnt_if.then, output, compiler);
-        else generate_statement_code(stmt->stmnt_if.then, output, compiler);
+        statement* then = ast_statement(compiler->ast, stmt->stmnt_if.then);
+        if (then->type == STMT_BLOCK) generate_block_code(then, output, compiler);
+        else generate_statement_code(then, output, compiler);
 
         // now that we have finished the then block, we go to endif, then we write the logic for else
         int len0 = snprintf(buffer, sizeof(buffer), "jmp .end_if_%lu\n", current_if_id);
@@ -241,11 +225,12 @@ static void generate_statement_code(statement* stmt, FILE* output, Compiler* com
             write_to_buffer(buffer, len1, output, compiler);
 
             // .Lelse_3:\n
-            if (stmt->stmnt_if.or_else->type == STMT_IF) { // else if case
-                generate_statement_code(stmt->stmnt_if.or_else, output, compiler);
+            statement* or_else = ast_statement(compiler->ast, stmt->stmnt_if.or_else);
+            if (or_else->type == STMT_IF) { // else if case
+                generate_statement_code(or_else, output, compiler);
             } else { // plain else case
-                if (stmt->stmnt_if.or_else->type == STMT_BLOCK) generate_block_code(stmt->stmnt_if.or_else, output, compiler);
-                else generate_statement_code(stmt->stmnt_if.or_else, output, compiler);
+                if (or_else->type == STMT_BLOCK) generate_block_code(or_else, output, compiler);
+                else generate_statement_code(or_else, output, compiler);
                 // compiler->if_statements++;
             }
             
@@ -253,15 +238,15 @@ static void generate_statement_code(statement* stmt, FILE* output, Compiler* com
 
         // now the end_if
         write_to_buffer(".end_if_", 8, output, compiler);
-        nums_to_str(peek_if_stack(compiler), output, compiler);
+        nums_to_str(current_if_id, output, compiler);
         write_to_buffer(":\n", 2, output, compiler);
         compiler->counters->if_statements++;
-        pop_from_if_stack(compiler);
         break;
     }
 
     case STMT_BREAK:{
-        size_t counter = peek_while_stack(compiler);
+        if (compiler->counters->enclosing_while == 0) panic(ERROR_UNDEFINED, "break outside of a while loop", compiler);
+        size_t counter = compiler->counters->enclosing_while - 1;
         int len1 = snprintf(buffer, sizeof(buffer), "jmp .end_while_loop_%lu\n", counter);
         write_to_buffer(buffer, len1, output, compiler);
         break;
@@ -282,25 +267,34 @@ static void generate_statement_code(statement* stmt, FILE* output, Compiler* com
 
         size_t counter = stmt->stmnt_while.counter;
 
-        push_to_while_stack(counter, compiler);
+        size_t enclosing_while = compiler->counters->enclosing_while;
+        compiler->counters->enclosing_while = counter + 1;
 
         int len = snprintf(buffer, sizeof(buffer), "jmp .condition_while_%lu\n.while_loop_%lu:\n", counter, counter);
         write_to_buffer(buffer, len, output, compiler);
 
-        generate_block_code(stmt->stmnt_while.body, output, compiler);
+        generate_block_code(ast_statement(compiler->ast, stmt->stmnt_while.body), output, compiler);
 
-        pop_from_while_stack(compiler);
+        compiler->counters->enclosing_while = enclosing_while;
 
         int len0 = snprintf(buffer, sizeof(buffer), ".condition_while_%lu:\n", counter);
         write_to_buffer(buffer, len0, output, compiler);
         
-        evaluate_expression_x86_64(stmt->stmnt_while.condition, compiler, output, 2, stmt->stmnt_while.condition->result_type); 
+        expression* condition = ast_expression(compiler->ast, stmt->stmnt_while.condition);
+        evaluate_expression_x86_64(condition, compiler, output, 2, condition->result_type); 
 
         int len1 = snprintf(buffer, sizeof(buffer), ".while_loop_%lu\n.end_while_loop_%lu:\n", counter, counter);
         write_to_buffer(buffer, len1, output, compiler);
 
         break;
     }
+
+    case STMT_EXPRESSION: {
+        // top-level expressions like "my_function();"
+        expression* value = ast_expression(compiler->ast, stmt->stmnt_expression.value);
+        evaluate_expression_x86_64(value, compiler, output, 0, value->result_type);
+        break;
+    }
     default:
         break;
     }  
@@ -311,6 +305,8 @@ void generate_assembly_x86_64(const AST* AST, Compiler* compiler, FILE* output,
     snprintf(output_filename, sizeof(output_filename), "%s.asm", output_name);
     output = fopen(output_filename, "wb");
     if (!output) panic(ERROR_INTERNAL, "Failed to open output file", compiler);
+    compiler->output = output;
+    const char* guarded = heap_guard("codegen");
 
     write_to_buffer("section .text\n\tglobal _start\n_start:\n", 37, output, compiler);
     write_to_buffer("push rbp\nmov rbp, rsp\nsub rsp, 0\n", 33, output, compiler);
@@ -321,19 +317,7 @@ void generate_assembly_x86_64(const AST* AST, Compiler* compiler, FILE* output,
     size_t i = 0;
     while (i < AST->node_count)
     {
-      
-        switch (AST->nodes[i]->type)    
-        {
-        case NODE_STATEMENT:
-            generate_statement_code(AST->nodes[i]->stmnt, output, compiler);
-            break;
-        case NODE_EXPRESSION:
-            // This handles top-level expressions like "my_function();"
-            evaluate_expression_x86_64(AST->nodes[i]->expr, compiler, output, 0, DATA_TYPE_INT);
-            break;
-        default:
-            break;
-        }
+        generate_statement_code(ast_statement(AST, AST->nodes[i]), output, compiler);
         i++;
     }
     i = 0;
@@ -341,7 +325,7 @@ void generate_assembly_x86_64(const AST* AST, Compiler* compiler, FILE* output,
     write_to_buffer("\n\n\n\n", 4, output, compiler);
     while (i < AST->function_node_count)
     {
-        generate_function_code(AST->function_nodes[i]->stmnt, output, compiler);
+        generate_function_code(ast_statement(AST, AST->function_nodes[i]), output, compiler);
         i++;
     }
     
@@ -350,8 +334,10 @@ void generate_assembly_x86_64(const AST* AST, Compiler* compiler, FILE* output,
 
     write_to_buffer("\nsection .rodata\nerr_div0:\tdb \"division by zero\", 10\nerr_div0_len:  equ $ - err_div0\n", 85, output, compiler);
     fwrite(compiler->buffer, 1, compiler->currentsize, output);
+    heap_guard(guarded);
     fflush(output);
     fclose(output);
+    compiler->output = NULL;
     //gcc phc.c -o phc && ./phc test.ph
     //nasm -f elf64 output.asm && ld output.o -o output && ./output
 }
\ No newline at end of file
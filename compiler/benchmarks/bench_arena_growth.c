@@ -0,0 +1,142 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "driver/compile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+// Stress test for arena growth. A generated program of about 100 MB is compiled once with the parse
+// arenas sized from its token count, and once with them starting at the smallest chunk so they have
+// to grow chunk after chunk while the parser holds pointers into everything already allocated. Both
+// runs must write the same assembly.
+// usage: ./benchmarks/bench_arena_growth [size in MB]
+
+#define SOURCE_PATH "/tmp/bench_arena_growth.qk"
+
+static int write_program(size_t megabytes)
+{
+    FILE* file = fopen(SOURCE_PATH, "wb");
+    if (!file) return 0;
+    size_t target = megabytes * 1024 * 1024;
+    size_t written = 0;
+    for (size_t f = 0; written < target; f++) {
+        int length = fprintf(file,
+            "fn generated_%zu(a :int, b :long): int {\n"
+            "    let x :int = a * 3 + 7;\n"
+            "    let y :long = b - 11;\n"
+            "    let values :[4]int = {1, 2, 3, 4};\n"
+            "    while (x < 100) {\n"
+            "        x = x + 1;\n"
+            "        if (x > 50) {\n"
+            "            y = y + x * 2;\n"
+            "        } else {\n"
+            "            y = y - values[x %% 4];\n"
+            "        }\n"
+            "    }\n"
+            "    return x + a;\n"
+            "}\n",
+            f);
+        if (length < 0) {
+            fclose(file);
+            return 0;
+        }
+        written += (size_t)length;
+    }
+    fprintf(file, "fn main(void): int {\n    return generated_0(1, 2);\n}\nexit main();\n");
+    fclose(file);
+    return 1;
+}
+
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static char* read_all(const char* path, size_t* length)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* content = malloc(*length + 1);
+    *length = fread(content, 1, *length, file);
+    fclose(file);
+    return content;
+}
+
+// compiles the generated program into output_name.asm, with the parse arenas made up front at their
+// smallest when starve is set. prints one row of the table
+static void compile(int starve, const char* output_name)
+{
+    source_file file;
+    if (!readfile(SOURCE_PATH, &file)) exit(1);
+    Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+    if (starve) {
+        // init_parse_arenas keeps arenas that already exist instead of sizing new ones
+        compiler->statements_arena = initialize_arena(0);
+        compiler->expressions_arena = initialize_arena(0);
+        compiler->symbol_arena = initialize_arena(0);
+    }
+    compile_options options = { 0 };
+
+    // the code generator talks on stdout and stderr, keep the table readable
+    fflush(stdout);
+    int saved_out = dup(1), saved_err = dup(2), quiet = open("/dev/null", O_WRONLY);
+    dup2(quiet, 1);
+    dup2(quiet, 2);
+    double start = wall_seconds();
+    compile_source(compiler, &file, "x86_64", output_name, &options);
+    double seconds = wall_seconds() - start;
+    fflush(stdout);
+    dup2(saved_out, 1);
+    dup2(saved_err, 2);
+    close(quiet);
+    close(saved_out);
+    close(saved_err);
+
+    printf("%10s %10.2f %12zu %12zu %12zu %14zu\n", starve ? "grown" : "presized", seconds, compiler->statements_arena->chunk_count,
+        compiler->expressions_arena->chunk_count, compiler->symbol_arena->chunk_count,
+        compiler->expressions_arena->capacity + compiler->symbol_arena->capacity);
+    close_source_file(&file);
+    free_global_arenas(compiler);
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 100;
+    if (!write_program(megabytes)) {
+        fprintf(stderr, "could not write %s\n", SOURCE_PATH);
+        return 1;
+    }
+
+    printf("%zu MB program\n", megabytes);
+    printf("%10s %10s %12s %12s %12s %14s\n", "arenas", "seconds", "stmt chunks", "expr chunks", "sym chunks", "arena bytes");
+    compile(0, "/tmp/bench_arena_presized");
+    compile(1, "/tmp/bench_arena_grown");
+
+    size_t presized_length = 0, grown_length = 0;
+    char* presized = read_all("/tmp/bench_arena_presized.asm", &presized_length);
+    char* grown = read_all("/tmp/bench_arena_grown.asm", &grown_length);
+    int same = presized && grown && presized_length == grown_length && memcmp(presized, grown, presized_length) == 0;
+    free(presized);
+    free(grown);
+    remove(SOURCE_PATH);
+    remove("/tmp/bench_arena_presized.asm");
+    remove("/tmp/bench_arena_grown.asm");
+
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) printf("peak rss %ld KB\n", usage.ru_maxrss);
+    if (!same) {
+        fprintf(stderr, "the grown arenas wrote different assembly\n");
+        return 1;
+    }
+    printf("both runs wrote the same assembly\n");
+    return 0;
+}
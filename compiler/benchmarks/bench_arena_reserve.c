@@ -0,0 +1,162 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "driver/compile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// Malloced arenas against reserved ones (--reserve-arenas) on a 10-line program and a generated one of
+// a few MB. Every compile runs in a child process of its own so its peak RSS is its own. The arena
+// bytes column is what the statement, expression and symbol arenas hold, malloced or committed. Both
+// kinds of arena must write the same assembly.
+// usage: ./benchmarks/bench_arena_reserve [size in MB]
+
+#define SMALL_PATH "/tmp/bench_arena_reserve_small.qk"
+#define LARGE_PATH "/tmp/bench_arena_reserve_large.qk"
+
+static int write_program(const char* path, size_t megabytes)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file) return 0;
+    size_t target = megabytes * 1024 * 1024;
+    size_t written = 0;
+    for (size_t f = 0; written < target; f++) {
+        int length = fprintf(file,
+            "fn generated_%zu(a :int, b :long): int {\n"
+            "    let x :int = a * 3 + 7;\n"
+            "    while (x < 100) {\n"
+            "        x = x + 1;\n"
+            "        if (x > 50) {\n"
+            "            b = b + x * 2;\n"
+            "        }\n"
+            "    }\n"
+            "    return x + a;\n"
+            "}\n",
+            f);
+        if (length < 0) {
+            fclose(file);
+            return 0;
+        }
+        written += (size_t)length;
+    }
+    fprintf(file, "fn main(void): int {\n    return generated_0(1, 2);\n}\nexit main();\n");
+    fclose(file);
+    return 1;
+}
+
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static char* read_all(const char* path, size_t* length)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* content = malloc(*length + 1);
+    *length = fread(content, 1, *length, file);
+    fclose(file);
+    return content;
+}
+
+// compiles source_path into output_name.asm in a child process that prints one row of the table,
+// false if the child did not finish
+static int compile(const char* program, const char* source_path, arena_backing backing, const char* output_name)
+{
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) return 0;
+    if (pid > 0) {
+        int status = 0;
+        return waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+
+    source_file file;
+    if (!readfile(source_path, &file)) _exit(1);
+    Compiler* compiler = init_compiler_arenas(backing);
+    compile_options options = { 0 };
+
+    // the code generator talks on stdout and stderr, keep the table readable
+    int saved_out = dup(1), saved_err = dup(2), quiet = open("/dev/null", O_WRONLY);
+    dup2(quiet, 1);
+    dup2(quiet, 2);
+    double start = wall_seconds();
+    compile_source(compiler, &file, "x86_64", output_name, &options);
+    double seconds = wall_seconds() - start;
+    fflush(stdout);
+    dup2(saved_out, 1);
+    dup2(saved_err, 2);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("%8s %10s %10.3f %14zu %12ld\n", program, backing == ARENA_RESERVED ? "reserved" : "malloc", seconds,
+        compiler->statements_arena->capacity + compiler->expressions_arena->capacity + compiler->symbol_arena->capacity, usage.ru_maxrss);
+    fflush(stdout);
+    _exit(0);
+}
+
+static int same_assembly(const char* malloc_path, const char* reserved_path)
+{
+    size_t malloc_length = 0, reserved_length = 0;
+    char* malloced = read_all(malloc_path, &malloc_length);
+    char* reserved = read_all(reserved_path, &reserved_length);
+    int same = malloced && reserved && malloc_length == reserved_length && memcmp(malloced, reserved, malloc_length) == 0;
+    free(malloced);
+    free(reserved);
+    return same;
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 8;
+    FILE* small = fopen(SMALL_PATH, "wb");
+    if (!small || !write_program(LARGE_PATH, megabytes)) {
+        fprintf(stderr, "could not write the programs\n");
+        return 1;
+    }
+    fprintf(small,
+        "fn add(a :int, b :int): int {\n"
+        "    return a + b;\n"
+        "}\n"
+        "fn main(void): int {\n"
+        "    let x :int = add(2, 3);\n"
+        "    if (x > 4) {\n"
+        "        x = x - 1;\n"
+        "    }\n"
+        "    return x;\n"
+        "}\n"
+        "exit main();\n");
+    fclose(small);
+
+    printf("%8s %10s %10s %14s %12s\n", "program", "arenas", "seconds", "arena bytes", "peak rss KB");
+    int result = 0;
+    const char* programs[] = { "10 lines", "large" };
+    const char* paths[] = { SMALL_PATH, LARGE_PATH };
+    for (size_t p = 0; p < 2 && result == 0; p++) {
+        if (!compile(programs[p], paths[p], ARENA_MALLOC, "/tmp/bench_arena_malloc")
+            || !compile(programs[p], paths[p], ARENA_RESERVED, "/tmp/bench_arena_reserved")) {
+            fprintf(stderr, "the %s program did not compile\n", programs[p]);
+            result = 1;
+        }
+        else if (!same_assembly("/tmp/bench_arena_malloc.asm", "/tmp/bench_arena_reserved.asm")) {
+            fprintf(stderr, "the reserved arenas wrote different assembly for the %s program\n", programs[p]);
+            result = 1;
+        }
+    }
+    remove(SMALL_PATH);
+    remove(LARGE_PATH);
+    remove("/tmp/bench_arena_malloc.asm");
+    remove("/tmp/bench_arena_reserved.asm");
+    if (result == 0) printf("both kinds of arena wrote the same assembly (%zu MB program)\n", megabytes);
+    return result;
+}
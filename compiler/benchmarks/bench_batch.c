@@ -0,0 +1,150 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+// Throughput of many small programs compiled by one cold `quark <file> x86_64 <output>` process each
+// against a single `quark --batch <list>` with 1 and 4 workers. Both sides assemble and link every
+// program, so both pay for nasm and ld the same way. The batch's assembly is checked against the
+// assembly the cold processes wrote.
+// usage: ./benchmarks/bench_batch [quark binary] [programs]
+
+extern char** environ;
+
+#define BATCH_DIR "/tmp/bench_batch"
+
+static void write_program(const char* path, size_t seed)
+{
+    FILE* file = fopen(path, "wb");
+    fprintf(file,
+        "fn step(a :int): int {\n"
+        "    let x :int = a * 3 + %zu;\n"
+        "    while (x < 100) {\n"
+        "        x = x + 1;\n"
+        "        if (x > 50) {\n"
+        "            x = x + 2;\n"
+        "        }\n"
+        "    }\n"
+        "    return x;\n"
+        "}\n"
+        "fn main(void): int {\n"
+        "    return step(%zu);\n"
+        "}\n"
+        "exit main();\n",
+        seed % 97, seed % 13);
+    fclose(file);
+}
+
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static char* read_all(const char* path, size_t* length)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* content = malloc(*length + 1);
+    *length = fread(content, 1, *length, file);
+    fclose(file);
+    return content;
+}
+
+// runs argv with its output thrown away, its exit status or -1
+static int run_quiet(char** argv)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+    pid_t pid;
+    int failed = posix_spawn(&pid, argv[0], &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    int status = 0;
+    if (failed || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status);
+}
+
+static int same_assembly(const char* cold_path, const char* batch_path)
+{
+    size_t cold_length = 0, batch_length = 0;
+    char* cold = read_all(cold_path, &cold_length);
+    char* batch = read_all(batch_path, &batch_length);
+    int same = cold && batch && cold_length == batch_length && memcmp(cold, batch, cold_length) == 0;
+    free(cold);
+    free(batch);
+    return same;
+}
+
+int main(int argc, char** argv)
+{
+    char* quark = argc > 1 ? argv[1] : "./quark";
+    size_t programs = argc > 2 ? strtoul(argv[2], NULL, 10) : 200;
+    mkdir(BATCH_DIR, 0755);
+
+    char path[256];
+    FILE* list = fopen(BATCH_DIR "/list.txt", "wb");
+    for (size_t p = 0; p < programs; p++) {
+        snprintf(path, sizeof(path), BATCH_DIR "/program_%zu.qk", p);
+        write_program(path, p);
+        fprintf(list, "%s %s/batch_%zu\n", path, BATCH_DIR, p);
+    }
+    fclose(list);
+
+    double start = wall_seconds();
+    for (size_t p = 0; p < programs; p++) {
+        char source[256], output[256];
+        snprintf(source, sizeof(source), BATCH_DIR "/program_%zu.qk", p);
+        snprintf(output, sizeof(output), BATCH_DIR "/cold_%zu", p);
+        char* cold_argv[] = { quark, source, "x86_64", output, NULL };
+        if (run_quiet(cold_argv) != 0) {
+            fprintf(stderr, "the cold compile of %s failed\n", source);
+            return 1;
+        }
+    }
+    double cold = wall_seconds() - start;
+
+    printf("%10s %12s %12s %9s\n", "programs", "mode", "files/sec", "speedup");
+    printf("%10zu %12s %12.1f %9s\n", programs, "cold", programs / cold, "1.00x");
+    int result = 0;
+    const char* worker_counts[] = { "1", "4" };
+    for (size_t w = 0; w < 2 && result == 0; w++) {
+        char* batch_argv[] = { quark, "--threads", (char*)worker_counts[w], "--batch", BATCH_DIR "/list.txt", NULL };
+        start = wall_seconds();
+        if (run_quiet(batch_argv) != 0) {
+            fprintf(stderr, "the batch compile failed\n");
+            result = 1;
+            break;
+        }
+        double batch = wall_seconds() - start;
+        char mode[32];
+        snprintf(mode, sizeof(mode), "batch x%s", worker_counts[w]);
+        printf("%10zu %12s %12.1f %8.2fx\n", programs, mode, programs / batch, cold / batch);
+
+        for (size_t p = 0; p < programs; p++) {
+            char cold_asm[256], batch_asm[256];
+            snprintf(cold_asm, sizeof(cold_asm), BATCH_DIR "/cold_%zu.asm", p);
+            snprintf(batch_asm, sizeof(batch_asm), BATCH_DIR "/batch_%zu.asm", p);
+            if (!same_assembly(cold_asm, batch_asm)) {
+                fprintf(stderr, "program %zu: the batch's assembly differs from the cold process\n", p);
+                result = 1;
+                break;
+            }
+        }
+    }
+
+    char* cleanup[] = { "/bin/rm", "-rf", BATCH_DIR, NULL };
+    run_quiet(cleanup);
+    if (result == 0) printf("every batch program matched its cold process\n");
+    return result;
+}
@@ -0,0 +1,155 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "symbol_table/symbol_table.h"
+#include "frontend/tokenization/tokenize.h"
+#include "frontend/parsing/parsing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// The function map on generated call graphs of 10,000 functions and more, where every function calls
+// the two declared before it. The map columns register every function and look up every call with
+// the open-addressing table next to the old 32 chained buckets, which walked the whole chain on each
+// insert to catch a duplicate and again on each lookup. The parse column is the whole front end on the
+// same program: tokenize, collect the signatures and parse every body.
+// usage: ./benchmarks/bench_functions [most functions] [rounds]
+
+#define OLD_BUCKETS 32
+
+typedef struct old_function
+{
+    uint32_t symbol_id;
+    struct old_function* next;
+} old_function;
+
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static char* generate_call_graph(size_t functions, size_t* length)
+{
+    size_t capacity = 256 + functions * 160;
+    char* source = malloc(capacity);
+    size_t used = snprintf(source, capacity, "fn f_0(a :int): int {\n    return a + 1;\n}\nfn f_1(a :int): int {\n    return f_0(a);\n}\n");
+    for (size_t f = 2; f < functions; f++) {
+        used += snprintf(source + used, capacity - used,
+            "fn f_%zu(a :int): int {\n    return f_%zu(a) + f_%zu(a);\n}\n", f, f - 1, f - 2);
+    }
+    used += snprintf(source + used, capacity - used, "fn main(void): int {\n    return f_%zu(1);\n}\n", functions - 1);
+    *length = used;
+    return source;
+}
+
+// registers ids[0..count) and looks each one up twice like the calls do, the checksum is the lookups that hit
+static size_t old_map(const uint32_t* ids, size_t count, double* seconds)
+{
+    old_function* buckets[OLD_BUCKETS] = { 0 };
+    old_function* nodes = malloc(count * sizeof(old_function));
+    size_t found = 0;
+    clock_t start = clock();
+    for (size_t i = 0; i < count; i++) {
+        old_function** bucket = &buckets[ids[i] % OLD_BUCKETS];
+        while (*bucket) {
+            if ((*bucket)->symbol_id == ids[i]) break;
+            bucket = &(*bucket)->next;
+        }
+        nodes[i].symbol_id = ids[i];
+        nodes[i].next = NULL;
+        *bucket = &nodes[i];
+    }
+    for (size_t round = 0; round < 2; round++) {
+        for (size_t i = 0; i < count; i++) {
+            for (old_function* node = buckets[ids[i] % OLD_BUCKETS]; node; node = node->next) {
+                if (node->symbol_id == ids[i]) {
+                    found++;
+                    break;
+                }
+            }
+        }
+    }
+    *seconds = seconds_since(start);
+    free(nodes);
+    return found;
+}
+
+static size_t new_map(const uint32_t* ids, size_t count, double* seconds)
+{
+    Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+    function_node* nodes = calloc(count, sizeof(function_node));
+    size_t found = 0;
+    clock_t start = clock();
+    for (size_t i = 0; i < count; i++) {
+        nodes[i].symbol_id = ids[i];
+        append_function_to_func_map(&nodes[i], compiler);
+    }
+    for (size_t round = 0; round < 2; round++) {
+        for (size_t i = 0; i < count; i++) found += find_function_symbol_node(ids[i], compiler) == &nodes[i];
+    }
+    *seconds = seconds_since(start);
+    free(nodes);
+    free_global_arenas(compiler);
+    return found;
+}
+
+// the two passes main() makes, signatures first and then every statement
+static double parse_time(const char* source, size_t length, size_t* token_count)
+{
+    Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+    size_t function_count = 0;
+    token_stream* stream = tokenize(source, compiler, token_count, &length, &function_count);
+    init_parse_arenas(compiler, *token_count);
+    reserve_function_map(compiler->function_map, function_count, compiler);
+    Parser* parser = make_parser(compiler);
+    parser->tokens = stream;
+    compiler->parser = parser;
+
+    clock_t start = clock();
+    for (size_t f = 0; f < stream->function_count; f++) {
+        parser->current = stream->function_tokens[f];
+        parse_function_node(compiler, parser);
+    }
+    rewind_parser(parser);
+    while (!parser_at_end(parser)) {
+        parse_statement(compiler, parser);
+        if (peek_type(parser, 0) == TOK_SEMICOLON) advance(parser);
+    }
+    double seconds = seconds_since(start);
+    free_global_arenas(compiler);
+    return seconds;
+}
+
+int main(int argc, char** argv)
+{
+    size_t most = argc > 1 ? strtoul(argv[1], NULL, 10) : 160000;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 1;
+
+    printf("%10s %10s %14s %14s %10s %12s\n", "functions", "tokens", "old map ms", "table ms", "speedup", "parse ms");
+    for (size_t functions = 10000; functions <= most; functions *= 2) {
+        // symbol ids are dense, the program's names take them in declaration order
+        uint32_t* ids = malloc(functions * sizeof(uint32_t));
+        for (size_t i = 0; i < functions; i++) ids[i] = (uint32_t)(i * 2 + 1);
+
+        double old_time = 0, new_time = 0, parse = 0;
+        size_t token_count = 0, length = 0;
+        char* source = generate_call_graph(functions, &length);
+        for (size_t r = 0; r < rounds; r++) {
+            double seconds = 0;
+            size_t old_found = old_map(ids, functions, &seconds);
+            old_time += seconds;
+            size_t new_found = new_map(ids, functions, &seconds);
+            new_time += seconds;
+            if (old_found != 2 * functions || new_found != 2 * functions) {
+                fprintf(stderr, "%zu functions: the old map found %zu calls, the table %zu\n", functions, old_found, new_found);
+                return 1;
+            }
+            parse += parse_time(source, length, &token_count);
+        }
+        printf("%10zu %10zu %14.2f %14.2f %9.1fx %12.2f\n", functions, token_count, old_time * 1000 / rounds,
+            new_time * 1000 / rounds, new_time > 0 ? old_time / new_time : 0.0, parse * 1000 / rounds);
+        free(source);
+        free(ids);
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "utilities/utils.h"
+#include "frontend/tokenization/keywords.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Keyword recognition throughput on identifier heavy input: the perfect hash in classify_identifier()
+// against the old per length switch with character compares (which only knew 12 of the keywords).
+// usage: ./benchmarks/bench_keywords [identifiers in millions] [rounds]
+
+static TokenType length_switch_classify(const char* value, size_t length)
+{
+    switch (length) {
+        case 6:
+            if (value[0] == 'r' && value[1] == 'e' && value[2] == 't' && value[3] == 'u' && value[4] == 'r' && value[5] == 'n') return TOK_RETURN;
+            break;
+        case 5:
+            if (value[0] == 'w' && value[1] == 'h' && value[2] == 'i' && value[3] == 'l' && value[4] == 'e') return TOK_WHILE;
+            if (value[0] == 'b' && value[1] == 'r' && value[2] == 'e' && value[3] == 'a' && value[4] == 'k') return TOK_BREAK;
+            break;
+        case 4:
+            if (value[0] == 'e' && value[1] == 'x' && value[2] == 'i' && value[3] == 't') return TOK_EXIT;
+            if (value[0] == 'v' && value[1] == 'o' && value[2] == 'i' && value[3] == 'd') return TOK_VOID;
+            if (value[0] == 'e' && value[1] == 'l' && value[2] == 's' && value[3] == 'e') return TOK_ELSE;
+            if (value[0] == 'l' && value[1] == 'o' && value[2] == 'n' && value[3] == 'g') return TOK_LONG;
+            break;
+        case 3:
+            if (value[0] == 'l' && value[1] == 'e' && value[2] == 't') return TOK_LET;
+            if (value[0] == 'i' && value[1] == 'n' && value[2] == 't') return TOK_INT;
+            break;
+        case 2:
+            if (value[0] == 'f' && value[1] == 'n') return TOK_FN;
+            if (value[0] == 'i' && value[1] == 'f') return TOK_IF;
+            break;
+    }
+    return TOK_IDENTIFIER;
+}
+
+static const char* words[] = {
+    "let", "x", "int", "counter", "if", "else", "i", "j", "idx", "value", "while", "tmp_0001",
+    "return", "result", "fn", "void", "long", "node", "next", "exit", "left", "right", "break",
+    "char", "for", "list", "true", "item", "false", "null", "size", "bool", "length", "continue",
+    "float", "double", "generated_identifier", "acc", "sum", "flag",
+};
+#define WORD_COUNT (sizeof(words) / sizeof(words[0]))
+
+int main(int argc, char** argv)
+{
+    size_t millions = argc > 1 ? strtoul(argv[1], NULL, 10) : 20;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 3;
+    size_t count = millions * 1000000;
+
+    // pick the identifiers up front so both classifiers walk exactly the same stream
+    uint32_t* picks = malloc(count * sizeof(uint32_t));
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1103515245 + 12345;
+        picks[i] = (seed >> 16) % WORD_COUNT;
+    }
+    size_t lengths[WORD_COUNT];
+    for (size_t w = 0; w < WORD_COUNT; w++) lengths[w] = strlen(words[w]);
+
+    size_t keywords_switch = 0, keywords_hash = 0;
+    clock_t start = clock();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            keywords_switch += length_switch_classify(words[picks[i]], lengths[picks[i]]) != TOK_IDENTIFIER;
+        }
+    }
+    double switch_time = ((double)(clock() - start)) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < count; i++) {
+            keywords_hash += classify_identifier(words[picks[i]], lengths[picks[i]]) != TOK_IDENTIFIER;
+        }
+    }
+    double hash_time = ((double)(clock() - start)) / CLOCKS_PER_SEC;
+
+    double total = (double)count * rounds / 1e6;
+    printf("%zu M identifiers x %zu rounds\n", millions, rounds);
+    printf("length switch : %8.1f M ids/s (%zu keywords seen)\n", total / switch_time, keywords_switch / rounds);
+    printf("perfect hash  : %8.1f M ids/s (%zu keywords seen)\n", total / hash_time, keywords_hash / rounds);
+
+    free(picks);
+    return 0;
+}
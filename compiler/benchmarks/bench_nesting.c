@@ -0,0 +1,106 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "frontend/tokenization/tokenize.h"
+#include "frontend/parsing/parsing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Parse time of one function made of deeply nested if/while blocks, next to what the old per-block
+// brace counting pre-scan alone would cost on the same tokens.
+// Conditions and bodies only use literals and block local variables, so lookups stay in the innermost
+// scope and the numbers show the block parsing itself.
+// usage: ./benchmarks/bench_nesting [deepest nesting] [rounds]
+
+static char* generate_nesting(size_t depth, size_t* length)
+{
+    size_t capacity = 128 + depth * 96;
+    char* source = malloc(capacity);
+    size_t used = snprintf(source, capacity, "fn main(void): int {\n    let x :int = 0;\n");
+    for (size_t level = 0; level < depth; level++) {
+        used += snprintf(source + used, capacity - used,
+            level % 2 == 0 ? "if (1 < %zu) {\n    let v :int = 1;\n" : "while (%zu < 1) {\n    let v :int = 2;\n",
+            level + 2);
+    }
+    for (size_t level = 0; level < depth; level++) {
+        used += snprintf(source + used, capacity - used, "}\n");
+    }
+    used += snprintf(source + used, capacity - used, "    return x;\n}\n");
+    *length = used;
+    return source;
+}
+
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+// the two passes main() makes: signatures first, then every statement
+static void parse_program(Compiler* compiler, Parser* parser)
+{
+    while (!parser_at_end(parser)) {
+        if (peek_type(parser, 0) == TOK_FN) parse_function_node(compiler, parser);
+        else advance(parser);
+    }
+    rewind_parser(parser);
+    while (!parser_at_end(parser)) {
+        parse_statement(compiler, parser);
+        if (peek_type(parser, 0) == TOK_SEMICOLON) advance(parser);
+    }
+}
+
+// the scan parse_code_block() used to run from every '{' to its matching '}' before parsing the block
+static size_t legacy_prescan(const token_stream* stream)
+{
+    size_t counted = 0;
+    for (size_t open = 0; open < stream->count; open++) {
+        if (stream->types[open] != TOK_LBRACE) continue;
+        size_t depth = 1;
+        for (size_t i = open + 1; depth > 0 && i < stream->count; i++) {
+            TokenType type = (TokenType)stream->types[i];
+            if (type == TOK_LBRACE) depth++;
+            else if (type == TOK_RBRACE) depth--;
+            else if (depth == 1 && (type == TOK_LET || type == TOK_IF || type == TOK_WHILE || type == TOK_IDENTIFIER)) counted++;
+        }
+    }
+    return counted;
+}
+
+int main(int argc, char** argv)
+{
+    size_t deepest = argc > 1 ? strtoul(argv[1], NULL, 10) : 8000;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 5;
+
+    printf("%8s %10s %12s %14s %16s\n", "depth", "tokens", "parse ms", "parse ns/token", "old pre-scan ms");
+    for (size_t depth = 1000; depth <= deepest; depth *= 2) {
+        size_t length = 0;
+        char* source = generate_nesting(depth, &length);
+        double parse_time = 0, prescan_time = 0;
+        size_t token_count = 0, checksum = 0;
+
+        for (size_t r = 0; r < rounds; r++) {
+            Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+            size_t function_count = 0;
+            token_stream* stream = tokenize(source, compiler, &token_count, &length, &function_count);
+            init_parse_arenas(compiler, token_count);
+            Parser* parser = make_parser(compiler);
+            parser->tokens = stream;
+            compiler->parser = parser;
+
+            clock_t start = clock();
+            parse_program(compiler, parser);
+            parse_time += seconds_since(start);
+
+            start = clock();
+            checksum += legacy_prescan(stream);
+            prescan_time += seconds_since(start);
+            free_global_arenas(compiler);
+        }
+        printf("%8zu %10zu %12.2f %14.1f %16.2f\n", depth, token_count, parse_time * 1000 / rounds,
+            parse_time * 1e9 / rounds / token_count, prescan_time * 1000 / rounds);
+        if (checksum == 0) fprintf(stderr, "pre-scan counted nothing\n");
+        free(source);
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "frontend/tokenization/tokenize.h"
+#include "frontend/parsing/parsing.h"
+#include "backend/assembly_generator/x86_64/x86_64.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Wall-clock time of the second pass (every function body) on programs with thousands of functions,
+// parsed serially and with --parallel-parse on 2 to 16 threads. Every parallel run is compiled to
+// assembly and checked against the serial output.
+// usage: ./benchmarks/bench_parse_threads [most functions] [rounds]
+
+static char* generate_functions(size_t functions, size_t* length)
+{
+    size_t capacity = 256 + functions * 768;
+    char* source = malloc(capacity);
+    size_t used = 0;
+    for (size_t f = 0; f < functions; f++) {
+        used += snprintf(source + used, capacity - used,
+            "fn generated_%zu(a :int, b :long): int {\n"
+            "    let x :int = a * 3 + 7;\n"
+            "    let y :long = b - 11;\n"
+            "    while (x < 100) {\n"
+            "        x = x + 1;\n"
+            "        if (x > 50) {\n"
+            "            y = y + x * 2;\n"
+            "        }\n"
+            "    }\n"
+            "    let z :int = x + a + 1 + 2 + 3 + 4 + 5 + 6 + 7 + 8;\n"
+            "    return z + generated_%zu(a, b);\n"
+            "}\n",
+            f, f / 2);
+    }
+    used += snprintf(source + used, capacity - used, "fn main(void): int {\n    return generated_0(1, 2);\n}\n");
+    *length = used;
+    return source;
+}
+
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static char* read_all(const char* path, size_t* length)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* content = malloc(*length + 1);
+    *length = fread(content, 1, *length, file);
+    fclose(file);
+    return content;
+}
+
+// the two passes main() makes, only the second one is timed. writes output_name.asm
+static double compile(const char* source, size_t length, size_t threads, const char* output_name, size_t* token_count)
+{
+    Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+    size_t function_count = 0;
+    token_stream* stream = tokenize(source, compiler, token_count, &length, &function_count);
+    init_parse_arenas(compiler, *token_count);
+    Parser* parser = make_parser(compiler);
+    parser->tokens = stream;
+    compiler->parser = parser;
+    compiler->threads = threads;
+
+    AST* ast = compiler->ast;
+    ast->parser = parser;
+    ast->node_count = 0;
+    ast->node_capacity = 16;
+    ast->nodes = malloc(sizeof(stmt_id) * ast->node_capacity);
+    ast->function_node_count = 0;
+    ast->function_node_capacity = function_count + 1;
+    ast->function_nodes = malloc(sizeof(stmt_id) * ast->function_node_capacity);
+    ast->function_bodies = threads > 1 ? malloc(sizeof(function_body) * (function_count + 1)) : NULL;
+
+    for (size_t f = 0; f < stream->function_count; f++) {
+        parser->current = stream->function_tokens[f];
+        ast->function_nodes[ast->function_node_count++] = parse_function_node(compiler, parser);
+        if (ast->function_bodies) ast->function_bodies[f].start = parser->current;
+    }
+    rewind_parser(parser);
+
+    double start = wall_seconds();
+    if (ast->function_bodies) parse_function_bodies(compiler, ast);
+    size_t next_function = 0;
+    while (!parser_at_end(parser)) {
+        if (ast->function_bodies && peek_type(parser, 0) == TOK_FN) skip_parsed_function(compiler, parser, next_function++);
+        else parse_statement(compiler, parser);
+        if (peek_type(parser, 0) == TOK_SEMICOLON) advance(parser);
+    }
+    double seconds = wall_seconds() - start;
+
+    // the code generator talks on stdout and stderr, keep the table readable
+    fflush(stdout);
+    int saved_out = dup(1), saved_err = dup(2), quiet = open("/dev/null", O_WRONLY);
+    dup2(quiet, 1);
+    dup2(quiet, 2);
+    generate_assembly_x86_64(ast, compiler, NULL, (char*)output_name);
+    fflush(stdout);
+    dup2(saved_out, 1);
+    dup2(saved_err, 2);
+    close(quiet);
+    close(saved_out);
+    close(saved_err);
+    free_global_arenas(compiler);
+    return seconds;
+}
+
+int main(int argc, char** argv)
+{
+    size_t most = argc > 1 ? strtoul(argv[1], NULL, 10) : 32000;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 3;
+    const size_t thread_counts[] = { 1, 2, 4, 8, 16 };
+    const size_t thread_kinds = sizeof(thread_counts) / sizeof(thread_counts[0]);
+
+    printf("%10s %10s", "functions", "tokens");
+    for (size_t t = 0; t < thread_kinds; t++) printf("  %2zu threads ms", thread_counts[t]);
+    printf("\n");
+
+    for (size_t functions = 2000; functions <= most; functions *= 2) {
+        size_t length = 0;
+        char* source = generate_functions(functions, &length);
+        double best[sizeof(thread_counts) / sizeof(thread_counts[0])] = { 0 };
+        size_t serial_length = 0, token_count = 0;
+        char* serial_asm = NULL;
+
+        for (size_t t = 0; t < thread_kinds; t++) {
+            for (size_t r = 0; r < rounds; r++) {
+                double seconds = compile(source, length, thread_counts[t], "/tmp/bench_parse_threads", &token_count);
+                if (r == 0 || seconds < best[t]) best[t] = seconds;
+            }
+            size_t asm_length = 0;
+            char* assembly = read_all("/tmp/bench_parse_threads.asm", &asm_length);
+            if (!assembly) {
+                fprintf(stderr, "no assembly written\n");
+                return 1;
+            }
+            if (t == 0) {
+                serial_asm = assembly;
+                serial_length = asm_length;
+                continue;
+            }
+            if (asm_length != serial_length || memcmp(assembly, serial_asm, asm_length) != 0) {
+                fprintf(stderr, "%zu threads: assembly differs from the serial parse\n", thread_counts[t]);
+                return 1;
+            }
+            free(assembly);
+        }
+
+        printf("%10zu %10zu", functions + 1, token_count);
+        for (size_t t = 0; t < thread_kinds; t++) printf(" %8.2f %5.2fx", best[t] * 1000, best[0] / best[t]);
+        printf("\n");
+        free(serial_asm);
+        free(source);
+    }
+    remove("/tmp/bench_parse_threads.asm");
+    printf("every thread count produced the serial assembly\n");
+    return 0;
+}
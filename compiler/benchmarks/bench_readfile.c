@@ -0,0 +1,86 @@
+#include "utilities/utils.h"
+#include "frontend/tokenization/scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Source loading cost: mmap (regular files) against the read() copy used for pipes and stdin.
+// Each loader runs in its own child so the peak RSS of one does not hide the other.
+// usage: ./benchmarks/bench_readfile [size in MB] [file to generate]
+
+static void generate_file(const char* path, size_t target_size)
+{
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        perror("Error creating benchmark input");
+        exit(1);
+    }
+    size_t written = 0;
+    for (size_t n = 0; written < target_size; n++) {
+        written += fprintf(out,
+            "fn generated_%zu(value: int): int {\n    // comment for function %zu\n    let local_%zu :int = value + %zu;\n    return local_%zu;\n}\n",
+            n, n, n, n % 100, n);
+    }
+    fclose(out);
+}
+
+static void load_and_walk(const char* path)
+{
+    source_file file;
+    if (!readfile(path, &file)) exit(1);
+
+    // touch every page the way the tokenizer would
+    size_t lines = 0;
+    size_t i = 0;
+    while (i < file.length) {
+        i = scan_line_end(file.content, i, file.length) + 1;
+        lines++;
+    }
+    if (lines == 0) exit(1);
+    close_source_file(&file);
+}
+
+static void run_child(const char* label, const char* path, bool through_stdin)
+{
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (through_stdin) {
+            if (!freopen(path, "rb", stdin)) exit(1);
+            load_and_walk("-");
+        }
+        else {
+            load_and_walk(path);
+        }
+        exit(0);
+    }
+    int status;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double seconds = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("%-12s: %8.3f s  peak RSS %8ld KB%s\n", label, seconds, usage.ru_maxrss, WIFEXITED(status) && WEXITSTATUS(status) == 0 ? "" : "  (FAILED)");
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 100;
+    const char* path = argc > 2 ? argv[2] : "/tmp/quark_bench_input.qk";
+
+    generate_file(path, megabytes * 1024 * 1024);
+    printf("input: %s (%zu MB)\n", path, megabytes);
+
+    run_child("mmap", path, false);
+    run_child("read() copy", path, true);
+
+    unlink(path);
+    return 0;
+}
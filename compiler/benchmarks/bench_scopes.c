@@ -0,0 +1,146 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "symbol_table/symbol_table.h"
+#include "symbol_table/string_table.h"
+#include "symbol_table/type_table.h"
+#include "frontend/expression_creation/expressions.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Variable lookups from the innermost of 1, 100 and 10,000 nested scopes, with the single binding table
+// and its undo log next to the old per-scope maps (16 chained buckets each, walked from the innermost
+// scope outward). Every scope declares a variable of its own and one more that shadows the scope around
+// it. The lookups are the function's first variable, declared outermost, the shadowed name and a name
+// no scope declares.
+// usage: ./benchmarks/bench_scopes [lookups in millions]
+
+#define OLD_BUCKETS 16
+
+typedef struct old_node
+{
+    uint32_t symbol_id;
+    struct old_node* next;
+} old_node;
+
+// the old scope stack, one chained map per scope
+typedef struct
+{
+    old_node** maps;
+    old_node* nodes;
+    size_t depth;
+    size_t node_count;
+} old_scopes;
+
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void old_declare(old_scopes* scopes, size_t scope, uint32_t symbol_id)
+{
+    old_node* node = &scopes->nodes[scopes->node_count++];
+    node->symbol_id = symbol_id;
+    node->next = scopes->maps[scope * OLD_BUCKETS + symbol_id % OLD_BUCKETS];
+    scopes->maps[scope * OLD_BUCKETS + symbol_id % OLD_BUCKETS] = node;
+}
+
+static old_node* old_find(const old_scopes* scopes, uint32_t symbol_id)
+{
+    for (size_t scope = scopes->depth; scope-- > 0;) {
+        for (old_node* node = scopes->maps[scope * OLD_BUCKETS + symbol_id % OLD_BUCKETS]; node; node = node->next) {
+            if (node->symbol_id == symbol_id) return node;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t intern_name(Compiler* compiler, const char* format, size_t number)
+{
+    char name[64];
+    int length = snprintf(name, sizeof(name), format, number);
+    return intern_identifier(compiler->strings, name, (size_t)length, compiler);
+}
+
+static void declare(Compiler* compiler, uint32_t symbol_id)
+{
+    create_variable_node_dec("v", 1, symbol_id, STORE_IN_STACK, 0, intern_flat_type(DATA_TYPE_INT, compiler), compiler);
+}
+
+int main(int argc, char** argv)
+{
+    size_t lookups = (argc > 1 ? strtoul(argv[1], NULL, 10) : 2) * 1000000;
+    const size_t depths[] = { 1, 100, 10000 };
+    int result = 0;
+
+    printf("%8s %10s %14s %14s %14s %14s\n", "depth", "lookup", "old ns", "table ns", "speedup", "scope ms");
+    for (size_t d = 0; d < sizeof(depths) / sizeof(depths[0]) && result == 0; d++) {
+        size_t depth = depths[d];
+        Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+        init_parse_arenas(compiler, 1024);
+        uint32_t outer = intern_name(compiler, "outer_%zu", 0);
+        uint32_t shadowed = intern_name(compiler, "shadowed_%zu", 0);
+        uint32_t missing = intern_name(compiler, "missing_%zu", 0);
+
+        old_scopes old = { calloc(depth * OLD_BUCKETS, sizeof(old_node*)), malloc(depth * 2 * sizeof(old_node)), depth, 0 };
+
+        // the function scope and depth - 1 blocks inside it
+        clock_t start = clock();
+        enter_new_function_scope(compiler, intern_flat_type(DATA_TYPE_INT, compiler));
+        declare(compiler, outer);
+        old_declare(&old, 0, outer);
+        for (size_t level = 1; level < depth; level++) {
+            enter_new_scope(compiler, NULL);
+            uint32_t own = intern_name(compiler, "local_%zu", level);
+            declare(compiler, own);
+            declare(compiler, shadowed);
+            old_declare(&old, level, own);
+            old_declare(&old, level, shadowed);
+        }
+        double enter_time = seconds_since(start);
+
+        const char* names[] = { "outermost", "shadowed", "missing" };
+        uint32_t ids[] = { outer, shadowed, missing };
+        for (size_t n = 0; n < 3; n++) {
+            size_t found = 0;
+            start = clock();
+            for (size_t i = 0; i < lookups; i++) found += old_find(&old, ids[n]) != NULL;
+            double old_time = seconds_since(start);
+
+            start = clock();
+            for (size_t i = 0; i < lookups; i++) found += find_variable(compiler, ids[n]) != NULL;
+            double table_time = seconds_since(start);
+
+            // depth 1 has no block to declare the shadowing variable in
+            size_t expected = n == 0 || (n == 1 && depth > 1) ? 2 * lookups : 0;
+            if (found != expected) {
+                fprintf(stderr, "depth %zu: the tables disagree on %s\n", depth, names[n]);
+                result = 1;
+            }
+            printf("%8zu %10s %14.1f %14.1f %13.1fx %14s\n", depth, names[n], old_time * 1e9 / lookups,
+                table_time * 1e9 / lookups, table_time > 0 ? old_time / table_time : 0.0, "");
+        }
+
+        // leaving every block puts the bindings back the way they were, outer stays the function's
+        start = clock();
+        for (size_t level = 1; level < depth; level++) exit_current_scope(compiler);
+        double exit_time = seconds_since(start);
+        if (!find_variable(compiler, outer) || find_variable(compiler, shadowed)) {
+            fprintf(stderr, "depth %zu: leaving the scopes did not restore the bindings\n", depth);
+            result = 1;
+        }
+        exit_current_scope(compiler);
+        if (find_variable(compiler, outer)) {
+            fprintf(stderr, "depth %zu: the function's variable outlived its scope\n", depth);
+            result = 1;
+        }
+        printf("%8zu %10s %14s %14s %14s %14.2f\n", depth, "enter+exit", "", "", "", (enter_time + exit_time) * 1000);
+
+        free(old.maps);
+        free(old.nodes);
+        free_global_arenas(compiler);
+    }
+    if (result == 0) printf("every lookup found what the old scope maps found\n");
+    return result;
+}
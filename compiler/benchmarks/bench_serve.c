@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+// Per-request latency of a cold `quark <file> x86_64 <output>` process against the same request sent
+// to a running `quark --serve` on programs of 1 to 1000 functions. Both sides assemble and link the
+// result, so both pay for nasm and ld the same way. Every server answer is checked against the
+// assembly the cold process wrote.
+// usage: ./benchmarks/bench_serve [quark binary] [requests per program]
+
+extern char** environ;
+
+#define SOCKET_PATH "/tmp/bench_serve.sock"
+
+static char* generate_functions(size_t functions, size_t* length)
+{
+    size_t capacity = 256 + functions * 512;
+    char* source = malloc(capacity);
+    size_t used = 0;
+    for (size_t f = 0; f < functions; f++) {
+        used += snprintf(source + used, capacity - used,
+            "fn generated_%zu(a :int): int {\n"
+            "    let x :int = a * 3 + 7;\n"
+            "    while (x < 100) {\n"
+            "        x = x + 1;\n"
+            "        if (x > 50) {\n"
+            "            x = x + 2;\n"
+            "        }\n"
+            "    }\n"
+            "    return x;\n"
+            "}\n",
+            f);
+    }
+    used += snprintf(source + used, capacity - used, "fn main(void): int {\n    return generated_0(1);\n}\nexit main();\n");
+    *length = used;
+    return source;
+}
+
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static char* read_all(const char* path, size_t* length)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* content = malloc(*length + 1);
+    *length = fread(content, 1, *length, file);
+    fclose(file);
+    return content;
+}
+
+// starts argv with its output thrown away, its pid or -1
+static pid_t spawn_quiet(char** argv)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, 1, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+    pid_t pid;
+    int failed = posix_spawn(&pid, argv[0], &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    return failed ? -1 : pid;
+}
+
+static int connect_server(void)
+{
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, SOCKET_PATH);
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0) return -1;
+    if (connect(server, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        close(server);
+        return -1;
+    }
+    return server;
+}
+
+// one request, the exit code the server answered with or -1
+static int send_request(const char* source_path, const char* output_name)
+{
+    int server = connect_server();
+    if (server < 0) return -1;
+    char request[512];
+    int length = snprintf(request, sizeof(request), "%s%cx86_64%c%s%c", source_path, '\0', '\0', output_name, '\0');
+    if (write(server, request, length) != length) {
+        close(server);
+        return -1;
+    }
+    // a clean compile answers with at most a linker complaint and "exit <code> <ms> ms"
+    char reply[4096];
+    size_t used = 0;
+    ssize_t got;
+    while (used < sizeof(reply) - 1 && (got = read(server, reply + used, sizeof(reply) - 1 - used)) > 0) used += got;
+    close(server);
+    reply[used] = '\0';
+    char* last = strstr(reply, "exit ");
+    int status = -1;
+    if (last) sscanf(last, "exit %d", &status);
+    return status;
+}
+
+int main(int argc, char** argv)
+{
+    char* quark = argc > 1 ? argv[1] : "./quark";
+    size_t requests = argc > 2 ? strtoul(argv[2], NULL, 10) : 50;
+    const size_t sizes[] = { 1, 10, 100, 1000 };
+    const size_t size_count = sizeof(sizes) / sizeof(sizes[0]);
+
+    char* serve_argv[] = { quark, "--serve", SOCKET_PATH, NULL };
+    pid_t server = spawn_quiet(serve_argv);
+    if (server < 0) {
+        fprintf(stderr, "could not start %s --serve\n", quark);
+        return 1;
+    }
+    int waited = 0;
+    int probe;
+    while ((probe = connect_server()) < 0 && waited++ < 500) usleep(10000);
+    if (probe < 0) {
+        fprintf(stderr, "the compile server did not come up\n");
+        kill(server, SIGTERM);
+        return 1;
+    }
+    close(probe);
+
+    printf("%10s %10s %14s %14s %9s\n", "functions", "bytes", "cold ms/req", "server ms/req", "speedup");
+    int result = 0;
+    for (size_t s = 0; s < size_count && result == 0; s++) {
+        size_t length = 0;
+        char* source = generate_functions(sizes[s], &length);
+        FILE* file = fopen("/tmp/bench_serve.qk", "wb");
+        fwrite(source, 1, length, file);
+        fclose(file);
+        free(source);
+
+        char* cold_argv[] = { quark, "/tmp/bench_serve.qk", "x86_64", "/tmp/bench_serve_cold", NULL };
+        double start = wall_seconds();
+        for (size_t r = 0; r < requests; r++) {
+            pid_t pid = spawn_quiet(cold_argv);
+            int status = 0;
+            if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+                fprintf(stderr, "the cold compile failed\n");
+                result = 1;
+                break;
+            }
+        }
+        double cold = (wall_seconds() - start) / requests;
+
+        start = wall_seconds();
+        for (size_t r = 0; r < requests && result == 0; r++) {
+            if (send_request("/tmp/bench_serve.qk", "/tmp/bench_serve_warm") != 0) {
+                fprintf(stderr, "the server compile failed\n");
+                result = 1;
+            }
+        }
+        double warm = (wall_seconds() - start) / requests;
+        if (result) break;
+
+        size_t cold_length = 0, warm_length = 0;
+        char* cold_asm = read_all("/tmp/bench_serve_cold.asm", &cold_length);
+        char* warm_asm = read_all("/tmp/bench_serve_warm.asm", &warm_length);
+        if (!cold_asm || !warm_asm || cold_length != warm_length || memcmp(cold_asm, warm_asm, cold_length) != 0) {
+            fprintf(stderr, "%zu functions: the server's assembly differs from the cold process\n", sizes[s]);
+            result = 1;
+        }
+        free(cold_asm);
+        free(warm_asm);
+        printf("%10zu %10zu %14.3f %14.3f %8.2fx\n", sizes[s] + 1, length, cold * 1000, warm * 1000, cold / warm);
+    }
+
+    kill(server, SIGTERM);
+    waitpid(server, NULL, 0);
+    remove("/tmp/bench_serve.qk");
+    remove("/tmp/bench_serve_cold.asm");
+    remove("/tmp/bench_serve_warm.asm");
+    if (result == 0) printf("every server answer matched the cold process\n");
+    return result;
+}
@@ -0,0 +1,114 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "frontend/tokenization/tokenize.h"
+#include "frontend/parsing/parsing.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Signature collection (main's first pass) on programs with many functions, walking every token
+// the way it used to next to jumping straight to the fn indexes the tokenizer recorded.
+// Every function has a long body, which is what the old walk paid for.
+// usage: ./benchmarks/bench_signatures [most functions] [rounds]
+
+static char* generate_functions(size_t functions, size_t* length)
+{
+    size_t capacity = 64 + functions * 640;
+    char* source = malloc(capacity);
+    size_t used = 0;
+    for (size_t f = 0; f < functions; f++) {
+        used += snprintf(source + used, capacity - used,
+            "fn generated_%zu(a :int, b :long): int {\n"
+            "    let x :int = a * 3 + 7;\n"
+            "    let y :long = b - 11;\n"
+            "    while (x < 100) {\n"
+            "        x = x + 1;\n"
+            "        if (x > 50) {\n"
+            "            y = y + x * 2;\n"
+            "        }\n"
+            "    }\n"
+            "    let z :int = x + a + 1 + 2 + 3 + 4 + 5 + 6 + 7 + 8;\n"
+            "    return z;\n"
+            "}\n",
+            f);
+    }
+    used += snprintf(source + used, capacity - used, "fn main(void): int {\n    return 0;\n}\n");
+    *length = used;
+    return source;
+}
+
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static size_t walk_every_token(Compiler* compiler, Parser* parser)
+{
+    size_t found = 0;
+    while (!parser_at_end(parser)) {
+        if (peek_type(parser, 0) == TOK_FN) {
+            parse_function_node(compiler, parser);
+            found++;
+        }
+        else {
+            advance(parser);
+        }
+    }
+    return found;
+}
+
+static size_t jump_to_functions(Compiler* compiler, Parser* parser)
+{
+    token_stream* stream = parser->tokens;
+    for (size_t f = 0; f < stream->function_count; f++) {
+        parser->current = stream->function_tokens[f];
+        parse_function_node(compiler, parser);
+    }
+    return stream->function_count;
+}
+
+// each run needs its own compiler, registering a function twice is an error
+static double time_first_pass(const char* source, size_t length, bool indexed, size_t* token_count, size_t* found)
+{
+    Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+    size_t function_count = 0;
+    token_stream* stream = tokenize(source, compiler, token_count, &length, &function_count);
+    init_parse_arenas(compiler, *token_count);
+    Parser* parser = make_parser(compiler);
+    parser->tokens = stream;
+    compiler->parser = parser;
+
+    clock_t start = clock();
+    *found = indexed ? jump_to_functions(compiler, parser) : walk_every_token(compiler, parser);
+    double seconds = seconds_since(start);
+    free_global_arenas(compiler);
+    return seconds;
+}
+
+int main(int argc, char** argv)
+{
+    size_t most = argc > 1 ? strtoul(argv[1], NULL, 10) : 40000;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 3;
+
+    printf("%10s %10s %12s %12s %9s\n", "functions", "tokens", "walk ms", "index ms", "speedup");
+    for (size_t functions = 10000; functions <= most; functions *= 2) {
+        size_t length = 0;
+        char* source = generate_functions(functions, &length);
+        double walk_time = 0, index_time = 0;
+        size_t token_count = 0, walked = 0, indexed = 0;
+
+        for (size_t r = 0; r < rounds; r++) {
+            walk_time += time_first_pass(source, length, false, &token_count, &walked);
+            index_time += time_first_pass(source, length, true, &token_count, &indexed);
+        }
+        if (walked != indexed) {
+            fprintf(stderr, "walk found %zu functions, index found %zu\n", walked, indexed);
+            return 1;
+        }
+        printf("%10zu %10zu %12.2f %12.2f %8.2fx\n", indexed, token_count, walk_time * 1000 / rounds,
+            index_time * 1000 / rounds, walk_time / index_time);
+        free(source);
+    }
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "symbol_table/symbol_table.h"
+#include "symbol_table/string_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Chain lengths and lookup time of hash_function() against the old first char/last char/length hash
+// on large generated symbol sets.
+// usage: ./benchmarks/bench_symbols [names in thousands] [lookup rounds]
+
+static size_t legacy_hash(const char* var_name, size_t var_name_length)
+{
+    return ((var_name[0] + 'a') * var_name_length + var_name[var_name_length - 1] * var_name_length / 2);
+}
+
+typedef size_t (*hash_fn)(const char*, size_t);
+
+typedef struct
+{
+    char** names;
+    size_t* lengths;
+    size_t count;
+} name_set;
+
+static double seconds_since(clock_t start)
+{
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static name_set make_names(const char* pattern, size_t count)
+{
+    name_set set = { malloc(count * sizeof(char*)), malloc(count * sizeof(size_t)), count };
+    char buffer[64];
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(pattern, "mixed") == 0) {
+            // short names sharing first and last characters, the worst case for the old hash
+            snprintf(buffer, sizeof(buffer), "a%c%zux", 'a' + (int)(i % 26), i / 26);
+        } else {
+            snprintf(buffer, sizeof(buffer), pattern, i);
+        }
+        set.lengths[i] = strlen(buffer);
+        set.names[i] = malloc(set.lengths[i] + 1);
+        memcpy(set.names[i], buffer, set.lengths[i] + 1);
+    }
+    return set;
+}
+
+static void free_names(name_set* set)
+{
+    for (size_t i = 0; i < set->count; i++) free(set->names[i]);
+    free(set->names);
+    free(set->lengths);
+}
+
+// longest chain and the average number of entries a successful lookup walks
+static void chain_stats(const name_set* set, hash_fn hash, size_t buckets, size_t* longest, double* average)
+{
+    size_t* chains = calloc(buckets, sizeof(size_t));
+    for (size_t i = 0; i < set->count; i++) chains[hash(set->names[i], set->lengths[i]) % buckets]++;
+
+    double walked = 0;
+    *longest = 0;
+    for (size_t b = 0; b < buckets; b++) {
+        if (chains[b] > *longest) *longest = chains[b];
+        walked += (double)chains[b] * (chains[b] + 1) / 2;
+    }
+    *average = walked / set->count;
+    free(chains);
+}
+
+// chained table with length + strncmp compares, the way the scope and function maps used to look names up
+static double chained_lookup_time(const name_set* set, hash_fn hash, size_t buckets, size_t rounds)
+{
+    size_t* heads = malloc(buckets * sizeof(size_t));
+    size_t* next = malloc(set->count * sizeof(size_t));
+    for (size_t b = 0; b < buckets; b++) heads[b] = SIZE_MAX;
+    for (size_t i = 0; i < set->count; i++) {
+        size_t b = hash(set->names[i], set->lengths[i]) % buckets;
+        next[i] = heads[b];
+        heads[b] = i;
+    }
+
+    size_t found = 0;
+    clock_t start = clock();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < set->count; i++) {
+            size_t at = heads[hash(set->names[i], set->lengths[i]) % buckets];
+            while (at != SIZE_MAX) {
+                if (set->lengths[at] == set->lengths[i] && strncmp(set->names[at], set->names[i], set->lengths[i]) == 0) {
+                    found++;
+                    break;
+                }
+                at = next[at];
+            }
+        }
+    }
+    double seconds = seconds_since(start);
+    if (found != set->count * rounds) fprintf(stderr, "chained lookup missed names\n");
+    free(heads);
+    free(next);
+    return seconds;
+}
+
+static double intern_lookup_time(const name_set* set, size_t rounds, Compiler* compiler)
+{
+    string_table* table = make_string_table(1024, compiler);
+    for (size_t i = 0; i < set->count; i++) intern_identifier(table, set->names[i], set->lengths[i], compiler);
+
+    size_t checksum = 0;
+    clock_t start = clock();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < set->count; i++) {
+            checksum += intern_identifier(table, set->names[i], set->lengths[i], compiler);
+        }
+    }
+    double seconds = seconds_since(start);
+    if (checksum != rounds * (set->count * (set->count - 1) / 2)) fprintf(stderr, "interned ids do not match\n");
+    free_string_table(table);
+    return seconds;
+}
+
+int main(int argc, char** argv)
+{
+    size_t thousands = argc > 1 ? strtoul(argv[1], NULL, 10) : 10;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 20;
+    size_t count = thousands * 1000;
+    Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+
+    const char* patterns[] = { "tmp_%04zu", "v%zu", "generated_identifier_%zu", "mixed" };
+    // the 16 buckets each scope's map and the 32 the function map had before they became open-addressing tables
+    const size_t bucket_counts[] = { 16, 32, 4096 };
+
+    for (size_t p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++) {
+        name_set set = make_names(patterns[p], count);
+        printf("%s, %zu names\n", patterns[p], count);
+
+        for (size_t b = 0; b < sizeof(bucket_counts) / sizeof(bucket_counts[0]); b++) {
+            size_t legacy_longest, new_longest;
+            double legacy_average, new_average;
+            chain_stats(&set, legacy_hash, bucket_counts[b], &legacy_longest, &legacy_average);
+            chain_stats(&set, hash_function, bucket_counts[b], &new_longest, &new_average);
+            printf("  %5zu buckets: longest chain %7zu -> %7zu, entries walked per lookup %9.1f -> %9.1f\n",
+                bucket_counts[b], legacy_longest, new_longest, legacy_average, new_average);
+        }
+
+        double lookups = (double)count * rounds / 1e6;
+        double legacy_time = chained_lookup_time(&set, legacy_hash, 4096, rounds);
+        double new_time = chained_lookup_time(&set, hash_function, 4096, rounds);
+        double intern_time = intern_lookup_time(&set, rounds, compiler);
+        printf("  lookups: legacy chained %8.2f M/s, hash_function chained %8.2f M/s, string table %8.2f M/s\n",
+            lookups / legacy_time, lookups / new_time, lookups / intern_time);
+
+        free_names(&set);
+    }
+
+    free_global_arenas(compiler);
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "frontend/tokenization/tokenize.h"
+#include "frontend/tokenization/scan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Tokenizer throughput on generated source that is mostly identifiers, whitespace and line comments.
+// usage: ./benchmarks/bench_tokenize [size in MB] [rounds]
+
+static char* generate_source(size_t target_size, size_t* length)
+{
+    char* source = malloc(target_size + 256);
+    size_t used = 0;
+    size_t n = 0;
+    while (used < target_size) {
+        used += snprintf(source + used, 256,
+            "    // temporary number %zu produced by the generator, keep it around\n"
+            "    let generated_identifier_%zu :long = another_long_identifier_name_%zu + %zu;\n",
+            n, n, n % 97, n * 31);
+        n++;
+    }
+    source[used] = '\0';
+    *length = used;
+    return source;
+}
+
+typedef size_t (*run_fn)(const char*, size_t, size_t);
+
+// walks the buffer the way tokenize() does, but only through the scanners
+static size_t skim(const char* source, size_t length, run_fn whitespace, run_fn identifier, run_fn digits, run_fn line_end)
+{
+    size_t i = 0;
+    size_t runs = 0;
+    while (i < length) {
+        i = whitespace(source, i, length);
+        if (i >= length) break;
+        unsigned char c = (unsigned char)source[i];
+        if (CHAR_TYPE[c] == 1) i = identifier(source, i, length);
+        else if (CHAR_TYPE[c] == 11) i = digits(source, i, length);
+        else if (c == '/' && i + 1 < length && source[i + 1] == '/') i = line_end(source, i + 2, length);
+        else i++;
+        runs++;
+    }
+    return runs;
+}
+
+static double seconds_since(clock_t start)
+{
+    return ((double)(clock() - start)) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 16;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 5;
+    size_t length = 0;
+    char* source = generate_source(megabytes * 1024 * 1024, &length);
+    double mb = (double)length / (1024.0 * 1024.0) * rounds;
+
+    printf("source: %.1f MB, %zu rounds, vector path: %s\n", (double)length / (1024.0 * 1024.0), rounds, scan_backend_name());
+
+    size_t check_scalar = 0, check_vector = 0;
+    clock_t start = clock();
+    for (size_t r = 0; r < rounds; r++) {
+        check_scalar += skim(source, length, scan_whitespace_scalar, scan_identifier_scalar, scan_digits_scalar, scan_line_end_scalar);
+    }
+    double scalar_time = seconds_since(start);
+
+    start = clock();
+    for (size_t r = 0; r < rounds; r++) {
+        check_vector += skim(source, length, scan_whitespace, scan_identifier, scan_digits, scan_line_end);
+    }
+    double vector_time = seconds_since(start);
+
+    if (check_scalar != check_vector) {
+        fprintf(stderr, "scanner mismatch: scalar %zu vs vector %zu\n", check_scalar, check_vector);
+        return 1;
+    }
+    printf("scan scalar : %8.1f MB/s\n", mb / scalar_time);
+    printf("scan vector : %8.1f MB/s (%.2fx)\n", mb / vector_time, scalar_time / vector_time);
+
+    size_t token_count = 0, payload_count = 0;
+    start = clock();
+    for (size_t r = 0; r < rounds; r++) {
+        Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+        size_t function_count = 0;
+        token_stream* stream = tokenize(source, compiler, &token_count, &length, &function_count);
+        payload_count = stream->payload_count;
+        free_global_arenas(compiler);
+    }
+    printf("tokenize()  : %8.1f MB/s\n", mb / seconds_since(start));
+
+    // bytes actually used by the stream against an array of full token structs
+    size_t stream_bytes = token_count * (sizeof(uint8_t) + sizeof(uint32_t)) + payload_count * sizeof(token_payload);
+    printf("token memory: %zu tokens, %.1f bytes/token (array of token: %zu bytes/token, %.1fx)\n",
+        token_count, (double)stream_bytes / token_count, sizeof(token),
+        (double)(token_count * sizeof(token)) / stream_bytes);
+
+    free(source);
+    return 0;
+}
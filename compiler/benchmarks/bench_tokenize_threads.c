@@ -0,0 +1,125 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "frontend/tokenization/tokenize.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Wall-clock tokenize() throughput with 1 to 16 threads on generated source, every run is checked
+// against the single threaded token stream.
+// usage: ./benchmarks/bench_tokenize_threads [size in MB] [rounds]
+
+static char* generate_source(size_t target_size, size_t* length)
+{
+    char* source = malloc(target_size + 512);
+    size_t used = 0;
+    size_t n = 0;
+    while (used < target_size) {
+        used += snprintf(source + used, 512,
+            "fn generated_function_%zu(a :int) :int {\n"
+            "    // temporary number %zu produced by the generator, keep it around\n"
+            "    let generated_identifier_%zu :long = a + %zu;\n"
+            "    return a * 3.5 + another_long_identifier_name_%zu;\n"
+            "}\n",
+            n, n, n, n * 31, n % 97);
+        n++;
+    }
+    source[used] = '\0';
+    *length = used;
+    return source;
+}
+
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+typedef struct
+{
+    uint8_t* types;
+    uint32_t* offsets;
+    token_payload* payloads;
+    size_t count;
+    size_t payload_count;
+    size_t function_count;
+    size_t name_count;
+} token_copy;
+
+static token_copy copy_stream(const token_stream* stream, const Compiler* compiler)
+{
+    token_copy copy = { malloc(stream->count), malloc(stream->count * sizeof(uint32_t)),
+        malloc(stream->payload_count * sizeof(token_payload)), stream->count, stream->payload_count,
+        stream->function_count, compiler->strings->count };
+    memcpy(copy.types, stream->types, stream->count);
+    memcpy(copy.offsets, stream->offsets, stream->count * sizeof(uint32_t));
+    memcpy(copy.payloads, stream->payloads, stream->payload_count * sizeof(token_payload));
+    return copy;
+}
+
+static int same_stream(const token_copy* serial, const token_stream* stream, const Compiler* compiler)
+{
+    if (serial->count != stream->count || serial->payload_count != stream->payload_count
+        || serial->function_count != stream->function_count || serial->name_count != compiler->strings->count
+        || memcmp(serial->types, stream->types, stream->count) != 0
+        || memcmp(serial->offsets, stream->offsets, stream->count * sizeof(uint32_t)) != 0) {
+        return 0;
+    }
+    // payloads are compared by field, the unused bytes of the union are never written
+    for (size_t p = 0; p < stream->payload_count; p++) {
+        const token_payload* a = &serial->payloads[p];
+        const token_payload* b = &stream->payloads[p];
+        if (a->token_index != b->token_index) return 0;
+        TokenType type = (TokenType)stream->types[b->token_index];
+        if (type == TOK_IDENTIFIER && a->symbol_id != b->symbol_id) return 0;
+        if (type == TOK_NUMBER && a->int_value != b->int_value) return 0;
+        if (type == TOK_FLOAT && a->float_value != b->float_value) return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? strtoul(argv[1], NULL, 10) : 64;
+    size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 3;
+    size_t length = 0;
+    char* source = generate_source(megabytes * 1024 * 1024, &length);
+    double mb = (double)length / (1024.0 * 1024.0);
+    const size_t thread_counts[] = { 1, 2, 4, 8, 12, 16 };
+
+    printf("source: %.1f MB, %zu rounds\n", mb, rounds);
+
+    token_copy serial = { 0 };
+    double serial_time = 0;
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+        double best = 0;
+        for (size_t r = 0; r < rounds; r++) {
+            Compiler* compiler = init_compiler_arenas(ARENA_MALLOC);
+            compiler->threads = thread_counts[t];
+            size_t token_count = 0, function_count = 0;
+
+            double start = wall_seconds();
+            token_stream* stream = tokenize(source, compiler, &token_count, &length, &function_count);
+            double seconds = wall_seconds() - start;
+            if (r == 0 || seconds < best) best = seconds;
+
+            if (t == 0 && r == 0) serial = copy_stream(stream, compiler);
+            else if (!same_stream(&serial, stream, compiler)) {
+                fprintf(stderr, "%zu threads: token stream differs from the serial one\n", thread_counts[t]);
+                return 1;
+            }
+            free_global_arenas(compiler);
+        }
+        if (t == 0) serial_time = best;
+        printf("  %2zu threads: %8.1f MB/s, %5.2fx\n", thread_counts[t], mb / best, serial_time / best);
+    }
+    printf("%zu tokens, %zu functions, all thread counts match the serial stream\n", serial.count, serial.function_count);
+
+    free(serial.types);
+    free(serial.offsets);
+    free(serial.payloads);
+    free(source);
+    return 0;
+}
@@ -0,0 +1,191 @@
+#include "utilities/utils.h"
+#include "driver/batch.h"
+#include "driver/compile.h"
+#include "arena/arena.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// the programs not yet taken by a worker, and what became of the ones that were
+typedef struct batch_queue {
+    const batch_list* batch;
+    const char* architecture;
+    const compile_options* options;
+    size_t threads_per_compiler;
+    int* status;
+    bool* linked;
+    size_t next;
+    pthread_mutex_t lock;
+} batch_queue;
+
+// the first length bytes of text followed by suffix, malloced
+static char* copy_string(const char* text, size_t length, const char* suffix)
+{
+    size_t suffix_length = strlen(suffix);
+    char* copy = malloc(length + suffix_length + 1);
+    if (!copy) {
+        fprintf(stderr, "Out of memory reading the batch list\n");
+        exit(ERROR_MEMORY_ALLOCATION);
+    }
+    memcpy(copy, text, length);
+    memcpy(copy + length, suffix, suffix_length + 1);
+    return copy;
+}
+
+void add_batch_source(batch_list* batch, const char* source_path, const char* output_name)
+{
+    if (batch->count == batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity * 2 : 64;
+        batch_entry* grown = realloc(batch->entries, sizeof(batch_entry) * capacity);
+        if (!grown) {
+            fprintf(stderr, "Out of memory reading the batch list\n");
+            exit(ERROR_MEMORY_ALLOCATION);
+        }
+        batch->entries = grown;
+        batch->capacity = capacity;
+    }
+    batch_entry* entry = &batch->entries[batch->count++];
+    entry->source_path = copy_string(source_path, strlen(source_path), "");
+    if (output_name) {
+        entry->output_name = copy_string(output_name, strlen(output_name), "");
+        return;
+    }
+    // programs/fib.qk is built as programs/fib, a dot in a directory name is not an extension
+    const char* slash = strrchr(source_path, '/');
+    const char* dot = strrchr(source_path, '.');
+    if (dot && dot > source_path && (!slash || dot > slash + 1)) entry->output_name = copy_string(source_path, (size_t)(dot - source_path), "");
+    // no extension to drop, fib becomes fib.out rather than overwriting its own source
+    else entry->output_name = copy_string(source_path, strlen(source_path), ".out");
+}
+
+bool add_batch_list(batch_list* batch, const char* list_path)
+{
+    source_file list;
+    if (!readfile(list_path, &list)) return false;
+    // the mapping is private, cutting the lines up in place never reaches the file
+    char* rest = NULL;
+    for (char* line = strtok_r(list.content, "\r\n", &rest); line; line = strtok_r(NULL, "\r\n", &rest)) {
+        char* fields = NULL;
+        char* source_path = strtok_r(line, " \t", &fields);
+        if (!source_path || source_path[0] == '#') continue;
+        add_batch_source(batch, source_path, strtok_r(NULL, " \t", &fields));
+    }
+    close_source_file(&list);
+    return true;
+}
+
+void free_batch_list(batch_list* batch)
+{
+    for (size_t i = 0; i < batch->count; i++) {
+        free(batch->entries[i].source_path);
+        free(batch->entries[i].output_name);
+    }
+    free(batch->entries);
+    batch->entries = NULL;
+    batch->count = 0;
+    batch->capacity = 0;
+}
+
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void* batch_worker(void* argument)
+{
+    batch_queue* queue = argument;
+    Compiler* compiler = init_compiler_arenas(queue->options->arenas);
+    compiler->threads = queue->threads_per_compiler;
+
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        size_t index = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+        if (index >= queue->batch->count) break;
+        const batch_entry* entry = &queue->batch->entries[index];
+
+        // a program's diagnostics are collected and printed in one piece under its name, so the
+        // workers' messages don't interleave
+        char* diagnostics_text = NULL;
+        size_t diagnostics_length = 0;
+        FILE* diagnostics = open_memstream(&diagnostics_text, &diagnostics_length);
+        int status = compile_file(compiler, entry->source_path, queue->architecture, entry->output_name, queue->options, diagnostics ? diagnostics : stderr);
+        if (diagnostics) fclose(diagnostics);
+        if (diagnostics_length) {
+            pthread_mutex_lock(&queue->lock);
+            fprintf(stderr, "%s:\n%s", entry->source_path, diagnostics_text);
+            pthread_mutex_unlock(&queue->lock);
+        }
+        free(diagnostics_text);
+
+        queue->status[index] = status;
+        queue->linked[index] = status == 0 && link_program(entry->output_name);
+    }
+
+    free_global_arenas(compiler);
+    return NULL;
+}
+
+int compile_batch(const batch_list* batch, const char* architecture, size_t workers, const compile_options* options)
+{
+    if (batch->count == 0) {
+        fprintf(stderr, "The batch has no programs to compile\n");
+        return 1;
+    }
+    size_t pool = workers < batch->count ? workers : batch->count;
+    if (pool == 0) pool = 1;
+
+    batch_queue queue = { 0 };
+    queue.batch = batch;
+    queue.architecture = architecture;
+    queue.options = options;
+    // the pool is where the parallelism is, a compiler only gets the cores left over beyond it
+    queue.threads_per_compiler = workers > pool ? workers / pool : 1;
+    queue.status = calloc(batch->count, sizeof(int));
+    queue.linked = calloc(batch->count, sizeof(bool));
+    if (!queue.status || !queue.linked) {
+        fprintf(stderr, "Out of memory starting the batch\n");
+        free(queue.status);
+        free(queue.linked);
+        return ERROR_MEMORY_ALLOCATION;
+    }
+    pthread_mutex_init(&queue.lock, NULL);
+
+    double start = wall_seconds();
+    // the calling thread is one of the workers, a pool that could not start every thread still
+    // gets through the whole list
+    pthread_t* threads = malloc(sizeof(pthread_t) * pool);
+    size_t started = 0;
+    while (threads && started + 1 < pool && pthread_create(&threads[started], NULL, batch_worker, &queue) == 0) started++;
+    batch_worker(&queue);
+    for (size_t t = 0; t < started; t++) pthread_join(threads[t], NULL);
+    double seconds = wall_seconds() - start;
+    free(threads);
+    pthread_mutex_destroy(&queue.lock);
+
+    int result = 0;
+    size_t failed = 0;
+    size_t unlinked = 0;
+    for (size_t i = 0; i < batch->count; i++) {
+        if (queue.status[i] != 0) {
+            fprintf(stderr, "%s: exit %d\n", batch->entries[i].source_path, queue.status[i]);
+            if (failed++ == 0) result = queue.status[i];
+        }
+        else if (!queue.linked[i]) {
+            fprintf(stderr, "%s: not linked\n", batch->entries[i].source_path);
+            unlinked++;
+        }
+    }
+    // compiled but no executable came out of it, the batch did not do its job either
+    if (failed == 0 && unlinked > 0) result = 1;
+    free(queue.status);
+    free(queue.linked);
+
+    printf("compiled %zu files (%zu failed, %zu not linked) in %.3f seconds with %zu workers, %.1f files/sec\n",
+        batch->count, failed, unlinked, seconds, started + 1, seconds > 0.0 ? (double)batch->count / seconds : 0.0);
+    return result;
+}
@@ -0,0 +1,32 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "utilities/utils.h"
+
+// one program of a batch, its .asm and executable are written to output_name
+typedef struct batch_entry {
+    char* source_path;
+    char* output_name;
+} batch_entry;
+
+typedef struct batch_list {
+    batch_entry* entries;
+    size_t count;
+    size_t capacity;
+} batch_list;
+
+// adds one program, without an output name the source path minus its extension is used
+void add_batch_source(batch_list* batch, const char* source_path, const char* output_name);
+// adds every program of a list file ("-" is stdin), one "<source path> [output name]" per line,
+// blank lines and lines starting with # are skipped. false if the list can't be read
+bool add_batch_list(batch_list* batch, const char* list_path);
+void free_batch_list(batch_list* batch);
+
+// compiles and links every program of the batch in this one process. each of the worker threads
+// owns a compiler whose arenas are reset and reused from one program to the next, and a panic only
+// fails the program it came from. diagnostics are printed per program and the throughput in
+// files/sec at the end. returns the exit code of the first program in the list that failed, 1 if every
+// program compiled but one could not be assembled or linked, 0 if all of them were built
+int compile_batch(const batch_list* batch, const char* architecture, size_t workers, const compile_options* options);
+
+#endif
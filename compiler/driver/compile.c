@@ -0,0 +1,208 @@
+#include "utilities/utils.h"
+#include "driver/compile.h"
+#include "arena/arena.h"
+#include "error_handler/error_handler.h"
+#include "frontend/parsing/parsing.h"
+#include "frontend/tokenization/tokenize.h"
+#include "symbol_table/symbol_table.h"
+#include "backend/assembly_generator/x86_64/x86_64.h"
+#include <errno.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+
+extern char** environ;
+
+// appends to one of the AST's malloced node lists, doubling it when it is full
+static void append_ast_node(stmt_id** list, size_t* count, size_t* capacity, stmt_id item, Compiler* compiler) {
+    if (*count == *capacity) {
+        stmt_id* grown = realloc(*list, sizeof(stmt_id) * *capacity * 2);
+        if (!grown) panic(ERROR_MEMORY_ALLOCATION, "AST node list allocation failed", compiler);
+        *list = grown;
+        *capacity *= 2;
+    }
+    (*list)[(*count)++] = item;
+}
+
+// snapshots the arenas at the end of a phase when a memory report is asked for, --mem-report prints it right away
+static void end_phase(Compiler* compiler, const compile_options* options, memory_phase* phases, size_t* phase_count, const char* name) {
+    if (!options->mem_report && !options->mem_report_json) return;
+    snapshot_memory_phase(compiler, &phases[*phase_count], name);
+    if (options->mem_report) print_memory_phase(&phases[*phase_count]);
+    (*phase_count)++;
+}
+
+void compile_source(Compiler* compiler, source_file* file, const char* architecture, const char* output_name, const compile_options* options) {
+    // tokenize
+    size_t token_count = 0;
+    size_t function_count = 0;
+    size_t file_length = file->length;
+    memory_phase phases[4];
+    size_t phase_count = 0;
+
+    token_stream* tokens;
+    if (options->stream_tokens) {
+        // tokens are lexed as the parser reaches them, so the real count is not known yet
+        tokens = open_token_stream(file->content, file_length, compiler);
+        end_phase(compiler, options, phases, &phase_count, "tokenize");
+        init_parse_arenas(compiler, estimate_token_count(file_length));
+    }
+    else {
+        tokens = tokenize(file->content, compiler, &token_count, &file_length, &function_count);
+        if (token_count == 0) {
+            panic(ERROR_INTERNAL, "ERROR: No tokens created! Check your tokenizer.", compiler);
+        }
+        end_phase(compiler, options, phases, &phase_count, "tokenize");
+        init_parse_arenas(compiler, token_count);
+    }
+    
+    //create parser
+    Parser* parser = make_parser(compiler);
+    compiler->parser = parser;
+    parser->tokens = tokens;
+    // Abstract Syntax Tree, init_parse_arenas made its node arrays
+    AST* ast = compiler->ast;
+    ast->node_capacity = 64;
+    ast->nodes = malloc(sizeof(stmt_id) * ast->node_capacity);
+    if (!ast->nodes) panic(ERROR_MEMORY_ALLOCATION, "AST node list allocation failed", compiler);
+    
+    // the tokenizer counted the functions unless it is streaming
+    ast->function_node_capacity = function_count > 16 ? function_count : 16;
+    reserve_function_map(compiler->function_map, function_count, compiler);
+    ast->function_nodes = malloc(sizeof(stmt_id) * ast->function_node_capacity);
+    if (!ast->function_nodes) panic(ERROR_MEMORY_ALLOCATION, "AST function list allocation failed", compiler);
+    ast->node_count = 0;
+    ast->function_node_count = 0;
+    ast->parser = parser;
+    // First pass, collect every function signature
+    if (!tokens->window) {
+        // the tokenizer recorded where every fn is
+        if (options->parallel_parse) {
+            ast->function_bodies = malloc(sizeof(function_body) * (tokens->function_count + 1));
+            if (!ast->function_bodies) panic(ERROR_MEMORY_ALLOCATION, "AST function list allocation failed", compiler);
+        }
+        for (size_t f = 0; f < tokens->function_count; f++) {
+            parser->current = tokens->function_tokens[f];
+            append_ast_node(&ast->function_nodes, &ast->function_node_count, &ast->function_node_capacity, parse_function_node(compiler, parser), compiler);
+            if (ast->function_bodies) ast->function_bodies[f].start = parser->current;
+        }
+        end_phase(compiler, options, phases, &phase_count, "signatures");
+        if (ast->function_bodies) parse_function_bodies(compiler, ast);
+    }
+    else {
+        // a streaming window has to lex its way through the whole file
+        while (!parser_at_end(parser)) {
+            if (peek_type(parser, 0) == TOK_FN) {
+                append_ast_node(&ast->function_nodes, &ast->function_node_count, &ast->function_node_capacity, parse_function_node(compiler, parser), compiler);
+            }
+            else {
+                advance(parser);
+            }
+        }
+        end_phase(compiler, options, phases, &phase_count, "signatures");
+    }
+    // reset parser
+    rewind_parser(parser);
+
+    // parse code. the global scope and the function signatures were made before the mark, the scopes
+    // and symbols of the bodies after it are only read by codegen
+    arena_checkpoint scopes = arena_mark(compiler->symbol_arena);
+    size_t next_function = 0;
+    while (!parser_at_end(parser)) {
+        stmt_id parsed_node = 0;
+        if (ast->function_bodies && peek_type(parser, 0) == TOK_FN) {
+            skip_parsed_function(compiler, parser, next_function++);
+        }
+        else {
+            parsed_node = parse_statement(compiler, parser);
+        }
+        if (parsed_node) {
+            append_ast_node(&ast->nodes, &ast->node_count, &ast->node_capacity, parsed_node, compiler);
+        }
+
+        if (peek_type(parser, 0) == TOK_SEMICOLON)
+        {
+            advance(parser);
+        }
+    }
+    end_phase(compiler, options, phases, &phase_count, "parse");
+
+    // generate code, the generator opens output_name.asm itself
+    if (strncmp("x86_64", architecture, 6) == 0) {
+        generate_assembly_x86_64 ((const AST*)ast, compiler, NULL, (char*)output_name);
+        // every generate_function_code() has returned, the compiler holds no scope past this point
+        arena_rewind(compiler->symbol_arena, scopes);
+        compiler->current_function_symbol_table = NULL;
+        /*else if (strcasecmp("arm64", architecture) == 0) {
+        generate_assembly_arm_64 ((const AST*)ast, compiler);
+        }*/
+    } else
+    {
+        panic(ERROR_UNDEFINED, "undefined system architecture, currently supporting x86_64 only", compiler);
+    }
+
+    end_phase(compiler, options, phases, &phase_count, "codegen");
+
+    if (options->mem_report) {
+        print_memory_report(compiler, file_length);
+    }
+    if (options->mem_report_json && !write_memory_json(options->mem_report_json, phases, phase_count, file_length)) {
+        fprintf(compiler->diagnostics, "Could not write the memory report to %s\n", options->mem_report_json);
+    }
+}
+
+int compile_file(Compiler* compiler, const char* source_path, const char* architecture, const char* output_name, const compile_options* options, FILE* diagnostics) {
+    source_file file;
+    // "-" would be the process's own stdin
+    if (strcmp(source_path, "-") == 0 || !readfile(source_path, &file)) {
+        fprintf(diagnostics, "Error opening file %s\n", source_path);
+        return 1;
+    }
+
+    jmp_buf recover;
+    int status = 0;
+    compiler->diagnostics = diagnostics;
+    compiler->recover = &recover;
+    if (setjmp(recover) == 0) compile_source(compiler, &file, architecture, output_name, options);
+    else status = compiler->failure;
+    compiler->recover = NULL;
+    compiler->diagnostics = stderr;
+
+    close_source_file(&file);
+    reset_compiler_arenas(compiler);
+    return status;
+}
+
+// runs argv to completion, true if it exited with 0
+static bool run_tool(char** argv) {
+    pid_t pid;
+    int failed = posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ);
+    if (failed) {
+        fprintf(stderr, "%s: %s\n", argv[0], strerror(failed));
+        return false;
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return false;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool link_program(const char* output_name) {
+    char assembly[512];
+    char object[512];
+    snprintf(assembly, sizeof(assembly), "%s.asm", output_name);
+    snprintf(object, sizeof(object), "%s.o", output_name);
+
+    // nasm -f elf64 output.asm && ld output.o -o output, spawned directly instead of through a
+    // shell, which is one process less per program and safe to do from several threads
+    char* assemble[] = { "nasm", "-f", "elf64", assembly, NULL };
+    char* link[] = { "ld", object, "-o", (char*)output_name, NULL };
+    if (!run_tool(assemble) || !run_tool(link)) {
+        fprintf(stderr, "Assembling or linking failed.\n");
+        return false;
+    }
+    return true;
+}
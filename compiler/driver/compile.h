@@ -0,0 +1,20 @@
+#ifndef COMPILE_H
+#define COMPILE_H
+
+#include "utilities/utils.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+// tokenizes, parses and generates file into output_name.asm with a compiler fresh from
+// init_compiler_arenas or reset_compiler_arenas, errors panic
+void compile_source(Compiler* compiler, source_file* file, const char* architecture, const char* output_name, const compile_options* options);
+
+// reads and compiles source_path with a recovery point set, so a panic only ends this program.
+// diagnostics go to the given stream, the compiler is reset for the next file either way.
+// returns the exit code a cold quark process would have had
+int compile_file(Compiler* compiler, const char* source_path, const char* architecture, const char* output_name, const compile_options* options, FILE* diagnostics);
+
+// assembles and links output_name.asm into the executable output_name, false if that failed
+bool link_program(const char* output_name);
+
+#endif
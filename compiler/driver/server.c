@@ -0,0 +1,219 @@
+#include "utilities/utils.h"
+#include "driver/server.h"
+#include "driver/compile.h"
+#include "arena/arena.h"
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define REQUEST_LINE_MAX (3 * PATH_MAX)
+
+// SIGINT and SIGTERM stop the accept loop once the request being compiled is answered
+static volatile sig_atomic_t stopping = 0;
+
+static void stop_serving(int signal_number)
+{
+    (void)signal_number;
+    stopping = 1;
+}
+
+static double wall_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static bool unix_address(const char* socket_path, struct sockaddr_un* address)
+{
+    if (strlen(socket_path) >= sizeof(address->sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", socket_path);
+        return false;
+    }
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    strcpy(address->sun_path, socket_path);
+    return true;
+}
+
+// reads the request's fields, each ends in a NUL since that is the one byte a path can't hold. false if
+// the client hangs up first or the fields do not fit
+static bool read_request(int client, char* request, size_t size, char** fields, size_t field_count)
+{
+    size_t length = 0;
+    size_t found = 0;
+    fields[0] = request;
+    while (length < size) {
+        ssize_t got = read(client, request + length, size - length);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        for (size_t end = length; end < length + (size_t)got; end++) {
+            if (request[end] != '\0') continue;
+            if (++found == field_count) return true;
+            fields[found] = &request[end + 1];
+        }
+        length += (size_t)got;
+    }
+    return false;
+}
+
+static void answer(Compiler* compiler, int client, const compile_options* options, size_t* requests, double* first_ms, double* total_ms)
+{
+    FILE* reply = fdopen(client, "w");
+    if (!reply) {
+        close(client);
+        return;
+    }
+
+    char request[REQUEST_LINE_MAX];
+    char* fields[3];
+    if (!read_request(client, request, sizeof(request), fields, 3)) {
+        fprintf(reply, "Bad request, expected the source path, architecture and output name, each ending in a NUL\nexit 1 0.000 ms\n");
+        fclose(reply);
+        return;
+    }
+    char* source_path = fields[0];
+    char* architecture = fields[1];
+    char* output_name = fields[2];
+
+    double start = wall_seconds();
+    int status = compile_file(compiler, source_path, architecture, output_name, options, reply);
+    double ms = (wall_seconds() - start) * 1000.0;
+    // no binary came out of it, the client must not report success
+    if (status == 0 && !link_program(output_name)) {
+        fprintf(reply, "Assembling or linking failed.\n");
+        status = 1;
+    }
+
+    printf("%s: exit %d, compiled in %.3f ms\n", source_path, status, ms);
+    fflush(stdout);
+    if (*requests == 0) *first_ms = ms;
+    else *total_ms += ms;
+    (*requests)++;
+
+    fprintf(reply, "exit %d %.3f ms\n", status, ms);
+    fclose(reply);
+}
+
+int serve(const char* socket_path, size_t threads, const compile_options* options)
+{
+    struct sockaddr_un address;
+    if (!unix_address(socket_path, &address)) return 1;
+
+    // a socket left behind by a server that was killed, anything else at that path is not ours to remove
+    struct stat existing;
+    if (stat(socket_path, &existing) == 0 && S_ISSOCK(existing.st_mode)) unlink(socket_path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 64) != 0) {
+        perror("Error opening the compile server socket");
+        if (listener >= 0) close(listener);
+        return 1;
+    }
+
+    // no SA_RESTART, a signal has to interrupt accept()
+    struct sigaction stop = { 0 };
+    stop.sa_handler = stop_serving;
+    sigemptyset(&stop.sa_mask);
+    sigaction(SIGINT, &stop, NULL);
+    sigaction(SIGTERM, &stop, NULL);
+    // a client that hangs up early must not take the server with it
+    signal(SIGPIPE, SIG_IGN);
+
+    Compiler* compiler = init_compiler_arenas(options->arenas);
+    compiler->threads = threads;
+    printf("serving on %s\n", socket_path);
+    fflush(stdout);
+
+    size_t requests = 0;
+    double first_ms = 0.0, total_ms = 0.0;
+    while (!stopping) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            perror("Error accepting a compile request");
+            break;
+        }
+        answer(compiler, client, options, &requests, &first_ms, &total_ms);
+    }
+
+    // the first request pays for allocating the arenas like a cold process does, the rest reuse them
+    if (requests > 1) printf("served %zu requests, first in %.3f ms, the rest in %.3f ms on average\n", requests, first_ms, total_ms / (double)(requests - 1));
+    else printf("served %zu requests\n", requests);
+
+    free_global_arenas(compiler);
+    close(listener);
+    unlink(socket_path);
+    return 0;
+}
+
+int request_compile(const char* socket_path, const char* source_path, const char* architecture, const char* output_name)
+{
+    struct sockaddr_un address;
+    if (!unix_address(socket_path, &address)) return 1;
+
+    char source[PATH_MAX];
+    char output[PATH_MAX];
+    char directory[PATH_MAX];
+    if (!realpath(source_path, source)) {
+        perror("Error opening file");
+        return 1;
+    }
+    int written;
+    if (output_name[0] == '/') written = snprintf(output, sizeof(output), "%s", output_name);
+    else if (getcwd(directory, sizeof(directory))) written = snprintf(output, sizeof(output), "%s/%s", directory, output_name);
+    else {
+        perror("Error resolving the output name");
+        return 1;
+    }
+    // a cut short path would send the server off to write some other file
+    if (written < 0 || (size_t)written >= sizeof(output)) {
+        fprintf(stderr, "Error resolving the output name: the path is longer than %d bytes\n", PATH_MAX - 1);
+        return 1;
+    }
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0 || connect(server, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        perror("Error connecting to the compile server");
+        if (server >= 0) close(server);
+        return 1;
+    }
+    FILE* reply = fdopen(server, "r+");
+    if (!reply) {
+        close(server);
+        return 1;
+    }
+    fprintf(reply, "%s%c%s%c%s%c", source, '\0', architecture, '\0', output, '\0');
+    fflush(reply);
+
+    // every line but the last is a diagnostic, the last one is the exit code and compile time
+    char line[REQUEST_LINE_MAX];
+    char previous[REQUEST_LINE_MAX];
+    bool have_previous = false;
+    while (fgets(line, sizeof(line), reply)) {
+        if (have_previous) fputs(previous, stderr);
+        memcpy(previous, line, sizeof(line));
+        have_previous = true;
+    }
+    fclose(reply);
+
+    int status = 1;
+    double ms = 0.0;
+    if (!have_previous || sscanf(previous, "exit %d %lf ms", &status, &ms) != 2) {
+        fprintf(stderr, "The compile server hung up without an answer\n");
+        return 1;
+    }
+    if (status == 0) {
+        printf("Code compiled in %.6f seconds\n", ms / 1000.0);
+        printf("Compilation Successful\n");
+    }
+    return status;
+}
@@ -0,0 +1,17 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "utilities/utils.h"
+
+// compile server on a unix socket. a client connects and sends "<source path>\0<architecture>\0<output
+// name>\0", the same three arguments quark takes, NUL terminated so a path may hold spaces. the server
+// compiles and links it like quark would, sends back the diagnostics and ends with "exit <code> <ms> ms\n"
+// before closing the connection, the code is 1 when assembling or linking failed. one compiler serves every request, its arenas are reset in between.
+// runs until SIGINT or SIGTERM, returns the process exit code
+int serve(const char* socket_path, size_t threads, const compile_options* options);
+
+// sends one request to a compile server, relays its diagnostics to stderr and returns the exit code
+// the compile would have had. relative paths are resolved here since the server has its own directory
+int request_compile(const char* socket_path, const char* source_path, const char* architecture, const char* output_name);
+
+#endif
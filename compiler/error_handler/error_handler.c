@@ -2,56 +2,87 @@
 #include "arena/arena.h"
 #include "error_handler/error_handler.h"
 #include "frontend/parsing/parsing.h"
+#include "utilities/heap_check.h"
+#include <pthread.h>
+
+// body parsing workers report through here at the same time, one message at a time keeps them readable
+// and builds the line index only once
+static pthread_mutex_t report_lock = PTHREAD_MUTEX_INITIALIZER;
+
 void warning(char* message, Compiler* compiler) {
-    if(compiler->parser){
-        fprintf(stderr, " at line %zu: \n", peek(compiler->parser, 0)->line);
+    // the line index is built the first time a position is asked for, once per program
+    const char* guarded = heap_guard(NULL);
+    pthread_mutex_lock(&report_lock);
+    if(compiler->parser && compiler->parser->tokens){
+        source_position position = parser_position(compiler->parser);
+        fprintf(compiler->diagnostics, " at line %zu, column %zu: \n", position.line, position.column);
     }
-    fprintf(stderr, "\n%s\n", message);
+    fprintf(compiler->diagnostics, "\n%s\n", message);
+    pthread_mutex_unlock(&report_lock);
+    heap_guard(guarded);
 }
 void panic(error_code error_code, char* message, Compiler* compiler)
 {
+    // a panic leaves whatever phase was guarded for good
+    heap_guard(NULL);
+    pthread_mutex_lock(&report_lock);
     switch (error_code) {
         case ERROR_SYNTAX:
-            fprintf(stderr, "Syntax error");
+            fprintf(compiler->diagnostics, "Syntax error");
             break;
         case ERROR_TYPE_MISMATCH:
-            fprintf(stderr, "Type mismatch");
+            fprintf(compiler->diagnostics, "Type mismatch");
             break;
         case ERROR_UNDEFINED_VARIABLE:
-            fprintf(stderr, "Undefined variable");
+            fprintf(compiler->diagnostics, "Undefined variable");
             break;
         case ERROR_UNDEFINED_FUNCTION:
-            fprintf(stderr, "Undefined function");
+            fprintf(compiler->diagnostics, "Undefined function");
             break;
         case ERROR_ARGUMENT_COUNT:
-            fprintf(stderr, "Wrong number of arguments");
+            fprintf(compiler->diagnostics, "Wrong number of arguments");
             break;
         case ERROR_DIVISION_BY_ZERO:
-            fprintf(stderr, "Division by zero");
+            fprintf(compiler->diagnostics, "Division by zero");
             break;
         case ERROR_MEMORY_ALLOCATION:
-            fprintf(stderr, "Memory allocation failed");
+            fprintf(compiler->diagnostics, "Memory allocation failed");
             break;
         case ERROR_RUNTIME:
-            fprintf(stderr, "Runtime error");
+            fprintf(compiler->diagnostics, "Runtime error");
             break;
         case ERROR_INTERNAL:
-            fprintf(stderr, "Internal compiler error");
+            fprintf(compiler->diagnostics, "Internal compiler error");
             break;
         case ERROR_LOGICAL:
-            fprintf(stderr, "Logical error");
+            fprintf(compiler->diagnostics, "Logical error");
             break;
         default:
-            fprintf(stderr, "Unknown error");
+            fprintf(compiler->diagnostics, "Unknown error");
             break;
     }
-    if(compiler->parser){
-        fprintf(stderr, " at line %zu: \n", peek(compiler->parser, 0)->line);
+    if(compiler->parser && compiler->parser->tokens){
+        source_position position = parser_position(compiler->parser);
+        fprintf(compiler->diagnostics, " at line %zu, column %zu: \n", position.line, position.column);
+    }
+    fprintf(compiler->diagnostics, "\n%s\n", message);
+    fprintf(compiler->diagnostics, "compilation process stopped\n");
+    fflush(compiler->diagnostics);
+
+    // without a recovery point the lock stays held so no other worker reports while the process exits
+    if (compiler->recover) pthread_mutex_unlock(&report_lock);
+    stop_compilation(error_code, compiler);
+}
+
+void stop_compilation(error_code error_code, Compiler* compiler)
+{
+    if (compiler->recover) {
+        compiler->failure = error_code;
+        longjmp(*compiler->recover, error_code);
     }
-    fprintf(stderr, "\n%s\n", message);
-    fprintf(stderr, "compilation process stopped\n");
 
-    free_global_arenas(compiler);
+    // the other workers are still using the main compiler's memory, exiting frees it anyway
+    if (!compiler->parse_worker) free_global_arenas(compiler);
     
     exit(error_code);
 }
@@ -5,5 +5,7 @@
 
 void panic(error_code error_code, char* message, Compiler* compiler);
 void warning(char* message, Compiler* compiler);
+// ends a compilation whose error was already reported, see Compiler.recover
+void stop_compilation(error_code error_code, Compiler* compiler);
 
 #endif
\ No newline at end of file
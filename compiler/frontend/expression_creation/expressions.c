@@ -1,173 +1,122 @@
 #include "frontend/expression_creation/expressions.h"
 #include "utilities/utils.h"
 #include "arena/arena.h"
+#include "ast/ast.h"
 #include "symbol_table/symbol_table.h"
+#include "symbol_table/type_table.h"
 #include "error_handler/error_handler.h"
 #include "frontend/parsing/parsing.h"
 #include <stdbool.h>
 #include <stdio.h>
 
-node* create_number_node(int value, Compiler* compiler)
+expr_id create_number_node(int value, Compiler* compiler)
 {
-    node* number_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-    number_node -> type = NODE_EXPRESSION;
-    number_node -> expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-    number_node -> expr -> type = EXPR_INT;
-    number_node -> expr -> integer.value = value;
     // if(value < int max) int
     // else long
-    number_node->expr->result_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    if (!number_node->expr->result_type) {
-        panic(ERROR_MEMORY_ALLOCATION, "Number expression result_type allocation failed", compiler);
-    }
+    Data_type result_type = DATA_TYPE_INT;
+    if (value > 2147483647 || value < -2147483648) result_type = DATA_TYPE_LONG;
 
-    number_node->expr->result_type->data_type_family = FAMILY_FLAT;
-    if (value <= 2147483647 && value >= -2147483648) {
-        number_node->expr->result_type->flat_type.flat_data_type = TOK_INT;
-    }
-    else if (value > 2147483647 || value < -2147483648)
-    {
-        number_node->expr->result_type->flat_type.flat_data_type = TOK_LONG;
-    }
+    expr_id number_node = new_expression(compiler, EXPR_INT);
+    expression* number = ast_expression(compiler->ast, number_node);
+    number->integer.value = value;
+    number->result_type = intern_flat_type(result_type, compiler);
     return number_node;
 }
 
-node* create_variable_node_dec(char* var_name, size_t length, variable_storage_type storage_type, normal_register reg_location, data_type* data_type, Compiler* compiler)
+// declares the variable in the current scope, the declaration itself is not part of the AST
+symbol_node* create_variable_node_dec(char* var_name, size_t length, uint32_t symbol_id, variable_storage_type storage_type, normal_register reg_location, data_type* data_type, Compiler* compiler)
 {
-    node* var_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-    if(!var_node) return NULL;
-    var_node->type = NODE_EXPRESSION;
-    var_node->expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-    if(!var_node->expr) return NULL;
-    var_node->expr->variable.length = length;
-    var_node->expr->variable.name = var_name;
-    var_node->expr->variable.hash = hash_function(var_name, length);
-    var_node->expr->type = EXPR_IDENTIFIER;
-    var_node->expr->variable.data_type = data_type;
-    var_node->expr->variable.node_in_table = add_var_to_current_scope(compiler, var_node->expr, storage_type, reg_location); // offset will be set later during code generation and size will be int for now (8 bytes)
-    var_node->expr->result_type = data_type;
-    var_node->expr->variable.node_in_table->address_is_taken = false;
-    return var_node;
+    expression declaration = { 0 };
+    declaration.type = EXPR_IDENTIFIER;
+    declaration.variable.length = length;
+    declaration.variable.name = var_name;
+    declaration.variable.symbol_id = symbol_id;
+    declaration.result_type = data_type;
+    symbol_node* var = add_var_to_current_scope(compiler, &declaration, storage_type, reg_location); // offset will be set later during code generation and size will be int for now (8 bytes)
+    var->address_is_taken = false;
+    return var;
 }
 
-node* create_address_node(node* operand, Compiler* compiler) {
-    if (operand->expr->type != EXPR_IDENTIFIER) panic(ERROR_LOGICAL, "Cannot pass '&' operator to a temporary value, must be passed on a stack or heap allocated variable", compiler);
-    node* address_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-    if(!address_node) return NULL;
-    address_node->type = NODE_EXPRESSION;
-    address_node->expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-    if(!address_node->expr) return NULL;
-    
-    if (operand->expr->variable.node_in_table->where_it_is_stored == STORE_IN_REGISTER || operand->expr->variable.node_in_table->where_it_is_stored == STORE_IN_FLOAT_REGISTER) {
-        address_node->expr->address.stack_offset = peek_symbol_stack(compiler)->scope_offset;
-        peek_symbol_stack(compiler)->scope_offset += Data_type_sizes_from_data_types[operand->expr->variable.data_type->general_data_type];
-    }
-
-    address_node->expr->type = EXPR_ADDRESS;
-    address_node->expr->address.operand = operand->expr;
-    address_node->expr->address.operand->variable.node_in_table->address_is_taken = true;
+expr_id create_address_node(expr_id operand, Compiler* compiler) {
+    expression* variable = ast_expression(compiler->ast, operand);
+    if (variable->type != EXPR_IDENTIFIER) panic(ERROR_LOGICAL, "Cannot pass '&' operator to a temporary value, must be passed on a stack or heap allocated variable", compiler);
+    symbol_node* var = variable->variable.node_in_table;
+    data_type* operand_type = variable->result_type;
 
-    address_node->expr->result_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    if (!address_node->expr->result_type) {
-        panic(ERROR_MEMORY_ALLOCATION, "Address expression result_type allocation failed", compiler);
+    size_t stack_offset = 0;
+    if (var->where_it_is_stored == STORE_IN_REGISTER || var->where_it_is_stored == STORE_IN_FLOAT_REGISTER) {
+        stack_offset = peek_symbol_stack(compiler)->scope_offset;
+        peek_symbol_stack(compiler)->scope_offset += Data_type_sizes_from_data_types[operand_type->general_data_type];
     }
+    var->address_is_taken = true;
 
-    address_node->expr->result_type->data_type_family = FAMILY_ADDRESS;
-    address_node->expr->result_type->general_data_type = DATA_TYPE_ADDRESS;
-    address_node->expr->result_type->address_type.base_type = operand->expr->result_type;
+    expr_id address_node = new_expression(compiler, EXPR_ADDRESS);
+    expression* address = ast_expression(compiler->ast, address_node);
+    address->address.operand = operand;
+    address->address.stack_offset = stack_offset;
+    address->result_type = intern_address_type(operand_type, compiler);
     return address_node;   
 }
 
-node* create_deref_node(node* operand, Compiler* compiler) {
-    if (operand->expr->result_type->data_type_family != FAMILY_POINTER) panic(ERROR_LOGICAL, "Cannot dereference a non-pointer type", compiler);
-    
-    node* deref_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-    if(!deref_node) return NULL;
-    deref_node->type = NODE_EXPRESSION;
-    deref_node->expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-    if(!deref_node->expr) return NULL;
-
-    deref_node->expr->type = EXPR_POINTER_DEREF;
-    deref_node->expr->address.operand = operand->expr;
-    
-    deref_node->expr->result_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    if (!deref_node->expr->result_type) {
-        panic(ERROR_MEMORY_ALLOCATION, "Address expression result_type allocation failed", compiler);
-    }
+expr_id create_deref_node(expr_id operand, Compiler* compiler) {
+    data_type* operand_type = ast_expression(compiler->ast, operand)->result_type;
+    if (operand_type->data_type_family != FAMILY_POINTER) panic(ERROR_LOGICAL, "Cannot dereference a non-pointer type", compiler);
 
-    deref_node->expr->result_type = operand->expr->result_type->address_type.base_type;
+    expr_id deref_node = new_expression(compiler, EXPR_POINTER_DEREF);
+    expression* deref = ast_expression(compiler->ast, deref_node);
+    deref->dereference.operand = operand;
+    deref->result_type = operand_type->address_type.base_type;
     return deref_node;   
 }
 
-node* create_unary_node(TokenType op, node* operand, Compiler* compiler)
+expr_id create_unary_node(TokenType op, expr_id operand, Compiler* compiler)
 {
-    node* unary_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-    if(!unary_node) return NULL;
-    unary_node->type = NODE_EXPRESSION;
-    unary_node->expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-    if(!unary_node->expr) return NULL;
-    unary_node->expr->type = EXPR_UNARY;
-    unary_node->expr->unary.op = op;
-    unary_node->expr->unary.operand = operand->expr;
-
-    unary_node->expr->result_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    if (!unary_node->expr->result_type) {
-        panic(ERROR_MEMORY_ALLOCATION, "Unary expression result_type allocation failed", compiler);
-    }
-    unary_node->expr->result_type = operand->expr->result_type;
+    data_type* operand_type = ast_expression(compiler->ast, operand)->result_type;
+    expr_id unary_node = new_expression(compiler, EXPR_UNARY);
+    expression* unary = ast_expression(compiler->ast, unary_node);
+    unary->unary.op = op;
+    unary->unary.operand = operand;
+    unary->result_type = operand_type;
     return unary_node;
 }
 
 
-node* create_bin_node(node* left, TokenType op, Parser* parser, bool constant_foldable, Compiler* compiler)
+expr_id create_bin_node(expr_id left, TokenType op, Parser* parser, bool constant_foldable, Compiler* compiler)
 {
-    node* right_node = parse_expression(parser, presedences[op], constant_foldable, compiler);
+    expr_id right_node = parse_expression(parser, presedences[op], constant_foldable, compiler);
     if (!right_node) {
         panic(ERROR_MEMORY_ALLOCATION, "Binary expression allocation failed", compiler);
     }
 
-    
-    node* bin_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-    
-    if (!bin_node) {
-        panic(ERROR_MEMORY_ALLOCATION, "Binary expression allocation failed", compiler);
-    }
-
-    
-    bin_node->type = NODE_EXPRESSION;
-    bin_node-> expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-    
-    if (!bin_node->expr) {
-        panic(ERROR_MEMORY_ALLOCATION, "Binary expression allocation failed", compiler);
-    }
+    // everything needed from the operands is read before the binary node is added, adding it may move them
+    expression* left_expr = ast_expression(compiler->ast, left);
+    expression* right_expr = ast_expression(compiler->ast, right_node);
+    data_type* left_type = left_expr->result_type;
+    data_type* right_type = right_expr->result_type;
 
-    bin_node->expr->result_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    if (!bin_node->expr->result_type) {
-        panic(ERROR_MEMORY_ALLOCATION, "Binary expression result_type allocation failed", compiler);
-    }
+    // only flat operands decide it below, anything else is a flat int
+    Data_type result_type = DATA_TYPE_INT;
     
-    if (right_node->expr->type == EXPR_INIT_LIST || left->expr->type == EXPR_INIT_LIST ) {
+    if (right_expr->type == EXPR_INIT_LIST || left_expr->type == EXPR_INIT_LIST ) {
         panic(ERROR_ARGUMENT_COUNT, "Initializer list cannot be evaluated", compiler);
     
     }
-    if (left->expr->result_type && right_node->expr->result_type) {
-        if (left->expr->result_type->data_type_family == FAMILY_FLAT && right_node->expr->result_type->data_type_family == FAMILY_FLAT){
-            if (left->expr->result_type->general_data_type == DATA_TYPE_DOUBLE || right_node->expr->result_type->general_data_type == DATA_TYPE_DOUBLE) {
-                if ((left->expr->result_type->general_data_type == DATA_TYPE_DOUBLE || left->expr->result_type->general_data_type == DATA_TYPE_FLOAT) && (right_node->expr->result_type->general_data_type == DATA_TYPE_DOUBLE || right_node->expr->result_type->general_data_type == DATA_TYPE_FLOAT))
+    if (left_type && right_type) {
+        if (left_type->data_type_family == FAMILY_FLAT && right_type->data_type_family == FAMILY_FLAT){
+            if (left_type->general_data_type == DATA_TYPE_DOUBLE || right_type->general_data_type == DATA_TYPE_DOUBLE) {
+                if ((left_type->general_data_type == DATA_TYPE_DOUBLE || left_type->general_data_type == DATA_TYPE_FLOAT) && (right_type->general_data_type == DATA_TYPE_DOUBLE || right_type->general_data_type == DATA_TYPE_FLOAT))
                 {
-                    bin_node->expr->result_type->general_data_type = DATA_TYPE_DOUBLE;
-                    bin_node->expr->result_type->flat_type.flat_data_type = TOK_DOUBLE;
+                    result_type = DATA_TYPE_DOUBLE;
                 }
                 else
                 {
                     panic(ERROR_TYPE_MISMATCH, "Type mismatch in binary expression, one is double and the other is not", compiler);
                 }
             }
-            else if (left->expr->result_type->general_data_type == DATA_TYPE_FLOAT || right_node->expr->result_type->general_data_type == DATA_TYPE_FLOAT) {
-                if (left->expr->result_type->general_data_type == DATA_TYPE_FLOAT && right_node->expr->result_type->general_data_type == DATA_TYPE_FLOAT)
+            else if (left_type->general_data_type == DATA_TYPE_FLOAT || right_type->general_data_type == DATA_TYPE_FLOAT) {
+                if (left_type->general_data_type == DATA_TYPE_FLOAT && right_type->general_data_type == DATA_TYPE_FLOAT)
                 {
-                    bin_node->expr->result_type->general_data_type = DATA_TYPE_FLOAT;
-                    bin_node->expr->result_type->flat_type.flat_data_type = TOK_FLOAT;
+                    result_type = DATA_TYPE_FLOAT;
                 }
                 else
                 {
@@ -175,22 +124,20 @@ node* create_bin_node(node* left, TokenType op, Parser* parser, bool constant_fo
                 }
                 
             }
-            else if (left->expr->result_type->general_data_type == DATA_TYPE_LONG || right_node->expr->result_type->general_data_type == DATA_TYPE_LONG) {
-                if ((left->expr->result_type->general_data_type == DATA_TYPE_LONG || left->expr->result_type->general_data_type == DATA_TYPE_INT) && (right_node->expr->result_type->general_data_type == DATA_TYPE_LONG || right_node->expr->result_type->general_data_type == DATA_TYPE_INT))
+            else if (left_type->general_data_type == DATA_TYPE_LONG || right_type->general_data_type == DATA_TYPE_LONG) {
+                if ((left_type->general_data_type == DATA_TYPE_LONG || left_type->general_data_type == DATA_TYPE_INT) && (right_type->general_data_type == DATA_TYPE_LONG || right_type->general_data_type == DATA_TYPE_INT))
                 {
-                    bin_node->expr->result_type->general_data_type = DATA_TYPE_LONG;
-                    bin_node->expr->result_type->flat_type.flat_data_type = TOK_LONG;
+                    result_type = DATA_TYPE_LONG;
                 }
                 else
                 {
                     panic(ERROR_TYPE_MISMATCH, "Type mismatch in binary expression", compiler);
                 }
             }
-            else if (left->expr->result_type->general_data_type == DATA_TYPE_INT || right_node->expr->result_type->general_data_type == DATA_TYPE_INT) {
-                if (left->expr->result_type->general_data_type == DATA_TYPE_INT && right_node->expr->result_type->general_data_type == DATA_TYPE_INT)
+            else if (left_type->general_data_type == DATA_TYPE_INT || right_type->general_data_type == DATA_TYPE_INT) {
+                if (left_type->general_data_type == DATA_TYPE_INT && right_type->general_data_type == DATA_TYPE_INT)
                 {
-                    bin_node->expr->result_type->general_data_type = DATA_TYPE_INT;
-                    bin_node->expr->result_type->flat_type.flat_data_type = TOK_INT;
+                    result_type = DATA_TYPE_INT;
                 }
                 else
                 {
@@ -202,68 +149,88 @@ node* create_bin_node(node* left, TokenType op, Parser* parser, bool constant_fo
             }
         }
     }
-    bin_node->expr->type = EXPR_BINARY;
-    bin_node->expr->binary.left = left->expr;
-    bin_node->expr->binary.right = right_node->expr;
-    bin_node->expr->binary.constant_foldable = constant_foldable;
-
+    TokenType bin_op = TOK_NONE;
     switch (op)
     {
     case TOK_ADD:
-        bin_node->expr->binary.op = TOK_ADD;
+        bin_op = TOK_ADD;
         break;
     
     case TOK_SUB:
-        bin_node->expr->binary.op = TOK_SUB;
+        bin_op = TOK_SUB;
         break;
     
     case TOK_MUL:
-        bin_node->expr->binary.op = TOK_MUL;
+        bin_op = TOK_MUL;
         break;
     
     case TOK_DIV:
-        bin_node->expr->binary.op = TOK_DIV;
+        bin_op = TOK_DIV;
         break;
 
     case TOK_PERCENT:
-        bin_node->expr->binary.op = TOK_PERCENT;
+        bin_op = TOK_PERCENT;
         break;
 
     case TOK_EQ:
-        bin_node->expr->binary.op = TOK_EQ;
+        bin_op = TOK_EQ;
         break;
     
     case TOK_NE:
-        bin_node->expr->binary.op = TOK_NE;
+        bin_op = TOK_NE;
         break;
 
     case TOK_GT:
-        bin_node->expr->binary.op = TOK_GT;
+        bin_op = TOK_GT;
         break;
 
     case TOK_GE:
-        bin_node->expr->binary.op = TOK_GE;
+        bin_op = TOK_GE;
         break;
 
     case TOK_LT:
-        bin_node->expr->binary.op = TOK_LT;
+        bin_op = TOK_LT;
         break;
         
     case TOK_LE:
-        bin_node->expr->binary.op = TOK_LE;
+        bin_op = TOK_LE;
         break;
 
     default:
         fprintf(stderr, "unidentified operator\n");
         panic(ERROR_SYNTAX, "Unknown binary operator", compiler);
     }
+
+    expr_id bin_node = new_expression(compiler, EXPR_BINARY);
+    expression* binary = ast_expression(compiler->ast, bin_node);
+    binary->binary.left = left;
+    binary->binary.right = right_node;
+    binary->binary.op = bin_op;
+    binary->binary.constant_foldable = constant_foldable;
+    binary->result_type = intern_flat_type(result_type, compiler);
     return bin_node;
 }
 
-node* create_func_call_node(char* func_name, size_t name_length, expression* arguments, size_t param_count, Compiler* compiler) 
+// interned types are the same type exactly when their pointers are. on top of that an int and a long
+// convert into each other, and an array or an &x passed for a pointer hands over the address of
+// something of the type the pointer points to
+static bool argument_fits(const data_type* argument, const data_type* parameter)
+{
+    if (argument == parameter) return true;
+    bool argument_integer = argument->general_data_type == DATA_TYPE_INT || argument->general_data_type == DATA_TYPE_LONG;
+    bool parameter_integer = parameter->general_data_type == DATA_TYPE_INT || parameter->general_data_type == DATA_TYPE_LONG;
+    if (argument_integer && parameter_integer) return true;
+    if (parameter->data_type_family != FAMILY_POINTER) return false;
+    if (argument->data_type_family == FAMILY_ARRAY) return argument->array_type.array_of == parameter->pointer_type.base_type;
+    if (argument->data_type_family == FAMILY_ADDRESS) return argument->address_type.base_type == parameter->pointer_type.base_type;
+    return false;
+}
+
+// arguments is where the argument ids start in the AST's id lists
+expr_id create_func_call_node(char* func_name, size_t name_length, uint32_t symbol_id, uint32_t arguments, size_t param_count, Compiler* compiler) 
 {
 
-    function_node* func_dec_node = find_function_symbol_node(func_name, name_length, hash_function(func_name, name_length), compiler);
+    function_node* func_dec_node = find_function_symbol_node(symbol_id, compiler);
     
     if(!func_dec_node) {
         panic(ERROR_UNDEFINED, "Function not found", compiler);
@@ -275,83 +242,48 @@ node* create_func_call_node(char* func_name, size_t name_length, expression* arg
 
     for (size_t i = 0; i < param_count; i++)
     {
-                if((arguments[i].result_type->general_data_type != func_dec_node->parameters[i].variable.data_type->general_data_type)) {
-                if ((arguments[i].result_type->general_data_type == DATA_TYPE_POINTER && func_dec_node->parameters[i].variable.data_type->general_data_type != DATA_TYPE_ARRAY) || (arguments[i].result_type->general_data_type != DATA_TYPE_POINTER && func_dec_node->parameters[i].variable.data_type->general_data_type == DATA_TYPE_ARRAY)) {
-                    printf("%i vs %i\n", arguments[i].result_type->general_data_type, func_dec_node->parameters[i].variable.data_type->general_data_type);
+                expression* argument = ast_expression(compiler->ast, compiler->ast->lists[arguments + i]);
+                if (!argument_fits(argument->result_type, func_dec_node->parameters[i].result_type)) {
                     panic(ERROR_TYPE_MISMATCH, "Function argument type mismatch", compiler);
                 }
-            }
         
     }
     
 
-    node* func_call_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-    if(!func_call_node) panic(ERROR_MEMORY_ALLOCATION, "Function call node allocation failed", compiler);
-    func_call_node->type = NODE_EXPRESSION;
-    func_call_node->expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-    if(!func_call_node->expr) panic(ERROR_MEMORY_ALLOCATION, "Function call expression allocation failed", compiler);
-    func_call_node->expr->type = EXPR_FUNCTION_CALL;
-    func_call_node->expr->func_call.name = func_name;
-    func_call_node->expr->func_call.name_length = name_length;
-    func_call_node->expr->func_call.arguments = arguments;
-    func_call_node->expr->func_call.parameter_count = param_count;
-
-    func_call_node->expr->result_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    if (!func_call_node->expr->result_type) {
-        panic(ERROR_MEMORY_ALLOCATION, "Function call expression result_type allocation failed", compiler);
-    }
-    func_call_node->expr->result_type = func_dec_node->return_type;
+    expr_id func_call_node = new_expression(compiler, EXPR_FUNCTION_CALL);
+    expression* call = ast_expression(compiler->ast, func_call_node);
+    call->func_call.name = func_name;
+    call->func_call.name_length = name_length;
+    call->func_call.arguments = arguments;
+    call->func_call.parameter_count = param_count;
+    call->result_type = func_dec_node->return_type;
     return func_call_node;
 
 }
 
-node* create_variable_node(char* var_name, size_t length, Compiler* compiler)
+expr_id create_variable_node(char* var_name, size_t length, uint32_t symbol_id, Compiler* compiler)
 {
-    node* var_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-    if(!var_node) panic(ERROR_MEMORY_ALLOCATION, "Variable node allocation failed", compiler);
-    var_node->type = NODE_EXPRESSION;
-    var_node->expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-    if(!var_node->expr) panic(ERROR_MEMORY_ALLOCATION, "Variable node allocation failed", compiler);
-    var_node->expr->variable.length = length;
-    var_node->expr->variable.name = var_name;
-    var_node->expr->type = EXPR_IDENTIFIER;
-    var_node->expr->variable.hash = hash_function(var_name, length);
-    
     // Look up the variable in the symbol table
-    symbol_node* found_symbol = find_variable(compiler, var_node->expr->variable.hash, var_name, length);
+    symbol_node* found_symbol = find_variable(compiler, symbol_id);
     
     if (!found_symbol) {
         panic(ERROR_UNDEFINED_VARIABLE, "Variable not found while creating variable node", compiler);
     }
 
-
-
-
-    var_node->expr->variable.node_in_table = found_symbol;
-    
-    var_node->expr->variable.data_type = found_symbol->data_type;
-
-    var_node->expr->result_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    if (!var_node->expr->result_type) {
-        panic(ERROR_MEMORY_ALLOCATION, "Variable expression result_type allocation failed", compiler);
-    }
-    var_node->expr->result_type = found_symbol->data_type;
-    
-    
+    expr_id var_node = new_expression(compiler, EXPR_IDENTIFIER);
+    expression* var = ast_expression(compiler->ast, var_node);
+    var->variable.length = length;
+    var->variable.name = var_name;
+    var->variable.symbol_id = symbol_id;
+    var->variable.node_in_table = found_symbol;
+    var->result_type = found_symbol->data_type;
 
     return var_node;
 }
 
-node* create_array_index_node(expression* array, expression* index, Compiler* compiler) {
-    node* array_index_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-    if(!array_index_node) return NULL;
-    array_index_node->type = NODE_EXPRESSION;
-    array_index_node->expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-    if(!array_index_node->expr) return NULL;
-    array_index_node->expr->type = EXPR_ARR_INDEX;
-    array_index_node->expr->array_index.index = index;
-
-    
+expr_id create_array_index_node(expr_id array_node, expr_id index, Compiler* compiler) {
+    expression* array = ast_expression(compiler->ast, array_node);
+    data_type* result_type = NULL;
 
     if (array->type == EXPR_IDENTIFIER)
     {
@@ -360,23 +292,26 @@ node* create_array_index_node(expression* array, expression* index, Compiler* co
         panic(ERROR_RUNTIME, "Trying to index to a non-array expression", compiler);
         }
 
-        array_index_node->expr->array_index.array = array;
         if (array->result_type->data_type_family == FAMILY_POINTER) {
-            array_index_node->expr->result_type = array->result_type->pointer_type.base_type;
+            result_type = array->result_type->pointer_type.base_type;
         } else {
-            array_index_node->expr->result_type = array->result_type->array_type.array_of;
+            result_type = array->result_type->array_type.array_of;
         }
     }
     else if (array->type == EXPR_ARR_INDEX)
     {
-        array_index_node->expr->array_index.array = array;
-        array_index_node->expr->result_type = array->result_type->array_type.array_of;
+        result_type = array->result_type->array_type.array_of;
     }
     else {
         panic(ERROR_TYPE_MISMATCH, "Cannot index into a non-array expression",compiler);
         exit(1);
     }
 
+    expr_id array_index_node = new_expression(compiler, EXPR_ARR_INDEX);
+    expression* array_index = ast_expression(compiler->ast, array_index_node);
+    array_index->array_index.array = array_node;
+    array_index->array_index.index = index;
+    array_index->result_type = result_type;
     return array_index_node;
 }
 
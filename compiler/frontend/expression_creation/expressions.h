@@ -5,15 +5,15 @@
 #include "utilities/utils.h"
 
 
-node* create_number_node(int value, Compiler* compiler);
-node* create_variable_node_dec(char* var_name, size_t length, variable_storage_type storage_type, normal_register reg_location, data_type* data_type, Compiler* compiler);
-node* create_unary_node(TokenType op, node* operand, Compiler* compiler);
-node* create_bin_node(node* left, TokenType op, Parser* parser, bool constant_foldable, Compiler* compiler);
-node* create_func_call_node(char* func_name, size_t name_length, expression* arguments, size_t param_count, Compiler* compiler);
-node* create_variable_node(char* var_name, size_t length, Compiler* compiler);
-node* create_address_node(node* operand, Compiler* compiler);
-node* create_deref_node(node* operand, Compiler* compiler);
-node* create_array_index_node(expression* array, expression* index, Compiler* compiler);
+expr_id create_number_node(int value, Compiler* compiler);
+symbol_node* create_variable_node_dec(char* var_name, size_t length, uint32_t symbol_id, variable_storage_type storage_type, normal_register reg_location, data_type* data_type, Compiler* compiler);
+expr_id create_unary_node(TokenType op, expr_id operand, Compiler* compiler);
+expr_id create_bin_node(expr_id left, TokenType op, Parser* parser, bool constant_foldable, Compiler* compiler);
+expr_id create_func_call_node(char* func_name, size_t name_length, uint32_t symbol_id, uint32_t arguments, size_t param_count, Compiler* compiler);
+expr_id create_variable_node(char* var_name, size_t length, uint32_t symbol_id, Compiler* compiler);
+expr_id create_address_node(expr_id operand, Compiler* compiler);
+expr_id create_deref_node(expr_id operand, Compiler* compiler);
+expr_id create_array_index_node(expr_id array, expr_id index, Compiler* compiler);
 
 void evaluate_expression_x86_64(expression* expr, Compiler* compiler, FILE* output);
 
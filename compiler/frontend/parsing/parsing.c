@@ -1,13 +1,18 @@
 #include "utilities/utils.h"
 #include "arena/arena.h"
+#include "ast/ast.h"
 #include "error_handler/error_handler.h"
 #include "frontend/parsing/parsing.h"
 #include "symbol_table/symbol_table.h"
+#include "symbol_table/type_table.h"
 #include "frontend/expression_creation/expressions.h"
+#include "frontend/tokenization/tokenize.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 
 Parser *make_parser(Compiler *compiler)
 {
@@ -19,367 +24,204 @@ Parser *make_parser(Compiler *compiler)
         panic(ERROR_MEMORY_ALLOCATION, "Parser allocation failed", compiler);
     }
 
-    parser->tokens = (token *)compiler->token_arena->data;
+    parser->tokens = NULL;
     parser->current = 0;
     parser->current_line = 1;
     return parser;
 }
 
-token *peek(Parser *parser, size_t offset)
+// false past TOK_EOF, a streaming token_stream lexes up to index first
+static inline bool load_token(Parser *parser, size_t index)
 {
-    if (parser->current + offset >= parser->token_count)
+    if (index < parser->tokens->count) return true;
+    return parser->tokens->window && fill_token_window(parser->tokens, index, parser->current);
+}
+
+token peek(Parser *parser, size_t offset)
+{
+    if (!load_token(parser, parser->current + offset))
     {
         fprintf(stderr, "peek surpassed tokens\n");
-        return NULL;
+        return (token){ .type = TOK_NONE };
     }
-    return &parser->tokens[parser->current + offset];
+    return token_at(parser->tokens, parser->current + offset);
 }
 
-token *advance(Parser *parser)
+// look-ahead only needs the type, which is a single byte in the token stream
+TokenType peek_type(Parser *parser, size_t offset)
 {
-    if (parser->current >= parser->token_count)
+    if (!load_token(parser, parser->current + offset))
     {
-        return NULL;
+        fprintf(stderr, "peek surpassed tokens\n");
+        return TOK_NONE;
     }
-    return &parser->tokens[parser->current++];
+    return (TokenType)parser->tokens->types[token_slot(parser->tokens, parser->current + offset)];
+}
+
+// line and column of the token the parser is at, for diagnostics
+source_position parser_position(Parser *parser)
+{
+    // a streaming parser can fail while its first token is still being lexed
+    if (parser->tokens->count == 0) return token_position(parser->tokens, 0);
+    size_t index = parser->current < parser->tokens->count ? parser->current : parser->tokens->count - 1;
+    return token_position(parser->tokens, token_offset(parser->tokens, index));
+}
+
+token advance(Parser *parser)
+{
+    if (!load_token(parser, parser->current))
+    {
+        return (token){ .type = TOK_NONE };
+    }
+    return token_at(parser->tokens, parser->current++);
+}
+
+bool parser_at_end(Parser *parser)
+{
+    TokenType type = peek_type(parser, 0);
+    return type == TOK_EOF || type == TOK_NONE;
+}
+
+// back to the first token for another pass over the program
+void rewind_parser(Parser *parser)
+{
+    parser->current = 0;
+    rewind_token_stream(parser->tokens);
 }
 
 bool match(Parser *parser, TokenType type)
 {
-    token *current_token = peek(parser, 0);
-    return current_token && current_token->type == type;
+    return peek_type(parser, 0) == type;
 }
 
-data_type* create_data_type_from_token(Data_type type, Compiler *compiler)
+// lists are parsed in one pass, the ids of their elements wait on the parse stack until the closing token
+static void push_parsed(Compiler *compiler, uint32_t element)
+{
+    parse_stack *stack = compiler->parse_stack;
+    if (stack->current_size == stack->capacity) {
+        stack->storage = realloc(stack->storage, stack->capacity * 2 * sizeof(uint32_t));
+        stack->capacity *= 2;
+    }
+    if (!stack->storage) panic(ERROR_MEMORY_ALLOCATION, "Lists nested too deep for your memory", compiler);
+    stack->storage[stack->current_size++] = element;
+}
+
+// moves the ids pushed since mark into the AST's id lists, returns where they start there
+static uint32_t pop_list(Compiler *compiler, size_t mark)
 {
-    data_type* result = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    switch (type)
+    parse_stack *stack = compiler->parse_stack;
+    uint32_t start = new_id_list(compiler, &stack->storage[mark], stack->current_size - mark);
+    stack->current_size = mark;
+    return start;
+}
+
+// copies the expressions pushed since mark into one arena array, for lists that have to outlive the AST
+static expression *pop_expressions(Compiler *compiler, Arena *arena, size_t mark)
+{
+    parse_stack *stack = compiler->parse_stack;
+    size_t count = stack->current_size - mark;
+    expression *expressions = arena_alloc(arena, sizeof(expression) * count, compiler);
+    if (!expressions) panic(ERROR_MEMORY_ALLOCATION, "Expression list allocation failed", compiler);
+    for (size_t i = 0; i < count; i++)
     {
-    case DATA_TYPE_INT:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_INT;
-        result->general_data_type = DATA_TYPE_INT;
-        break;
-    
-    case DATA_TYPE_LONG:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_LONG;
-        result->general_data_type = DATA_TYPE_LONG;
-        break;
+        expressions[i] = *ast_expression(compiler->ast, stack->storage[mark + i]);
+    }
+    stack->current_size = mark;
+    return expressions;
+}
 
-    default:
+// an expression used as a statement, like a call on its own
+static stmt_id parse_expression_statement(Compiler *compiler, Parser *parser)
+{
+    expr_id value = parse_expression(parser, PREC_NONE, true, compiler);
+    stmt_id expression_node = new_statement(compiler, STMT_EXPRESSION);
+    ast_statement(compiler->ast, expression_node)->stmnt_expression.value = value;
+    return expression_node;
+}
+
+data_type* create_data_type_from_token(Data_type type, Compiler *compiler)
+{
+    if (type != DATA_TYPE_INT && type != DATA_TYPE_LONG)
+    {
         panic(ERROR_SYNTAX, "Unexpected data type token", compiler);
     }
-    return result;
+    return intern_flat_type(type, compiler);
 }
 
 data_type* parse_data_type_recursive(Parser *parser, Compiler *compiler) {
    
 
-    token *current_token = peek(parser, 0);
-    if (!current_token)
+    token current_token = peek(parser, 0);
+    if (current_token.type == TOK_NONE)
     {
         panic(ERROR_SYNTAX, "Unexpected end of input while parsing data type", compiler);
     }
 
-    data_type* result = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    
-    switch (current_token->type)
+    size_t array_length = 0;
+    switch (current_token.type)
     {
     case TOK_INT:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_INT;
-        result->general_data_type = DATA_TYPE_INT;
         advance(parser); // consume the data type token
-        break;
+        return intern_flat_type(DATA_TYPE_INT, compiler);
     
     case TOK_LONG:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_LONG;
-        result->general_data_type = DATA_TYPE_LONG;
         advance(parser); // consume the data type token
-        break;
+        return intern_flat_type(DATA_TYPE_LONG, compiler);
 
     case TOK_FLOAT:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_FLOAT;
-        result->general_data_type = DATA_TYPE_FLOAT;
         advance(parser); // consume the data type token
-        break;
+        return intern_flat_type(DATA_TYPE_FLOAT, compiler);
     
     case TOK_MUL: // for pointer ( *int)
         advance(parser); // consume *
-        result->data_type_family = FAMILY_POINTER;
-        result->pointer_type.base_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-        result->pointer_type.base_type->data_type_family = FAMILY_FLAT;
-        result->general_data_type = DATA_TYPE_POINTER;
-        result->pointer_type.base_type = parse_data_type_recursive(parser, compiler);
-        break;
+        return intern_pointer_type(parse_data_type_recursive(parser, compiler), compiler);
 
     case TOK_LBRACKET: // for arrays
         advance(parser); // consume [
-        if (peek(parser, 0)->type != TOK_RBRACKET && peek(parser, 0)->type != TOK_NUMBER) {
+        if (peek_type(parser, 0) != TOK_RBRACKET && peek_type(parser, 0) != TOK_NUMBER) {
             panic(ERROR_SYNTAX, "Expected ']' or a number after '[' in array type declaration", compiler);
         }
-        if (peek(parser, 0)->type == TOK_NUMBER) {
-            result->array_type.array_length = peek(parser, 0)->int_value;
+        if (peek_type(parser, 0) == TOK_NUMBER) {
+            array_length = peek(parser, 0).int_value;
             advance(parser); // consume the number
-            if (peek(parser, 0)->type != TOK_RBRACKET) {
+            if (peek_type(parser, 0) != TOK_RBRACKET) {
                 panic(ERROR_SYNTAX, "Expected ']' after array length in array type declaration", compiler);
             }
             advance(parser); // consume ]
         }
         else {
-            result->array_type.array_length = 0; // for unsized arrays
+            // unsized arrays have length 0
             advance(parser);
         }
-        result->data_type_family = FAMILY_ARRAY;
-        result->general_data_type = DATA_TYPE_ARRAY;
-        result->array_type.array_of = parse_data_type_recursive(parser, compiler);
-        break;
+        return intern_array_type(parse_data_type_recursive(parser, compiler), array_length, compiler);
         
     default:
         panic(ERROR_SYNTAX, "Expected a data type", compiler);
     }
-    return result;
+    return NULL;
 }
 
 data_type* parse_data_type(Parser *parser, Compiler *compiler)
 {
     
     
-    if (!peek(parser, 0))
+    if (peek_type(parser, 0) == TOK_NONE)
     {
         panic(ERROR_SYNTAX, "Unexpected end of input while parsing data type", compiler);
     }
-    if(peek(parser, 0)->type != TOK_COLON) {
+    if(peek_type(parser, 0) != TOK_COLON) {
         panic(ERROR_INTERNAL, "Expected a colon ':' after variable name", compiler);
     }
     advance(parser); // consume ':'
-    token *current_token = peek(parser, 0);
-    if (!current_token)
-    {
-        panic(ERROR_SYNTAX, "Unexpected end of input while parsing data type", compiler);
-    }
-
-    data_type* result = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    
-    switch (current_token->type)
-    {
-    case TOK_INT:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_INT;
-        result->general_data_type = DATA_TYPE_INT;
-        advance(parser); // consume the data type token
-        break;
-    
-    case TOK_LONG:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_LONG;
-        result->general_data_type = DATA_TYPE_LONG;
-        advance(parser); // consume the data type token
-        break;
-
-    case TOK_FLOAT:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_FLOAT;
-        result->general_data_type = DATA_TYPE_FLOAT;
-        advance(parser); // consume the data type token
-        break;
-
-    case TOK_MUL: // for pointer ( *int)
-        advance(parser); // consume *
-        result->data_type_family = FAMILY_POINTER;
-        result->pointer_type.base_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-        result->pointer_type.base_type->data_type_family = FAMILY_FLAT;
-        result->general_data_type = DATA_TYPE_POINTER;
-        result->pointer_type.base_type = parse_data_type_recursive(parser, compiler);
-        break;
-    case TOK_LBRACKET: // for arrays
-        advance(parser); // consume [
-        if (peek(parser, 0)->type != TOK_RBRACKET && peek(parser, 0)->type != TOK_NUMBER) {
-            panic(ERROR_SYNTAX, "Expected ']' or a number after '[' in array type declaration", compiler);
-        }
-        if (peek(parser, 0)->type == TOK_NUMBER) {
-            result->array_type.array_length = peek(parser, 0)->int_value;
-            advance(parser); // consume the number
-            if (peek(parser, 0)->type != TOK_RBRACKET) {
-                panic(ERROR_SYNTAX, "Expected ']' after array length in array type declaration", compiler);
-            }
-            advance(parser); // consume ]
-        }
-        else {
-            result->array_type.array_length = 0; // for unsized arrays
-            advance(parser);
-        }
-        result->data_type_family = FAMILY_ARRAY;
-        result->general_data_type = DATA_TYPE_ARRAY;
-        result->array_type.array_of = parse_data_type_recursive(parser, compiler);
-        break;
-
-    default:
-        panic(ERROR_SYNTAX, "Expected a data type", compiler);
-    }
-    return result;
+    return parse_data_type_recursive(parser, compiler);
 }
 
 
 
-data_type* parse_param_data_type_recursive(Parser *parser, Compiler *compiler, size_t* param_offset)
-{
-   token *current_token = peek(parser, *param_offset);
-    if (!current_token)
-    {
-        panic(ERROR_SYNTAX, "Unexpected end of input while parsing data type", compiler);
-    }
-
-    data_type* result = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-    
-    switch (current_token->type)
-    {
-    case TOK_INT:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_INT;
-        result->general_data_type = DATA_TYPE_INT;
-        (*param_offset)++; // consume the data type token
-        break;
-    
-    case TOK_LONG:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_LONG;
-        result->general_data_type = DATA_TYPE_LONG;
-        (*param_offset)++; // consume the data type token
-        break;
-
-    case TOK_FLOAT:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_FLOAT;
-        result->general_data_type = DATA_TYPE_FLOAT;
-        (*param_offset)++; // consume the data type token
-        break;
-    
-    case TOK_MUL: // for pointer ( *int)
-        (*param_offset)++; // consume *
-        result->data_type_family = FAMILY_POINTER;
-        result->pointer_type.base_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-        result->pointer_type.base_type->data_type_family = FAMILY_FLAT;
-        result->general_data_type = DATA_TYPE_POINTER;
-        result->pointer_type.base_type = parse_param_data_type_recursive(parser, compiler, param_offset);
-        break;
-    
-    case TOK_LBRACKET: // for arrays
-        (*param_offset)++; // consume [
-        if (peek(parser, *param_offset)->type != TOK_RBRACKET && peek(parser, *param_offset)->type != TOK_NUMBER) {
-            panic(ERROR_SYNTAX, "Expected ']' or a number after '[' in array type declaration", compiler);
-        }
-        if (peek(parser, *param_offset)->type == TOK_NUMBER) {
-            result->array_type.array_length = peek(parser, *param_offset)->int_value;
-            (*param_offset)++; // consume the number
-            if (peek(parser, *param_offset)->type != TOK_RBRACKET) {
-                panic(ERROR_SYNTAX, "Expected ']' after array length in array type declaration", compiler);
-            }
-            (*param_offset)++; // consume ]
-        }
-        else {
-            result->array_type.array_length = 0; // for unsized arrays
-            (*param_offset)++;
-        }
-        result->data_type_family = FAMILY_ARRAY;
-        result->general_data_type = DATA_TYPE_ARRAY;
-        result->array_type.array_of = parse_param_data_type_recursive(parser, compiler, param_offset);
-        break;
-    
-        
-    default:
-        panic(ERROR_SYNTAX, "Expected a data type", compiler);
-    }
-    return result;
-}
-
-
-data_type* parse_param_data_type(Parser *parser, Compiler *compiler, size_t* param_offset)
+stmt_id parse_statement(Compiler *compiler, Parser *parser)
 {
-    if (!peek(parser, *param_offset))
-    {
-        panic(ERROR_SYNTAX, "Unexpected end of input while parsing data type", compiler);
-    }
-    if(peek(parser, *param_offset)->type != TOK_COLON) {
-        panic(ERROR_SYNTAX, "Expected a colon ':' after variable name", compiler);
-    }
-    (*param_offset)++; // consume ':'
-    token *current_token = peek(parser, *param_offset);
-    if (!current_token)
-    {
-        panic(ERROR_SYNTAX, "Unexpected end of input while parsing data type", compiler);
-    }
-
-    data_type* result = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
     
-    switch (current_token->type)
-    {
-    case TOK_INT:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_INT;
-        result->general_data_type = DATA_TYPE_INT;
-        (*param_offset)++; // consume the data type token
-        break;
-    
-    case TOK_LONG:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_LONG;
-        result->general_data_type = DATA_TYPE_LONG;
-        (*param_offset)++; // consume the data type token
-        break;
-    
-    case TOK_MUL: // for pointer ( *int)
-        (*param_offset)++; // consume *
-        result->data_type_family = FAMILY_POINTER;
-        result->pointer_type.base_type = arena_alloc(compiler->expressions_arena, sizeof(data_type), compiler);
-        result->pointer_type.base_type->data_type_family = FAMILY_FLAT;
-        result->general_data_type = DATA_TYPE_POINTER;
-        result->pointer_type.base_type = parse_param_data_type_recursive(parser, compiler, param_offset);
-        break;
-
-    case TOK_FLOAT:
-        result->data_type_family = FAMILY_FLAT;
-        result->flat_type.flat_data_type = TOK_FLOAT;
-        result->general_data_type = DATA_TYPE_FLOAT;
-        (*param_offset)++; // consume the data type token
-        break;
-
-    case TOK_LBRACKET: // for arrays
-        (*param_offset)++; // consume [
-        if (peek(parser, *param_offset)->type != TOK_RBRACKET && peek(parser, *param_offset)->type != TOK_NUMBER) {
-            panic(ERROR_SYNTAX, "Expected ']' or a number after '[' in array type declaration", compiler);
-        }
-        if (peek(parser, *param_offset)->type == TOK_NUMBER) {
-            result->array_type.array_length = peek(parser, *param_offset)->int_value;
-            (*param_offset)++; // consume the number
-            if (peek(parser, *param_offset)->type != TOK_RBRACKET) {
-                panic(ERROR_SYNTAX, "Expected ']' after array length in array type declaration", compiler);
-            }
-            (*param_offset)++; // consume ]
-        }
-        else {
-            result->array_type.array_length = 0; // for unsized arrays
-            (*param_offset)++;
-        }
-        result->data_type_family = FAMILY_ARRAY;
-        result->general_data_type = DATA_TYPE_ARRAY;
-        result->array_type.array_of = parse_param_data_type_recursive(parser, compiler, param_offset);
-        break;
-        
-    default:
-        panic(ERROR_SYNTAX, "Expected a data type", compiler);
-    }
-    return result;
-}
-
-
-node* parse_statement(Compiler *compiler, Parser *parser)
-{
-    
-    switch (peek(parser, 0)->type)
+    switch (peek_type(parser, 0))
     {
     case TOK_EXIT:
         return parse_exit_node(compiler, parser);
@@ -404,150 +246,122 @@ node* parse_statement(Compiler *compiler, Parser *parser)
         break;
     case TOK_IDENTIFIER:
         // x = 5;
-        if (!peek(parser, 1))
+        if (peek_type(parser, 1) == TOK_NONE)
             break;
-        if (peek(parser, 1)->type == TOK_EQUAL)
+        if (peek_type(parser, 1) == TOK_EQUAL)
         {
             // assignment
             return parse_assignment_node(compiler, parser);
         }
-        if (peek(parser, 1)->type == TOK_LPAREN)
+        if (peek_type(parser, 1) == TOK_LPAREN)
         {
             // call
-            return (parse_expression(parser, PREC_NONE, true, compiler));
+            return parse_expression_statement(compiler, parser);
         }
         break;
     default:
-        return (parse_expression(parser, PREC_NONE, true, compiler));
+        return parse_expression_statement(compiler, parser);
     }
-    return NULL;
+    return 0;
 }
 
-node *parse_exit_node(Compiler *compiler, Parser *parser)
+stmt_id parse_exit_node(Compiler *compiler, Parser *parser)
 {
-    node *exit_node = (node *)arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!exit_node)
-        panic(ERROR_MEMORY_ALLOCATION, "Exit node allocation failed", compiler);
-
-    exit_node->type = NODE_STATEMENT;
     advance(parser); // consume 'exit'
 
-    exit_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    exit_node->stmnt->type = STMT_EXIT;
-    exit_node->stmnt->stmnt_exit.exit_code = parse_expression(parser, presedences[TOK_EXIT], true, compiler)->expr;
-    exit_node->stmnt->stmnt_exit.exit_code->result_type = create_data_type_from_token(DATA_TYPE_INT, compiler);
-    if (peek(parser, 0)->type != TOK_SEMICOLON)
+    expr_id exit_code = parse_expression(parser, presedences[TOK_EXIT], true, compiler);
+    data_type *exit_type = create_data_type_from_token(DATA_TYPE_INT, compiler);
+    ast_expression(compiler->ast, exit_code)->result_type = exit_type;
+    if (peek_type(parser, 0) != TOK_SEMICOLON)
         panic(ERROR_SYNTAX, "Expected semicolumn ';'", compiler);
     advance(parser); // consume ;
 
+    stmt_id exit_node = new_statement(compiler, STMT_EXIT);
+    ast_statement(compiler->ast, exit_node)->stmnt_exit.exit_code = exit_code;
     return exit_node;
 }
 
-node* parse_break_node(Compiler* compiler, Parser* parser) {
-    node *break_node = (node *)arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!break_node)
-        panic(ERROR_MEMORY_ALLOCATION, "Return node allocation failed", compiler);
-
-    break_node->type = NODE_STATEMENT;
+stmt_id parse_break_node(Compiler* compiler, Parser* parser) {
     advance(parser); // consume 'break'
-    
-    break_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    break_node->stmnt->type = STMT_BREAK;
 
-    if (advance(parser)->type != TOK_SEMICOLON) panic(ERROR_SYNTAX, "expected semicolomn after keyword 'break'", compiler);
-    return break_node;
+    if (advance(parser).type != TOK_SEMICOLON) panic(ERROR_SYNTAX, "expected semicolomn after keyword 'break'", compiler);
+    return new_statement(compiler, STMT_BREAK);
 }
 
-node* parse_return_node(Compiler *compiler, Parser *parser)
+stmt_id parse_return_node(Compiler *compiler, Parser *parser)
 {
-    node *return_node = (node *)arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!return_node)
-        panic(ERROR_MEMORY_ALLOCATION, "Return node allocation failed", compiler);
-
-    return_node->type = NODE_STATEMENT;
     advance(parser); // consume 'return'
 
-    return_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    return_node->stmnt->type = STMT_RETURN;
-
-    if (peek(parser, 0)->type == TOK_SEMICOLON)
-    {
-        return_node->stmnt->stmnt_return.value = NULL;
-    }
-    else
+    expr_id value = 0;
+    data_type *return_data_type = NULL;
+    if (peek_type(parser, 0) != TOK_SEMICOLON)
     {
-        expression *tmp = parse_expression(parser, PREC_NONE, true, compiler)->expr;
-        return_node->stmnt->stmnt_return.value = tmp;
-        return_node->stmnt->stmnt_return.return_data_type = tmp->result_type;
+        value = parse_expression(parser, PREC_NONE, true, compiler);
+        return_data_type = ast_expression(compiler->ast, value)->result_type;
     }
     advance(parser); // consume ;
+
+    stmt_id return_node = new_statement(compiler, STMT_RETURN);
+    statement *return_statement = ast_statement(compiler->ast, return_node);
+    return_statement->stmnt_return.value = value;
+    return_statement->stmnt_return.return_data_type = return_data_type;
     return return_node;
 }
 
-node *parse_let_node(Compiler *compiler, Parser *parser)
+stmt_id parse_let_node(Compiler *compiler, Parser *parser)
 {
-   
-    node *let_node = (node *)arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!let_node)
-        panic(ERROR_MEMORY_ALLOCATION, "Exit node allocation failed", compiler);
-
-    let_node->type = NODE_STATEMENT;
     advance(parser); // consume let
-    let_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    if (!let_node->stmnt) panic(ERROR_MEMORY_ALLOCATION, "Exit node statement allocation failed", compiler);
-
-    let_node->stmnt->type = STMT_LET;
-    token *identifier_token = peek(parser, 0);
-
-    let_node->stmnt->stmnt_let.name = identifier_token->str_value.starting_value;
-    let_node->stmnt->stmnt_let.name_length = identifier_token->str_value.length;
-    
-    let_node->stmnt->stmnt_let.hash = hash_function(peek(parser, 0)->str_value.starting_value, peek(parser, 0)->str_value.length);
+    token identifier_token = peek(parser, 0);
     advance(parser); // consume identifier
     
     
     data_type *data_type_token = parse_data_type(parser, compiler); // consume data type
    
 
-    create_variable_node_dec(identifier_token->str_value.starting_value, identifier_token->str_value.length, STORE_IN_STACK, 0, data_type_token, compiler);
+    symbol_node *variable = create_variable_node_dec(identifier_token.str_value.starting_value, identifier_token.str_value.length, identifier_token.symbol_id, STORE_IN_STACK, 0, data_type_token, compiler);
     
-    token *t = advance(parser); // consume equal
+    token t = advance(parser); // consume equal
 
-    if (t->type != TOK_EQUAL)
+    if (t.type != TOK_EQUAL)
     {
         panic(ERROR_SYNTAX, "usage: let var: type = value;", compiler);
     }
 
-    let_node->stmnt->stmnt_let.value = parse_expression(parser, presedences[TOK_EQUAL], true, compiler)->expr;
+    expr_id value = parse_expression(parser, presedences[TOK_EQUAL], true, compiler);
   
     advance(parser); // consume ; 
+
+    stmt_id let_node = new_statement(compiler, STMT_LET);
+    statement *let = ast_statement(compiler->ast, let_node);
+    let->stmnt_let.variable = variable;
+    let->stmnt_let.symbol_id = identifier_token.symbol_id;
+    let->stmnt_let.value = value;
     return let_node;
 }
 
-node *parse_assignment_node(Compiler *compiler, Parser *parser)
+stmt_id parse_assignment_node(Compiler *compiler, Parser *parser)
 {
-    node *assignment_node = (node *)arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!assignment_node)
-        panic(ERROR_MEMORY_ALLOCATION, "Assignment node allocation failed", compiler);
-
-    assignment_node->type = NODE_STATEMENT;
-    token *identifier_token = peek(parser, 0);
-    size_t hash = hash_function(identifier_token->str_value.starting_value, identifier_token->str_value.length);
+    token identifier_token = peek(parser, 0);
 
     advance(parser); // consume identifier
     advance(parser); // consume equal
 
-    assignment_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    assignment_node->stmnt->type = STMT_ASSIGNMENT;
+    // the scopes are only on the stack while parsing, the statement keeps the variable it assigns
+    symbol_node *variable = find_variable(compiler, identifier_token.symbol_id);
+    if (!variable)
+        panic(ERROR_UNDEFINED_VARIABLE, "Variable not found while assigning value", compiler);
 
-    assignment_node->stmnt->stmnt_assign.hash = hash;
-    assignment_node->stmnt->stmnt_assign.value = parse_expression(parser, presedences[TOK_EQUAL], true, compiler)->expr;
-    assignment_node->stmnt->stmnt_assign.name = identifier_token->str_value.starting_value;
-    assignment_node->stmnt->stmnt_assign.name_length = identifier_token->str_value.length;
+    expr_id value = parse_expression(parser, presedences[TOK_EQUAL], true, compiler);
 
-    if (peek(parser, 0)->type != TOK_SEMICOLON)
+    if (peek_type(parser, 0) != TOK_SEMICOLON)
         panic(ERROR_SYNTAX, "Expected semicolumn ';'", compiler);
     advance(parser); // consume ;
+
+    stmt_id assignment_node = new_statement(compiler, STMT_ASSIGNMENT);
+    statement *assignment = ast_statement(compiler->ast, assignment_node);
+    assignment->stmnt_assign.symbol_id = identifier_token.symbol_id;
+    assignment->stmnt_assign.value = value;
+    assignment->stmnt_assign.variable = variable;
     return assignment_node;
 }
 
@@ -563,61 +377,49 @@ node *parse_assignment_node(Compiler *compiler, Parser *parser)
 //  /* code */
 // }
 
-node *parse_while_node(Compiler *compiler, Parser *parser)
+stmt_id parse_while_node(Compiler *compiler, Parser *parser)
 {
-    node *while_node = (node *)arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!while_node)
-        panic(ERROR_MEMORY_ALLOCATION, "Exit node allocation failed", compiler);
-    while_node->type = NODE_STATEMENT;
-
     advance(parser); // consume while
 
-    while_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    if (!while_node->stmnt)
-        panic(ERROR_MEMORY_ALLOCATION, "Exit node statement allocation failed", compiler);
-    while_node->stmnt->type = STMT_WHILE;
-
-    if (advance(parser)->type != TOK_LPAREN)
+    if (advance(parser).type != TOK_LPAREN)
         panic(ERROR_SYNTAX, "Expected '(' after 'if'", compiler); // consume (
-    while_node->stmnt->stmnt_while.condition = parse_expression(parser, PREC_NONE, true, compiler)->expr;
-    if (peek(parser, 0)->type != TOK_RPAREN)
+    expr_id condition = parse_expression(parser, PREC_NONE, true, compiler);
+    if (peek_type(parser, 0) != TOK_RPAREN)
     {
         panic(ERROR_SYNTAX, "Didn't close parenthesis at the if/ else if statement", compiler);
     }
     advance(parser); // consume )
     // we are now at {, pass as code block
-    while_node->stmnt->stmnt_while.body = parse_code_block(compiler, parser, false, NULL, 0, 0)->stmnt; // now finished }
-    while_node->stmnt->stmnt_while.counter = compiler->counters->while_statements;
+    stmt_id body = parse_code_block(compiler, parser, false, NULL, 0, 0); // now finished }
+
+    stmt_id while_node = new_statement(compiler, STMT_WHILE);
+    statement *while_statement = ast_statement(compiler->ast, while_node);
+    while_statement->stmnt_while.condition = condition;
+    while_statement->stmnt_while.body = body;
+    while_statement->stmnt_while.counter = compiler->counters->while_statements;
     compiler->counters->while_statements++;
     return while_node;
 }
 
-node *parse_if_node(Compiler *compiler, Parser *parser)
+stmt_id parse_if_node(Compiler *compiler, Parser *parser)
 {
-    node *if_node = (node *)arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!if_node) panic(ERROR_MEMORY_ALLOCATION, "Exit node allocation failed", compiler);
-
-    if_node->type = NODE_STATEMENT;
     advance(parser); // consume if
-    if_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    if (!if_node->stmnt) panic(ERROR_MEMORY_ALLOCATION, "Exit node statement allocation failed", compiler);
-    if_node->stmnt->type = STMT_IF;
 
-    if (advance(parser)->type != TOK_LPAREN) panic(ERROR_SYNTAX, "Expected '(' after 'if'", compiler); // consume (
+    if (advance(parser).type != TOK_LPAREN) panic(ERROR_SYNTAX, "Expected '(' after 'if'", compiler); // consume (
 
-    if_node->stmnt->stmnt_if.condition = parse_expression(parser, PREC_NONE, true, compiler)->expr;
-    if (peek(parser, 0)->type != TOK_RPAREN) panic(ERROR_SYNTAX, "Didn't close parenthesis at the if/ else if statement", compiler);
+    expr_id condition = parse_expression(parser, PREC_NONE, true, compiler);
+    if (peek_type(parser, 0) != TOK_RPAREN) panic(ERROR_SYNTAX, "Didn't close parenthesis at the if/ else if statement", compiler);
     advance(parser);                                                                              // consume )
 
 
-    size_t* has_return = malloc(sizeof(size_t));
-    *has_return = 0;
+    size_t has_return = 0;
 
-    if (peek(parser, 0)->type == TOK_LBRACE){
-    if_node->stmnt->stmnt_if.then = parse_code_block2(compiler, parser, NULL, 0, peek_symbol_stack(compiler)->scope_data_type, has_return)->stmnt; // now finished } // if it had a return value, then has_return will be 1
+    stmt_id then;
+    if (peek_type(parser, 0) == TOK_LBRACE){
+    then = parse_code_block2(compiler, parser, NULL, 0, peek_symbol_stack(compiler)->scope_data_type, &has_return); // now finished } // if it had a return value, then has_return will be 1
     }
     else {
-        if_node->stmnt->stmnt_if.then = parse_statement(compiler, parser)->stmnt;
+        then = parse_statement(compiler, parser);
     }
 
     // if (the if statement has a 100% return) {
@@ -628,9 +430,9 @@ node *parse_if_node(Compiler *compiler, Parser *parser)
     // }
 
 
-    if_node->stmnt->stmnt_if.or_else = NULL;
-    if (peek(parser, 0)->type == TOK_ELSE) {
-        if_node->stmnt->stmnt_if.or_else = parse_else_node(compiler, parser, has_return)->stmnt; // if the else or elsif block(s) had a return statement, it would be +1
+    stmt_id or_else = 0;
+    if (peek_type(parser, 0) == TOK_ELSE) {
+        or_else = parse_else_node(compiler, parser, &has_return); // if the else or elsif block(s) had a return statement, it would be +1
         
     }
 
@@ -641,35 +443,33 @@ node *parse_if_node(Compiler *compiler, Parser *parser)
     //     has_return = 1 or 0
     // }
 
-    if_node->stmnt->stmnt_if.return_percent = *has_return;
-    free(has_return);
+    stmt_id if_node = new_statement(compiler, STMT_IF);
+    statement *if_statement = ast_statement(compiler->ast, if_node);
+    if_statement->stmnt_if.condition = condition;
+    if_statement->stmnt_if.then = then;
+    if_statement->stmnt_if.or_else = or_else;
+    if_statement->stmnt_if.return_percent = has_return;
     
     return if_node;
 }
 
-node *parse_elseif_node(Compiler *compiler, Parser *parser, size_t* has_return)
+stmt_id parse_elseif_node(Compiler *compiler, Parser *parser, size_t* has_return)
 {
-    node *if_node = (node *)arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!if_node) panic(ERROR_MEMORY_ALLOCATION, "Exit node allocation failed", compiler);
-
-    if_node->type = NODE_STATEMENT;
     advance(parser); // consume if
-    if_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    if (!if_node->stmnt) panic(ERROR_MEMORY_ALLOCATION, "Exit node statement allocation failed", compiler);
-    if_node->stmnt->type = STMT_IF;
 
-    if (advance(parser)->type != TOK_LPAREN) panic(ERROR_SYNTAX, "Expected '(' after 'if'", compiler); // consume (
+    if (advance(parser).type != TOK_LPAREN) panic(ERROR_SYNTAX, "Expected '(' after 'if'", compiler); // consume (
 
-    if_node->stmnt->stmnt_if.condition = parse_expression(parser, PREC_NONE, true, compiler)->expr;
-    if (peek(parser, 0)->type != TOK_RPAREN) panic(ERROR_SYNTAX, "Didn't close parenthesis at the if/ else if statement", compiler);
+    expr_id condition = parse_expression(parser, PREC_NONE, true, compiler);
+    if (peek_type(parser, 0) != TOK_RPAREN) panic(ERROR_SYNTAX, "Didn't close parenthesis at the if/ else if statement", compiler);
     advance(parser);                                                                              // consume )
 
 
-    if (peek(parser, 0)->type == TOK_LBRACE){
-    if_node->stmnt->stmnt_if.then = parse_code_block2(compiler, parser, NULL, 0, peek_symbol_stack(compiler)->scope_data_type, has_return)->stmnt; // now finished } // if it had a return value, then has_return will be 1
+    stmt_id then;
+    if (peek_type(parser, 0) == TOK_LBRACE){
+    then = parse_code_block2(compiler, parser, NULL, 0, peek_symbol_stack(compiler)->scope_data_type, has_return); // now finished } // if it had a return value, then has_return will be 1
     }
     else {
-        if_node->stmnt->stmnt_if.then = parse_statement(compiler, parser)->stmnt;
+        then = parse_statement(compiler, parser);
     }
 
     // if (the if statement has a 100% return) {
@@ -680,9 +480,9 @@ node *parse_elseif_node(Compiler *compiler, Parser *parser, size_t* has_return)
     // }
 
 
-    if_node->stmnt->stmnt_if.or_else = NULL;
-    if (peek(parser, 0)->type == TOK_ELSE) {
-        if_node->stmnt->stmnt_if.or_else = parse_else_node(compiler, parser, has_return)->stmnt; // if the else or elsif block(s) had a return statement, it would be +1
+    stmt_id or_else = 0;
+    if (peek_type(parser, 0) == TOK_ELSE) {
+        or_else = parse_else_node(compiler, parser, has_return); // if the else or elsif block(s) had a return statement, it would be +1
         
     }
 
@@ -693,26 +493,31 @@ node *parse_elseif_node(Compiler *compiler, Parser *parser, size_t* has_return)
     //     has_return = 1 or 0
     // }
 
-    if_node->stmnt->stmnt_if.return_percent = *has_return;
+    stmt_id if_node = new_statement(compiler, STMT_IF);
+    statement *if_statement = ast_statement(compiler->ast, if_node);
+    if_statement->stmnt_if.condition = condition;
+    if_statement->stmnt_if.then = then;
+    if_statement->stmnt_if.or_else = or_else;
+    if_statement->stmnt_if.return_percent = *has_return;
     
     return if_node;
 }
 
 
 
-node *parse_else_node(Compiler *compiler, Parser *parser, size_t* has_return)
+stmt_id parse_else_node(Compiler *compiler, Parser *parser, size_t* has_return)
 {
-    if (advance(parser)->type != TOK_ELSE) panic(ERROR_SYNTAX, "expected else statement", compiler);
+    if (advance(parser).type != TOK_ELSE) panic(ERROR_SYNTAX, "expected else statement", compiler);
 
-    if (peek(parser, 0)->type == TOK_IF) // else if
+    if (peek_type(parser, 0) == TOK_IF) // else if
     {
-        node *else_if = parse_elseif_node(compiler, parser, has_return);
-        else_if->stmnt->type = STMT_IF;
+        stmt_id else_if = parse_elseif_node(compiler, parser, has_return);
+        ast_statement(compiler->ast, else_if)->type = STMT_IF;
         return else_if;
     }
-    else if (peek(parser, 0)->type == TOK_LBRACE) // else {}
+    else if (peek_type(parser, 0) == TOK_LBRACE) // else {}
     {
-        if (peek(parser, 0)->type == TOK_LBRACE){
+        if (peek_type(parser, 0) == TOK_LBRACE){
             return parse_code_block2(compiler, parser, NULL, 0, peek_symbol_stack(compiler)->scope_data_type, has_return); // now finished } // if it had a return value, then has_return will be 1
         }
         else {
@@ -722,189 +527,327 @@ node *parse_else_node(Compiler *compiler, Parser *parser, size_t* has_return)
     else
     {
         panic(ERROR_SYNTAX, "usage: else if {\n<code>\n}\nOR\nelse {\n<code>\n}\n", compiler);
-        return NULL;
+        return 0;
     }
-    return NULL;
+    return 0;
 }
 
-node* skip_function_decleration(Compiler* compiler, Parser* parser) {
+stmt_id skip_function_decleration(Compiler* compiler, Parser* parser) {
     advance(parser); // consume fn
-    token* token_name = advance(parser); // consume function name
+    token token_name = advance(parser); // consume function name
     advance(parser); // consume (
-    while (peek(parser, 0)->type != TOK_RPAREN) advance(parser); // consume parameters and return type
+    while (peek_type(parser, 0) != TOK_RPAREN) advance(parser); // consume parameters and return type
     advance(parser); // consume )
-    function_node* found_func = find_function_symbol_node(token_name->str_value.starting_value, token_name->str_value.length, hash_function(token_name->str_value.starting_value, token_name->str_value.length), compiler);
+    function_node* found_func = find_function_symbol_node(token_name.symbol_id, compiler);
     parse_data_type(parser, compiler); // consume :datatype
-    found_func->code_block = parse_code_block(compiler, parser, true, found_func->parameters, found_func->param_count, found_func->return_type)->stmnt;
+    found_func->code_block = parse_code_block(compiler, parser, true, found_func->parameters, found_func->param_count, found_func->return_type);
     
     
+    return 0;
+}
+
+// a body parsing thread's share of the functions, first to last - 1 in source order
+typedef struct
+{
+    Compiler compiler; // the main compiler with the worker's own arenas, stacks, counters and AST swapped in
+    AST ast;           // the bodies' nodes until they are merged into the program's AST
+    Parser parser;
+    counters counters;
+    symbol_table_stack symbols;
+    parse_stack stack;
+    AST *program;
+    size_t first;
+    size_t last;
+    pthread_t thread;
+    bool on_thread;
+    jmp_buf recover;   // where a panic in one of the bodies lands when the compile is recoverable
+} body_worker;
+
+// fills in where every body ends and how many while labels come before and inside it, every while token
+// becomes exactly one label in source order. false when a body does not close, a fn sits inside another
+// body or a let sits outside the functions (a body must only see the globals declared before it),
+// the serial parse then reports the error or keeps the order
+static bool find_function_bodies(token_stream *stream, AST *ast)
+{
+    size_t whiles = 0;
+    size_t i = 0;
+    for (size_t f = 0; f < ast->function_node_count; f++) {
+        function_body *body = &ast->function_bodies[f];
+        if (body->start < i || body->start >= stream->count || stream->types[body->start] != TOK_LBRACE) return false;
+        for (; i < body->start; i++) {
+            if (stream->types[i] == TOK_LET) return false;
+            if (stream->types[i] == TOK_WHILE) whiles++;
+        }
+        body->while_base = whiles;
+        size_t depth = 0;
+        for (; i < stream->count; i++) {
+            TokenType type = (TokenType)stream->types[i];
+            if (type == TOK_LBRACE) depth++;
+            else if (type == TOK_RBRACE && --depth == 0) break;
+            else if (type == TOK_WHILE) whiles++;
+            else if (type == TOK_FN) return false;
+        }
+        if (i == stream->count) return false;
+        body->end = i++;
+        body->while_count = whiles - body->while_base;
+    }
+    for (; i < stream->count; i++) {
+        if (stream->types[i] == TOK_LET) return false;
+    }
+    return true;
+}
+
+static void init_body_worker(body_worker *worker, Compiler *compiler, size_t first, size_t last)
+{
+    size_t token_count = 0;
+    for (size_t f = first; f < last; f++) {
+        token_count += compiler->ast->function_bodies[f].end - compiler->ast->function_bodies[f].start + 1;
+    }
+    worker->compiler = *compiler;
+    worker->program = compiler->ast;
+    Compiler *view = &worker->compiler;
+    view->parse_worker = true;
+
+    worker->parser = *compiler->parser;
+    view->parser = &worker->parser;
+
+    memset(&worker->counters, 0, sizeof(counters));
+    view->counters = &worker->counters;
+
+    // the bodies see the global scope like they would in a serial parse, nothing is added to it meanwhile
+    worker->symbols.capacity = 16;
+    worker->symbols.current_size = 1;
+    worker->symbols.storage = malloc(worker->symbols.capacity * sizeof(symbol_table *));
+    worker->stack.capacity = 64;
+    worker->stack.current_size = 0;
+    worker->stack.storage = malloc(worker->stack.capacity * sizeof(uint32_t));
+    if (!worker->symbols.storage || !worker->stack.storage)
+        panic(ERROR_MEMORY_ALLOCATION, "Body parser allocation failed", compiler);
+    worker->symbols.storage[0] = compiler->symbol_table_stack->storage[0];
+    init_scope_bindings(&worker->symbols, compiler->symbol_table_stack, compiler);
+    view->symbol_table_stack = &worker->symbols;
+    view->parse_stack = &worker->stack;
+    view->current_function_symbol_table = NULL;
+
+    make_parse_arenas(view, token_count);
+    init_ast(&worker->ast, token_count, compiler);
+    view->ast = &worker->ast;
+    worker->first = first;
+    worker->last = last;
+    worker->on_thread = false;
+}
+
+// the function's statement in the program's AST
+static function_node *function_at(AST *ast, size_t index)
+{
+    return ast_statement(ast, ast->function_nodes[index])->stmnt_function_declaration.function_node;
+}
+
+// the program's AST is only read here, the bodies go into the worker's own AST
+static void *parse_bodies_worker(void *argument)
+{
+    body_worker *worker = argument;
+    AST *ast = worker->program;
+    // a recoverable compile stops only this worker, parse_function_bodies passes the error on once all are done
+    if (worker->compiler.recover) {
+        worker->compiler.recover = &worker->recover;
+        if (setjmp(worker->recover)) return NULL;
+    }
+    for (size_t f = worker->first; f < worker->last; f++) {
+        function_body *body = &ast->function_bodies[f];
+        function_node *function = function_at(ast, f);
+        worker->parser.current = body->start;
+        worker->counters.while_statements = body->while_base;
+        function->code_block = parse_code_block(&worker->compiler, &worker->parser, true, function->parameters, function->param_count, function->return_type);
+    }
     return NULL;
 }
 
+// parses every function body on up to compiler->threads workers once the signatures are collected,
+// ast->function_bodies must hold where each body starts. the workers split the functions into runs of
+// about the same token count and only read the shared tokens, signatures and global scope. false, with
+// ast->function_bodies freed, when the program has to be parsed serially
+bool parse_function_bodies(Compiler *compiler, AST *ast)
+{
+    size_t worker_count = compiler->threads < ast->function_node_count ? compiler->threads : ast->function_node_count;
+    if (worker_count < 2 || !find_function_bodies(compiler->tokens, ast)) {
+        free(ast->function_bodies);
+        ast->function_bodies = NULL;
+        return false;
+    }
+
+    size_t total = 0;
+    for (size_t f = 0; f < ast->function_node_count; f++) total += ast->function_bodies[f].end - ast->function_bodies[f].start + 1;
+
+    body_worker *workers = malloc(sizeof(body_worker) * worker_count);
+    Arena **arenas = realloc(compiler->body_arenas, sizeof(Arena *) * (compiler->body_arena_count + 3 * worker_count));
+    if (!workers || !arenas) panic(ERROR_MEMORY_ALLOCATION, "Body parser allocation failed", compiler);
+    compiler->body_arenas = arenas;
 
+    size_t first = 0, seen = 0;
+    for (size_t w = 0; w < worker_count; w++) {
+        size_t last = first;
+        size_t target = total / worker_count * (w + 1);
+        if (w + 1 == worker_count) last = ast->function_node_count;
+        else {
+            // every worker after this one still needs a function
+            while (last < ast->function_node_count - (worker_count - w - 1) && (last == first || seen < target)) {
+                seen += ast->function_bodies[last].end - ast->function_bodies[last].start + 1;
+                last++;
+            }
+        }
+        init_body_worker(&workers[w], compiler, first, last);
+        compiler->body_arenas[compiler->body_arena_count++] = workers[w].compiler.statements_arena;
+        compiler->body_arenas[compiler->body_arena_count++] = workers[w].compiler.expressions_arena;
+        compiler->body_arenas[compiler->body_arena_count++] = workers[w].compiler.symbol_arena;
+        first = last;
+    }
+
+    // the first worker runs on this thread, a worker whose thread could not start runs here too
+    for (size_t w = 1; w < worker_count; w++) {
+        workers[w].on_thread = pthread_create(&workers[w].thread, NULL, parse_bodies_worker, &workers[w]) == 0;
+    }
+    parse_bodies_worker(&workers[0]);
+    for (size_t w = 1; w < worker_count; w++) {
+        if (workers[w].on_thread) pthread_join(workers[w].thread, NULL);
+        else parse_bodies_worker(&workers[w]);
+    }
+
+    // the bodies' nodes go after the signatures in worker order, their block ids move with them
+    error_code failure = 0;
+    for (size_t w = 0; w < worker_count; w++) {
+        if (!failure) failure = workers[w].compiler.failure;
+        if (!failure) {
+            uint32_t shift = merge_ast(ast, &workers[w].ast, compiler);
+            for (size_t f = workers[w].first; f < workers[w].last; f++) function_at(ast, f)->code_block += shift;
+        }
+        free_ast(&workers[w].ast);
+        free(workers[w].symbols.storage);
+        free_scope_bindings(&workers[w].symbols);
+        free(workers[w].stack.storage);
+    }
+    free(workers);
+    if (failure) stop_compilation(failure, compiler);
+    return true;
+}
 
-node* parse_function_node(Compiler* compiler, Parser* parser)
+// pass 2 over a function whose body a worker already parsed, leaves the parser and the while labels
+// where parsing the body would have
+void skip_parsed_function(Compiler *compiler, Parser *parser, size_t index)
 {
-    node *func_stmt = arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!func_stmt)
-        panic(ERROR_MEMORY_ALLOCATION, "function decleration node allocation failed", compiler);
+    function_body *body = &compiler->ast->function_bodies[index];
+    function_node *function = function_at(compiler->ast, index);
+    parser->current = body->end + 1;
+    compiler->counters->while_statements = body->while_base + body->while_count;
+    compiler->current_function_symbol_table = ast_statement(compiler->ast, function->code_block)->stmnt_block.table;
+}
 
-    func_stmt->type = NODE_STATEMENT;
 
-    func_stmt->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    if (!func_stmt)
-        panic(ERROR_MEMORY_ALLOCATION, "function decleration node allocation failed", compiler);
-    func_stmt->stmnt->type = STMT_FUNCTION;
+
+stmt_id parse_function_node(Compiler* compiler, Parser* parser)
+{
     advance(parser);                   // consume fn
-    token *name_tok = advance(parser); // consume function name
-    if (name_tok->type != TOK_IDENTIFIER) panic(ERROR_SYNTAX, "Syntax error, use case fn function_name (parameters) {\n----->code\n}                         ~~~~~~~~~~~~~", compiler);
+    token name_tok = advance(parser); // consume function name
+    if (name_tok.type != TOK_IDENTIFIER) panic(ERROR_SYNTAX, "Syntax error, use case fn function_name (parameters) {\n----->code\n}                         ~~~~~~~~~~~~~", compiler);
 
     /////////////////////////////////////
 
-    func_stmt->stmnt->stmnt_function_declaration.name = name_tok->str_value.starting_value;
-    func_stmt->stmnt->stmnt_function_declaration.name_length = name_tok->str_value.length;
-
-    func_stmt->stmnt->stmnt_function_declaration.index = hash_function(name_tok->str_value.starting_value, name_tok->str_value.length);
-
-    func_stmt->stmnt->stmnt_function_declaration.function_node = arena_alloc(compiler->symbol_arena, sizeof(function_node), compiler);
+    function_node *function = arena_alloc(compiler->symbol_arena, sizeof(function_node), compiler);
     
-    if (!func_stmt->stmnt->stmnt_function_declaration.function_node) panic(ERROR_MEMORY_ALLOCATION, "function decleration node allocation failed", compiler);
+    if (!function) panic(ERROR_MEMORY_ALLOCATION, "function decleration node allocation failed", compiler);
     
-    func_stmt->stmnt->stmnt_function_declaration.function_node->name = name_tok->str_value.starting_value;
-    func_stmt->stmnt->stmnt_function_declaration.function_node->name_length = name_tok->str_value.length;
+    function->name = name_tok.str_value.starting_value;
+    function->name_length = name_tok.str_value.length;
+    function->symbol_id = name_tok.symbol_id;
 
 
     //////////////////////////////////////
 
     uint32_t param_count = 0;
     // split to case void and case parameters
-    if (peek(parser, 0)->type != TOK_LPAREN)
+    if (peek_type(parser, 0) != TOK_LPAREN)
         panic(ERROR_SYNTAX, "fn function_name ( parameters ) { code }\n   ~\n", compiler);
     advance(parser); // consume (
-    if (peek(parser, 0)->type == TOK_VOID && peek(parser, 1)->type == TOK_RPAREN)
+    if (peek_type(parser, 0) == TOK_VOID && peek_type(parser, 1) == TOK_RPAREN)
     {
         advance(parser); // consume void
         advance(parser); // consume )
-        func_stmt->stmnt->stmnt_function_declaration.function_node->param_count = 0;
-        func_stmt->stmnt->stmnt_function_declaration.function_node->parameters = NULL;
+        function->param_count = 0;
+        function->parameters = NULL;
     }
     else
     {
-        // find number of parameters and check syntax
-        size_t tmp = 0;
+        // parse and check every parameter in one go, they wait on the parse stack until ')'
+        size_t mark = compiler->parse_stack->current_size;
+        expr_id first_param = compiler->ast->expression_count;
         while (true)
         {
 
             // check if dev didn't close the paren
-            if (peek(parser, tmp)->type == TOK_EOF)
+            if (peek_type(parser, 0) == TOK_EOF)
                 panic(ERROR_SYNTAX, "fn function_name (parameters')'\n                             ~\n", compiler);
 
-            if (peek(parser, tmp)->type != TOK_IDENTIFIER)
+            if (peek_type(parser, 0) != TOK_IDENTIFIER)
                 panic(ERROR_SYNTAX, "function parameter name not specified", compiler);
-            tmp++;
-            
-            
-            parse_param_data_type(parser, compiler, &tmp); // check if data type is correct, we will parse it again later, this is just for syntax checking and if incorrect it will throw a panic
-            
+            token name = advance(parser); // consume param name
+
+            if (peek_type(parser, 0) != TOK_COLON)
+                panic(ERROR_SYNTAX, "Expected a colon ':' after variable name", compiler);
+
+            data_type *param_type = parse_data_type(parser, compiler);
+            expr_id param_node = new_expression(compiler, EXPR_IDENTIFIER);
+            expression *param = ast_expression(compiler->ast, param_node);
+            param->variable.name = name.str_value.starting_value;
+            param->variable.length = name.str_value.length;
+            param->variable.symbol_id = name.symbol_id;
+            param->result_type = param_type;
+            push_parsed(compiler, param_node);
+
             param_count++;
-            if (peek(parser, tmp)->type == TOK_COMMA)
-                tmp++;
-            else if (peek(parser, tmp)->type == TOK_RPAREN)
+            if (peek_type(parser, 0) == TOK_COMMA)
+                advance(parser); // consume ,
+            else if (peek_type(parser, 0) == TOK_RPAREN)
+            {
+                advance(parser); // consume )
                 break;
+            }
             else
                 panic(ERROR_SYNTAX, "after parameter either ')' or ',' only", compiler);
         }
        
         // populate function node info
-        func_stmt->stmnt->stmnt_function_declaration.function_node->param_count = param_count;
-        func_stmt->stmnt->stmnt_function_declaration.function_node->parameters = arena_alloc(compiler->symbol_arena, sizeof(expression) * param_count, compiler);
-        
-        if (!func_stmt->stmnt->stmnt_function_declaration.function_node->parameters)
-            panic(ERROR_MEMORY_ALLOCATION, "function parameters allocation failed", compiler);
-
-        // loop through them and store their name, name len, data type
-        for (size_t i = 0; i < param_count; i++)
-        {
-            token *name = advance(parser); // consume param name
-            func_stmt->stmnt->stmnt_function_declaration.function_node->parameters[i].variable.name = name->str_value.starting_value;
-            func_stmt->stmnt->stmnt_function_declaration.function_node->parameters[i].variable.length = name->str_value.length;
-            func_stmt->stmnt->stmnt_function_declaration.function_node->parameters[i].variable.hash = hash_function(name->str_value.starting_value, name->str_value.length);
-
-            func_stmt->stmnt->stmnt_function_declaration.function_node->parameters[i].variable.data_type = parse_data_type(parser, compiler);
-            advance(parser); // consume , or )  it doesn't rly matter
-        }
+        function->param_count = param_count;
+        function->parameters = pop_expressions(compiler, compiler->symbol_arena, mark);
+        // the function keeps copies, nothing was added to the AST after the parameters
+        compiler->ast->expression_count = first_param;
     }
     // now we are at the return type
-    func_stmt->stmnt->stmnt_function_declaration.function_node->return_type = parse_data_type(parser, compiler);
+    function->return_type = parse_data_type(parser, compiler);
     // consumed return type
     // now at {
     
-    append_function_to_func_map(func_stmt->stmnt->stmnt_function_declaration.function_node, func_stmt->stmnt->stmnt_function_declaration.index, compiler);
+    append_function_to_func_map(function, compiler);
     
-    func_stmt->stmnt->stmnt_function_declaration.function_node->code_block = NULL;
-    func_stmt->stmnt->stmnt_function_declaration.function_node->next = NULL;
+    function->code_block = 0;
+
+    stmt_id func_stmt = new_statement(compiler, STMT_FUNCTION);
+    statement *declaration = ast_statement(compiler->ast, func_stmt);
+    declaration->stmnt_function_declaration.name = name_tok.str_value.starting_value;
+    declaration->stmnt_function_declaration.name_length = name_tok.str_value.length;
+    declaration->stmnt_function_declaration.symbol_id = name_tok.symbol_id;
+    declaration->stmnt_function_declaration.function_node = function;
     
     return func_stmt;
 }
 
-node *parse_code_block(Compiler *compiler, Parser *parser, bool function_block, expression *params, size_t param_count, data_type* function_return_type)
+stmt_id parse_code_block(Compiler *compiler, Parser *parser, bool function_block, expression *params, size_t param_count, data_type* function_return_type)
 {
     // for function blocks, not a function: 0 a function but no return type: 1 a function with a return type: 2
-    if (advance(parser)->type != TOK_LBRACE)
+    if (advance(parser).type != TOK_LBRACE)
         panic(ERROR_SYNTAX, "Must start code block using '{'", compiler);
-    node *block_node = arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-    if (!block_node)
-        panic(ERROR_MEMORY_ALLOCATION, "Code block node allocation failed", compiler);
-    block_node->type = NODE_STATEMENT;
-    block_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-    if (!block_node->stmnt)
-        panic(ERROR_MEMORY_ALLOCATION, "Code block statement allocation failed", compiler);
-    block_node->stmnt->type = STMT_BLOCK;
-
-    // Save current position
-    size_t start_position = parser->current;
-    // Fast forward to find matching RBRACE and count statements
-    size_t brace_depth = 1;
-    size_t stmt_count = 0;
-    size_t i = 0;
-    while (brace_depth > 0)
-    {
-        token *tok = peek(parser, i);
-        if (!tok)
-            panic(ERROR_SYNTAX, "Unclosed brace", compiler);
-
-        if (tok->type == TOK_LBRACE)
-        {
-            brace_depth++;
-        }
-        else if (tok->type == TOK_RBRACE)
-        {
-            brace_depth--;
-        }
-        else if (brace_depth == 1)
-        {
-            // Only count statements at our depth
-            // Heuristic: count statement starters
-            if (tok->type == TOK_LET ||
-                tok->type == TOK_EXIT ||
-                tok->type == TOK_RETURN ||
-                tok->type == TOK_IF ||
-                tok->type == TOK_ELSE ||
-                tok->type == TOK_WHILE ||
-                tok->type == TOK_FOR ||
-                tok->type == TOK_BREAK||
-                tok->type == TOK_IDENTIFIER)
-            {
-                stmt_count++;
-            }
-        }
-        i++;
-    }
-    // Reset parser position
-    parser->current = start_position;
 
-    block_node->stmnt->stmnt_block.statements = (statement **)arena_alloc(compiler->statements_arena, sizeof(statement *) * stmt_count, compiler);
-    size_t statement_count = 0;
+    // statements wait on the parse stack until the closing }
+    size_t mark = compiler->parse_stack->current_size;
     if (function_block) {
         enter_new_function_scope(compiler, function_return_type);
     }
@@ -912,7 +855,7 @@ node *parse_code_block(Compiler *compiler, Parser *parser, bool function_block,
         enter_new_scope(compiler, function_return_type);
     }
 
-    block_node->stmnt->stmnt_block.table = peek_symbol_stack(compiler);
+    symbol_table *table = peek_symbol_stack(compiler);
 
 
     // if the thing has a return value
@@ -936,10 +879,12 @@ node *parse_code_block(Compiler *compiler, Parser *parser, bool function_block,
             add_var_to_current_scope(compiler, &(params[i]), STORE_AS_PARAM, 0);
         }
     }
-    while (peek(parser, 0)->type != TOK_RBRACE)
+    while (peek_type(parser, 0) != TOK_RBRACE)
     {
-        node *statement = NULL;
-        switch (peek(parser, 0)->type)
+        if (parser_at_end(parser))
+            panic(ERROR_SYNTAX, "Unclosed brace", compiler);
+        stmt_id statement = 0;
+        switch (peek_type(parser, 0))
         {
         case TOK_EXIT:
             statement = parse_exit_node(compiler, parser);
@@ -951,8 +896,9 @@ node *parse_code_block(Compiler *compiler, Parser *parser, bool function_block,
 
         case TOK_IF:
             statement = parse_if_node(compiler, parser);
-            if (statement->stmnt->stmnt_if.return_percent == 2) has_ret = 2;
-            else if ((statement->stmnt->stmnt_if.return_percent == 1) && (has_ret == 0)) has_ret = 1;
+            int return_percent = ast_statement(compiler->ast, statement)->stmnt_if.return_percent;
+            if (return_percent == 2) has_ret = 2;
+            else if ((return_percent == 1) && (has_ret == 0)) has_ret = 1;
             break;
 
         case TOK_WHILE:
@@ -962,15 +908,15 @@ node *parse_code_block(Compiler *compiler, Parser *parser, bool function_block,
         case TOK_IDENTIFIER:
         {
             // x = 5;
-            if (!peek(parser, 1))
+            if (peek_type(parser, 1) == TOK_NONE)
                 break;
-            if (peek(parser, 1)->type == TOK_EQUAL)
+            if (peek_type(parser, 1) == TOK_EQUAL)
             {
                 // assignment
                 statement = parse_assignment_node(compiler, parser);
             }
             else {
-                statement = parse_expression(parser, PREC_NONE, true, compiler);
+                statement = parse_expression_statement(compiler, parser);
             }
             break;
         }
@@ -984,11 +930,12 @@ node *parse_code_block(Compiler *compiler, Parser *parser, bool function_block,
             statement = parse_return_node(compiler, parser);
             has_ret = 2;
 
-            if (statement && statement->stmnt)
+            if (statement)
             {
                 
                 data_type* expected_return_type = peek_symbol_stack(compiler)->scope_data_type;
-                if (statement->stmnt->stmnt_return.return_data_type->general_data_type != expected_return_type->general_data_type)
+                data_type* return_data_type = ast_statement(compiler->ast, statement)->stmnt_return.return_data_type;
+                if (return_data_type != expected_return_type && return_data_type->general_data_type != expected_return_type->general_data_type)
                 {
                     panic(ERROR_TYPE_MISMATCH, "Incompatible return type of output with current scope", compiler);
                 }
@@ -997,14 +944,13 @@ node *parse_code_block(Compiler *compiler, Parser *parser, bool function_block,
         }
         
         default:
-            statement = parse_expression(parser, PREC_NONE, true, compiler);
+            statement = parse_expression_statement(compiler, parser);
             break;
         }
         //if (has_ret == 2) skip to end of block; dead code elmination
         if (!statement)
             continue;
-        block_node->stmnt->stmnt_block.statements[statement_count] = statement->stmnt;
-        statement_count++;
+        push_parsed(compiler, statement);
     }
 
     if (function_block) // fn add(x :int, y :int) :int {}
@@ -1016,9 +962,16 @@ node *parse_code_block(Compiler *compiler, Parser *parser, bool function_block,
         }
     }
 
-    block_node->stmnt->stmnt_block.statement_count = statement_count;
+    uint32_t statement_count = compiler->parse_stack->current_size - mark;
+    uint32_t statements = pop_list(compiler, mark);
     advance(parser); // consume }
     exit_current_scope(compiler);
+
+    stmt_id block_node = new_statement(compiler, STMT_BLOCK);
+    statement *block = ast_statement(compiler->ast, block_node);
+    block->stmnt_block.statements = statements;
+    block->stmnt_block.statement_count = statement_count;
+    block->stmnt_block.table = table;
     return block_node;
 }
 //////////////////////////////////////////////////////
@@ -1028,71 +981,16 @@ node *parse_code_block(Compiler *compiler, Parser *parser, bool function_block,
 //////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////
 ///////////////////////////////////////////////
-node *parse_code_block2(Compiler *compiler, Parser *parser, expression *params, size_t param_count, data_type* function_return_type, size_t* path_exahustion)
+stmt_id parse_code_block2(Compiler *compiler, Parser *parser, expression *params, size_t param_count, data_type* function_return_type, size_t* path_exahustion)
 {
     // for function blocks, not a function: 0 a function but no return type: 1 a function with a return type: 2
-    if (advance(parser)->type != TOK_LBRACE) panic(ERROR_SYNTAX, "Must start code block using '{'", compiler);
+    if (advance(parser).type != TOK_LBRACE) panic(ERROR_SYNTAX, "Must start code block using '{'", compiler);
 
-    node *block_node = arena_alloc(compiler->statements_arena, sizeof(node), compiler);
-
-    if (!block_node)    panic(ERROR_MEMORY_ALLOCATION, "Code block node allocation failed", compiler);
-
-    block_node->type = NODE_STATEMENT;
-    block_node->stmnt = arena_alloc(compiler->statements_arena, sizeof(statement), compiler);
-
-    if (!block_node->stmnt)    panic(ERROR_MEMORY_ALLOCATION, "Code block statement allocation failed", compiler);
-
-    block_node->stmnt->type = STMT_BLOCK;
-
-    // Save current position
-    size_t start_position = parser->current;
-    // Fast forward to find matching RBRACE and count statements
-    size_t brace_depth = 1;
-    size_t stmt_count = 0;
-    size_t i = 0;
-
-    while (brace_depth > 0)
-    {
-        token *tok = peek(parser, i);
-        if (!tok)
-            panic(ERROR_SYNTAX, "Unclosed brace", compiler);
-
-        if (tok->type == TOK_LBRACE)
-        {
-            brace_depth++;
-        }
-        else if (tok->type == TOK_RBRACE)
-        {
-            brace_depth--;
-        }
-        else if (brace_depth == 1)
-        {
-            // Only count statements at our depth
-            // Heuristic: count statement starters
-            if (tok->type == TOK_LET ||
-                tok->type == TOK_EXIT ||
-                tok->type == TOK_RETURN ||
-                tok->type == TOK_IF ||
-                tok->type == TOK_ELSE ||
-                tok->type == TOK_WHILE ||
-                tok->type == TOK_FOR ||
-                tok->type == TOK_BREAK||
-                tok->type == TOK_IDENTIFIER)
-            {
-                stmt_count++;
-            }
-        }
-        i++;
-    }
-
-    // Reset parser position
-    parser->current = start_position;
-
-    block_node->stmnt->stmnt_block.statements = (statement **)arena_alloc(compiler->statements_arena, sizeof(statement *) * stmt_count, compiler);
-    size_t statement_count = 0;
+    // statements wait on the parse stack until the closing }
+    size_t mark = compiler->parse_stack->current_size;
     
     enter_new_scope(compiler, function_return_type);
-    block_node->stmnt->stmnt_block.table = peek_symbol_stack(compiler);
+    symbol_table *table = peek_symbol_stack(compiler);
 
 
     // if the thing has a return value
@@ -1118,10 +1016,12 @@ node *parse_code_block2(Compiler *compiler, Parser *parser, expression *params,
             add_var_to_current_scope(compiler, &(params[i]), STORE_AS_PARAM, 0);
         }
     }
-    while (peek(parser, 0)->type != TOK_RBRACE)
+    while (peek_type(parser, 0) != TOK_RBRACE)
     {
-        node *statement = NULL;
-        switch (peek(parser, 0)->type)
+        if (parser_at_end(parser))
+            panic(ERROR_SYNTAX, "Unclosed brace", compiler);
+        stmt_id statement = 0;
+        switch (peek_type(parser, 0))
         {
         case TOK_EXIT:
             statement = parse_exit_node(compiler, parser);
@@ -1133,7 +1033,7 @@ node *parse_code_block2(Compiler *compiler, Parser *parser, expression *params,
 
         case TOK_IF:
             statement = parse_if_node(compiler, parser);
-            has_ret = (statement->stmnt->stmnt_if.return_percent == 2);
+            has_ret = (ast_statement(compiler->ast, statement)->stmnt_if.return_percent == 2);
             break;
 
         case TOK_WHILE:
@@ -1143,15 +1043,15 @@ node *parse_code_block2(Compiler *compiler, Parser *parser, expression *params,
         case TOK_IDENTIFIER:
         {
             // x = 5;
-            if (!peek(parser, 1))
+            if (peek_type(parser, 1) == TOK_NONE)
                 panic(ERROR_UNDEFINED, "nothing after identifier\n", compiler);
-            if (peek(parser, 1)->type == TOK_EQUAL)
+            if (peek_type(parser, 1) == TOK_EQUAL)
             {
                 // assignment
                 statement = parse_assignment_node(compiler, parser);
             }
             else {
-                statement = parse_expression(parser, PREC_NONE, true, compiler);
+                statement = parse_expression_statement(compiler, parser);
             }
             break;
         }
@@ -1165,12 +1065,12 @@ node *parse_code_block2(Compiler *compiler, Parser *parser, expression *params,
             statement = parse_return_node(compiler, parser);
             has_ret = 1;
 
-            if (statement && statement->stmnt)
+            if (statement)
             {
-                return_type = statement->stmnt->stmnt_return.return_data_type;
+                return_type = ast_statement(compiler->ast, statement)->stmnt_return.return_data_type;
                 
                 data_type* expected_return_type = peek_symbol_stack(compiler)->scope_data_type;
-                if (return_type->general_data_type != expected_return_type->general_data_type)
+                if (return_type != expected_return_type && return_type->general_data_type != expected_return_type->general_data_type)
                 {
                     panic(ERROR_TYPE_MISMATCH, "Incompatible return type of output with current scope", compiler);
                 }
@@ -1179,20 +1079,26 @@ node *parse_code_block2(Compiler *compiler, Parser *parser, expression *params,
         }
         
         default:
-            statement = parse_expression(parser, PREC_NONE, true, compiler);
+            statement = parse_expression_statement(compiler, parser);
             break;
         }
 
         if (!statement)
             continue;
-        block_node->stmnt->stmnt_block.statements[statement_count] = statement->stmnt;
-        statement_count++;
+        push_parsed(compiler, statement);
     }
     *path_exahustion = *path_exahustion + has_ret;
 
-    block_node->stmnt->stmnt_block.statement_count = statement_count;
+    uint32_t statement_count = compiler->parse_stack->current_size - mark;
+    uint32_t statements = pop_list(compiler, mark);
     advance(parser); // consume }
     exit_current_scope(compiler);
+
+    stmt_id block_node = new_statement(compiler, STMT_BLOCK);
+    statement *block = ast_statement(compiler->ast, block_node);
+    block->stmnt_block.statements = statements;
+    block->stmnt_block.statement_count = statement_count;
+    block->stmnt_block.table = table;
     return block_node;
 }
 
@@ -1200,12 +1106,12 @@ node *parse_code_block2(Compiler *compiler, Parser *parser, expression *params,
 
 
 // 5 + 2 * 3 + x
-node *parse_expression(Parser *parser, int prev_presedence, bool constant_foldable, Compiler *compiler)
+expr_id parse_expression(Parser *parser, int prev_presedence, bool constant_foldable, Compiler *compiler)
 {
-    node *left = parse_prefix(parser, constant_foldable, compiler);
+    expr_id left = parse_prefix(parser, constant_foldable, compiler);
     if (!left) panic(ERROR_SYNTAX, "Expected expression", compiler);
     
-    TokenType curr_opperator = peek(parser, 0)->type;
+    TokenType curr_opperator = peek_type(parser, 0);
     int curr_presedence = presedences[curr_opperator];
 
     while (true)
@@ -1218,24 +1124,24 @@ node *parse_expression(Parser *parser, int prev_presedence, bool constant_foldab
         {
             advance(parser);                                                                   // now parser is on what is after the operator
             left = create_bin_node(left, curr_opperator, parser, constant_foldable, compiler); // now parser is on what was seen as a weak node (like the second plus on 5 + 2 * 3 + 1 )
-            curr_opperator = peek(parser, 0)->type;
+            curr_opperator = peek_type(parser, 0);
             curr_presedence = presedences[curr_opperator];
         }
     }
     return left;
 }
 
-node *parse_prefix(Parser *parser, bool constant_foldable, Compiler *compiler)
+expr_id parse_prefix(Parser *parser, bool constant_foldable, Compiler *compiler)
 {
-    token *current_token = peek(parser, 0);
-    if (!current_token)  return NULL;
+    token current_token = peek(parser, 0);
+    if (current_token.type == TOK_NONE)  return 0;
     
     
-    switch (current_token->type)
+    switch (current_token.type)
     {
     case TOK_NUMBER:
     {
-        node *num_node = create_number_node(current_token->int_value, compiler);
+        expr_id num_node = create_number_node(current_token.int_value, compiler);
         advance(parser); // consume number token
         return num_node;
     }
@@ -1244,113 +1150,88 @@ node *parse_prefix(Parser *parser, bool constant_foldable, Compiler *compiler)
     {
         constant_foldable = false;         // look into the token after the identifier to see if it's a function call or variable
         advance(parser);                   // consume identifier token
-        token *next_tok = peek(parser, 0); // consume identifier token
-        if (next_tok->type == TOK_EOF) panic(ERROR_SYNTAX, "Unexpected end of file after identifier", compiler);
+        token next_tok = peek(parser, 0); // consume identifier token
+        if (next_tok.type == TOK_EOF) panic(ERROR_SYNTAX, "Unexpected end of file after identifier", compiler);
         
         ////////////////////// FUNC CALL   //////////////////////////////
-        if (next_tok->type == TOK_LPAREN)
+        if (next_tok.type == TOK_LPAREN)
         {
             advance(parser); // consume '('
             // Handle empty arguments: f() or f(void)
-            if (peek(parser, 0)->type == TOK_RPAREN || (peek(parser, 0)->type == TOK_VOID && peek(parser, 1)->type == TOK_RPAREN))
+            if (peek_type(parser, 0) == TOK_RPAREN || (peek_type(parser, 0) == TOK_VOID && peek_type(parser, 1) == TOK_RPAREN))
             {
 
-                if (peek(parser, 0)->type == TOK_VOID)
+                if (peek_type(parser, 0) == TOK_VOID)
                 {
                     advance(parser); // consume 'void'
                 }
                 advance(parser); // consume ')'
 
-                return create_func_call_node(current_token->str_value.starting_value, current_token->str_value.length, NULL, 0, compiler);
+                return create_func_call_node(current_token.str_value.starting_value, current_token.str_value.length, current_token.symbol_id, 0, 0, compiler);
             }
             else
             { // normal case
-                size_t param_count = 0;
-
-                // first pass
-                size_t tmp = 0;
-                size_t depth = 0;
-                while (peek(parser, tmp)->type != TOK_RPAREN)
+                // arguments wait on the parse stack until ')'
+                size_t mark = compiler->parse_stack->current_size;
+                do
                 {
-                    
-                    if ((peek(parser, tmp)->type == TOK_COMMA) && (depth == 0)) {
-                        param_count++;
-                        tmp++;
-                    }
-                    else if (peek(parser, tmp)->type == TOK_LPAREN)
-                    {
-                        depth++;
-                        tmp++;
-                    }
-                    else if (peek(parser, tmp)->type == TOK_RPAREN)
-                    {
-                        if (depth == 0)
-                            break;
-                        depth--;
-                        tmp++;
-                    }
-                    tmp++;
-                }
-                param_count++;
+                    push_parsed(compiler, parse_expression(parser, PREC_NONE, false, compiler));
+                } while (advance(parser).type == TOK_COMMA); // consume comma and final R_BRACE
 
-                // second pass
-                expression *expressions = arena_alloc(compiler->expressions_arena, param_count * sizeof(expression), compiler);
-                for (size_t i = 0; i < param_count; i++)
-                {
-                    expressions[i] = *(parse_expression(parser, PREC_NONE, false, compiler)->expr);
-                    advance(parser); // consume comma and final R_BRACE
-                }
-                return create_func_call_node(current_token->str_value.starting_value, current_token->str_value.length, expressions, param_count, compiler);
+                // the call keeps the parsed arguments where they are, only their ids are copied
+                size_t param_count = compiler->parse_stack->current_size - mark;
+                uint32_t arguments = pop_list(compiler, mark);
+                return create_func_call_node(current_token.str_value.starting_value, current_token.str_value.length, current_token.symbol_id, arguments, param_count, compiler);
             }
         }
-        else if (next_tok->type == TOK_POINTER_DEREF) {
+        else if (next_tok.type == TOK_POINTER_DEREF) {
             advance(parser);
-            symbol_node* operand = find_variable(compiler, hash_function(current_token->str_value.starting_value, current_token->str_value.length), current_token->str_value.starting_value, current_token->str_value.length);
+            symbol_node* operand = find_variable(compiler, current_token.symbol_id);
             if (!operand)
             {
                 panic(ERROR_UNDEFINED_VARIABLE, "Variable used before declaration", compiler);
             }
-            node* operand_node = create_variable_node(operand->var_name, operand->var_name_size, compiler);
+            expr_id operand_node = create_variable_node(operand->var_name, operand->var_name_size, operand->symbol_id, compiler);
 
-            node* deref_node = create_deref_node(operand_node, compiler);
-            while (peek(parser, 0)->type == TOK_POINTER_DEREF) {
+            expr_id deref_node = create_deref_node(operand_node, compiler);
+            while (peek_type(parser, 0) == TOK_POINTER_DEREF) {
                 advance(parser);
                 deref_node = create_deref_node(deref_node, compiler);
             }
             return deref_node;
         }
 
-        else if (next_tok->type == TOK_LBRACKET) {
+        else if (next_tok.type == TOK_LBRACKET) {
             advance(parser);
-            symbol_node* array = find_variable(compiler, hash_function(current_token->str_value.starting_value, current_token->str_value.length), current_token->str_value.starting_value, current_token->str_value.length);
+            symbol_node* array = find_variable(compiler, current_token.symbol_id);
             if (array->data_type->data_type_family != FAMILY_ARRAY && array->data_type->data_type_family != FAMILY_POINTER) {
                 panic(ERROR_TYPE_MISMATCH, "Cannot index into a non array", compiler);
             }
             
-            node* index = parse_expression(parser, PREC_NONE, 1, compiler);
-            if (peek(parser, 0)->type != TOK_RBRACKET) panic(ERROR_SYNTAX, "Expected ']' after array indexing", compiler);
+            expr_id index = parse_expression(parser, PREC_NONE, 1, compiler);
+            if (peek_type(parser, 0) != TOK_RBRACKET) panic(ERROR_SYNTAX, "Expected ']' after array indexing", compiler);
             advance(parser);
-            node* array_node = create_variable_node(array->var_name, array->var_name_size, compiler);
-            node* array_index_node = create_array_index_node(array_node->expr, index->expr, compiler);
+            expr_id array_node = create_variable_node(array->var_name, array->var_name_size, array->symbol_id, compiler);
+            expr_id array_index_node = create_array_index_node(array_node, index, compiler);
 
-            while (peek(parser, 0)->type == TOK_LBRACKET) {
+            while (peek_type(parser, 0) == TOK_LBRACKET) {
                 advance(parser);
                 index = parse_expression(parser, PREC_NONE, 1, compiler);
-                if (peek(parser, 0)->type != TOK_RBRACKET) panic(ERROR_SYNTAX, "Expected ']' after array indexing", compiler);
+                if (peek_type(parser, 0) != TOK_RBRACKET) panic(ERROR_SYNTAX, "Expected ']' after array indexing", compiler);
                 advance(parser);
-                array_index_node = create_array_index_node(array_index_node->expr, index->expr, compiler);
+                array_index_node = create_array_index_node(array_index_node, index, compiler);
             }
             return array_index_node;
         }
 
         else
         {
-            symbol_node *var = find_variable(compiler, hash_function(current_token->str_value.starting_value, current_token->str_value.length), current_token->str_value.starting_value, current_token->str_value.length);
+            symbol_node *var = find_variable(compiler, current_token.symbol_id);
             if (!var)
             {
                 panic(ERROR_UNDEFINED_VARIABLE, "Variable used before declaration", compiler);
             }
-            node *var_node = create_variable_node(var->var_name, var->var_name_size, compiler);
+            expr_id var_node = create_variable_node(var->var_name, var->var_name_size, var->symbol_id, compiler);
             return var_node;
         }
         panic(ERROR_SYNTAX, "Invalid identifier usage", compiler);
@@ -1360,8 +1241,8 @@ node *parse_prefix(Parser *parser, bool constant_foldable, Compiler *compiler)
     case TOK_SUB:
     { // Unary minus
         advance(parser);
-        node *operand = parse_expression(parser, PREC_UNARY, true, compiler);
-        node *sub_node = create_unary_node(TOK_SUB, operand, compiler);
+        expr_id operand = parse_expression(parser, PREC_UNARY, true, compiler);
+        expr_id sub_node = create_unary_node(TOK_SUB, operand, compiler);
 
         return sub_node;
     }
@@ -1369,15 +1250,15 @@ node *parse_prefix(Parser *parser, bool constant_foldable, Compiler *compiler)
     case TOK_BIT_AND:
     {  //for getting the address
         advance(parser); // consume &
-        node *operand = parse_expression(parser, PREC_UNARY, true, compiler);
-        node *address_node = create_address_node(operand, compiler);
+        expr_id operand = parse_expression(parser, PREC_UNARY, true, compiler);
+        expr_id address_node = create_address_node(operand, compiler);
         return address_node;
     }
     case TOK_LPAREN:
     {
         advance(parser);
-        node *expr = parse_expression(parser, PREC_NONE, true, compiler);
-        if (peek(parser, 0)->type != TOK_RPAREN)
+        expr_id expr = parse_expression(parser, PREC_NONE, true, compiler);
+        if (peek_type(parser, 0) != TOK_RPAREN)
         {
             panic(ERROR_SYNTAX, "Expected ')' ", compiler);
         }
@@ -1389,44 +1270,24 @@ node *parse_prefix(Parser *parser, bool constant_foldable, Compiler *compiler)
     {
         advance(parser); // consume {
 
-        // first pass to count the number of expressions
-        size_t number_of_expressions = 0;
-        size_t tmp_offset = 0; // start after the {
-        while (peek(parser, tmp_offset)) {
-            if (peek(parser, tmp_offset)->type == TOK_RBRACE) {number_of_expressions++; break;}
-            else if (peek(parser, tmp_offset)->type == TOK_COMMA) {number_of_expressions++; tmp_offset++;}
-            else if (peek(parser, tmp_offset)->type == TOK_LBRACE) 
-            {
-                size_t depth = 1;
-                tmp_offset++;
-                while (depth > 0) {
-                    if (peek(parser, tmp_offset)->type == TOK_LBRACE) depth++;
-                    else if (peek(parser, tmp_offset)->type == TOK_RBRACE) depth--;
-                    tmp_offset++;
-                }
-            }
-            else {
-                tmp_offset++;
-            }
-        }
-
-        // second pass to parse the expressions and create the initializer list node
-        expression *exprs = arena_alloc(compiler->expressions_arena, sizeof(expression) * (number_of_expressions), compiler);
-        for (size_t i = 0; i < number_of_expressions; i++) {
-            exprs[i] = *(parse_expression(parser, PREC_NONE, false, compiler)->expr);
-            if (peek(parser, 0)->type == TOK_COMMA) advance(parser); // consume comma
+        // parse the expressions onto the parse stack, then create the initializer list node
+        size_t mark = compiler->parse_stack->current_size;
+        while (true) {
+            push_parsed(compiler, parse_expression(parser, PREC_NONE, false, compiler));
+            if (peek_type(parser, 0) != TOK_COMMA) break;
+            advance(parser); // consume comma
         }
         advance(parser); // consume }
 
+        size_t number_of_expressions = compiler->parse_stack->current_size - mark;
+        uint32_t elements = pop_list(compiler, mark);
+
         // make the node itself and return it
-        node* initializer_list_node = arena_alloc(compiler->expressions_arena, sizeof(node), compiler);
-        if (!initializer_list_node) panic(ERROR_MEMORY_ALLOCATION, "Initializer list node allocation failed", compiler);
-        initializer_list_node->type = NODE_EXPRESSION;
-        initializer_list_node->expr = arena_alloc(compiler->expressions_arena, sizeof(expression), compiler);
-        initializer_list_node->expr->type = EXPR_INIT_LIST;
-        initializer_list_node->expr->result_type = NULL;
-        initializer_list_node->expr->init_list.count = number_of_expressions;
-        initializer_list_node->expr->init_list.elements = exprs;
+        expr_id initializer_list_node = new_expression(compiler, EXPR_INIT_LIST);
+        expression *initializer_list = ast_expression(compiler->ast, initializer_list_node);
+        initializer_list->result_type = NULL;
+        initializer_list->init_list.count = number_of_expressions;
+        initializer_list->init_list.elements = elements;
         return initializer_list_node;
     }
 
@@ -1434,5 +1295,5 @@ node *parse_prefix(Parser *parser, bool constant_foldable, Compiler *compiler)
         panic(ERROR_UNDEFINED, "Unexpected token/s, may still not be emplemented", compiler);
     }
     // will never reach this case
-    return NULL;
+    return 0;
 }
@@ -0,0 +1,75 @@
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+
+#include "utilities/utils.h"
+#include <stdint.h>
+#include <string.h>
+
+// Keyword table indexed by a minimal perfect hash: the (at most 8 byte) identifier is packed into a
+// little endian u64, multiplied by KEYWORD_HASH_MULTIPLIER and the high half taken modulo KEYWORD_COUNT.
+// Every keyword lands in its own slot, so one multiply, one compare and no branching on length or
+// characters decides keyword vs identifier. The multiplier comes from tools/find_keyword_hash.c,
+// rerun it when adding a keyword.
+#define KEYWORD_COUNT 20
+#define KEYWORD_HASH_MULTIPLIER 0x79558410aea0370full
+
+typedef struct {
+    char name[8]; // zero padded, compared as one u64
+    TokenType type;
+} keyword_entry;
+
+static const keyword_entry KEYWORDS[KEYWORD_COUNT] = {
+    [0] = {"bool", TOK_BOOL},
+    [1] = {"int", TOK_INT},
+    [2] = {"while", TOK_WHILE},
+    [3] = {"let", TOK_LET},
+    [4] = {"void", TOK_VOID},
+    [5] = {"break", TOK_BREAK},
+    [6] = {"fn", TOK_FN},
+    [7] = {"return", TOK_RETURN},
+    [8] = {"double", TOK_DOUBLE},
+    [9] = {"float", TOK_FLOAT},
+    [10] = {"false", TOK_FALSE},
+    [11] = {"if", TOK_IF},
+    [12] = {"true", TOK_TRUE},
+    [13] = {"exit", TOK_EXIT},
+    [14] = {"char", TOK_CHAR},
+    [15] = {"long", TOK_LONG},
+    [16] = {"continue", TOK_CONTINUE},
+    [17] = {"for", TOK_FOR},
+    [18] = {"else", TOK_ELSE},
+    [19] = {"null", TOK_NULL},
+};
+
+static inline uint32_t load_u32(const char* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline TokenType classify_identifier(const char* value, size_t length)
+{
+    if (length > 8 || length == 0) return TOK_IDENTIFIER;
+
+    // Pack the identifier without reading past it: 4..8 bytes are two overlapping 4 byte loads,
+    // 1..3 bytes are first/middle/last byte (the overlapping bytes land on the same position either way).
+    uint64_t word;
+    if (length >= 4) {
+        word = load_u32(value) | ((uint64_t)load_u32(value + length - 4) << (8 * (length - 4)));
+    }
+    else {
+        word = (uint64_t)(uint8_t)value[0]
+             | ((uint64_t)(uint8_t)value[length >> 1] << (8 * (length >> 1)))
+             | ((uint64_t)(uint8_t)value[length - 1] << (8 * (length - 1)));
+    }
+
+    // identifiers never contain '\0', so equal zero padded words also means equal lengths
+    const keyword_entry* candidate = &KEYWORDS[(uint32_t)((word * KEYWORD_HASH_MULTIPLIER) >> 32) % KEYWORD_COUNT];
+
+    uint64_t keyword;
+    memcpy(&keyword, candidate->name, sizeof(keyword));
+    return keyword == word ? candidate->type : TOK_IDENTIFIER;
+}
+
+#endif
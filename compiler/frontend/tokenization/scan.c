@@ -0,0 +1,226 @@
+#include "frontend/tokenization/scan.h"
+#include "frontend/tokenization/tokenize.h"
+#include "utilities/utils.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Unoptimized intrinsics spill every vector to the stack and end up slower than the plain loops, the
+// Makefile builds this file with -O2 even in the default -O0 debug build so the vector scanners pay off.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SCAN_WIDTH 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_WIDTH 16
+#endif
+
+#define SCAN_INLINE inline __attribute__((always_inline))
+
+///////////////////////////// scalar /////////////////////////////
+
+size_t scan_whitespace_scalar(const char* source, size_t i, size_t length)
+{
+    while (i < length && CHAR_TYPE[(unsigned char)source[i]] == 3) {
+        i++;
+    }
+    return i;
+}
+
+size_t scan_identifier_scalar(const char* source, size_t i, size_t length)
+{
+    while (i < length && (CHAR_TYPE[(unsigned char)source[i]] == 1 || (source[i] >= '0' && source[i] <= '9'))) {
+        i++;
+    }
+    return i;
+}
+
+size_t scan_digits_scalar(const char* source, size_t i, size_t length)
+{
+    while (i < length && source[i] >= '0' && source[i] <= '9') {
+        i++;
+    }
+    return i;
+}
+
+size_t scan_line_end_scalar(const char* source, size_t i, size_t length)
+{
+    while (i < length && source[i] != '\n') {
+        i++;
+    }
+    return i;
+}
+
+size_t count_newlines_scalar(const char* source, size_t i, size_t length)
+{
+    size_t newlines = 0;
+    for (; i < length; i++) {
+        newlines += source[i] == '\n';
+    }
+    return newlines;
+}
+
+///////////////////////////// vector /////////////////////////////
+// every helper below turns a block of SCAN_WIDTH bytes into a bit mask (bit n set = byte n is part of the run),
+// the run ends at the first zero bit
+
+#if SCAN_WIDTH == 32
+
+typedef __m256i scan_block;
+typedef uint32_t scan_mask;
+#define SCAN_ALL_ONES 0xFFFFFFFFu
+
+static SCAN_INLINE scan_block load_block(const char* p) { return _mm256_loadu_si256((const __m256i*)p); }
+static SCAN_INLINE scan_block splat(char c) { return _mm256_set1_epi8(c); }
+static SCAN_INLINE scan_block eq(scan_block a, scan_block b) { return _mm256_cmpeq_epi8(a, b); }
+static SCAN_INLINE scan_block gt(scan_block a, scan_block b) { return _mm256_cmpgt_epi8(a, b); }
+static SCAN_INLINE scan_block or_(scan_block a, scan_block b) { return _mm256_or_si256(a, b); }
+static SCAN_INLINE scan_block and_(scan_block a, scan_block b) { return _mm256_and_si256(a, b); }
+static SCAN_INLINE scan_mask to_mask(scan_block a) { return (scan_mask)_mm256_movemask_epi8(a); }
+
+#elif SCAN_WIDTH == 16
+
+typedef __m128i scan_block;
+typedef uint32_t scan_mask;
+#define SCAN_ALL_ONES 0xFFFFu
+
+static SCAN_INLINE scan_block load_block(const char* p) { return _mm_loadu_si128((const __m128i*)p); }
+static SCAN_INLINE scan_block splat(char c) { return _mm_set1_epi8(c); }
+static SCAN_INLINE scan_block eq(scan_block a, scan_block b) { return _mm_cmpeq_epi8(a, b); }
+static SCAN_INLINE scan_block gt(scan_block a, scan_block b) { return _mm_cmpgt_epi8(a, b); }
+static SCAN_INLINE scan_block or_(scan_block a, scan_block b) { return _mm_or_si128(a, b); }
+static SCAN_INLINE scan_block and_(scan_block a, scan_block b) { return _mm_and_si128(a, b); }
+static SCAN_INLINE scan_mask to_mask(scan_block a) { return (scan_mask)_mm_movemask_epi8(a); }
+
+#endif
+
+#ifdef SCAN_WIDTH
+
+// most runs in real code are a handful of bytes (one space, a short name), those are cheaper to finish
+// byte by byte than to set up a vector compare for, so the first SCAN_SHORT_RUN bytes are always scalar
+#define SCAN_SHORT_RUN 8
+
+// lo <= byte <= hi, compares are signed so bytes >= 0x80 never match (they are not valid ascii anyway)
+static SCAN_INLINE scan_block in_range(scan_block v, char lo, char hi)
+{
+    return and_(gt(v, splat(lo - 1)), gt(splat(hi + 1), v));
+}
+
+static SCAN_INLINE scan_mask digit_mask(scan_block v)
+{
+    return to_mask(in_range(v, '0', '9'));
+}
+
+static SCAN_INLINE scan_mask identifier_mask(scan_block v)
+{
+    // or-ing 0x20 folds A-Z onto a-z without pulling any other ascii byte into that range
+    scan_block folded = or_(v, splat(0x20));
+    scan_block letters = in_range(folded, 'a', 'z');
+    return to_mask(or_(or_(letters, in_range(v, '0', '9')), eq(v, splat('_'))));
+}
+
+size_t scan_whitespace(const char* source, size_t i, size_t length)
+{
+    size_t short_end = i + SCAN_SHORT_RUN < length ? i + SCAN_SHORT_RUN : length;
+    i = scan_whitespace_scalar(source, i, short_end);
+    if (i < short_end) return i;
+
+    while (i + SCAN_WIDTH <= length) {
+        scan_block v = load_block(&source[i]);
+        scan_mask spaces = to_mask(or_(or_(eq(v, splat(' ')), eq(v, splat('\t'))), or_(eq(v, splat('\r')), eq(v, splat('\n')))));
+        if (spaces != SCAN_ALL_ONES) return i + __builtin_ctz(~spaces);
+        i += SCAN_WIDTH;
+    }
+    return scan_whitespace_scalar(source, i, length);
+}
+
+size_t scan_identifier(const char* source, size_t i, size_t length)
+{
+    size_t short_end = i + SCAN_SHORT_RUN < length ? i + SCAN_SHORT_RUN : length;
+    i = scan_identifier_scalar(source, i, short_end);
+    if (i < short_end) return i;
+
+    while (i + SCAN_WIDTH <= length) {
+        scan_mask mask = identifier_mask(load_block(&source[i]));
+        if (mask != SCAN_ALL_ONES) return i + __builtin_ctz(~mask);
+        i += SCAN_WIDTH;
+    }
+    return scan_identifier_scalar(source, i, length);
+}
+
+size_t scan_digits(const char* source, size_t i, size_t length)
+{
+    size_t short_end = i + SCAN_SHORT_RUN < length ? i + SCAN_SHORT_RUN : length;
+    i = scan_digits_scalar(source, i, short_end);
+    if (i < short_end) return i;
+
+    while (i + SCAN_WIDTH <= length) {
+        scan_mask mask = digit_mask(load_block(&source[i]));
+        if (mask != SCAN_ALL_ONES) return i + __builtin_ctz(~mask);
+        i += SCAN_WIDTH;
+    }
+    return scan_digits_scalar(source, i, length);
+}
+
+size_t scan_line_end(const char* source, size_t i, size_t length)
+{
+    size_t short_end = i + SCAN_SHORT_RUN < length ? i + SCAN_SHORT_RUN : length;
+    i = scan_line_end_scalar(source, i, short_end);
+    if (i < short_end) return i;
+
+    while (i + SCAN_WIDTH <= length) {
+        scan_mask mask = to_mask(eq(load_block(&source[i]), splat('\n')));
+        if (mask) return i + __builtin_ctz(mask);
+        i += SCAN_WIDTH;
+    }
+    return scan_line_end_scalar(source, i, length);
+}
+
+size_t count_newlines(const char* source, size_t i, size_t length)
+{
+    size_t newlines = 0;
+    while (i + SCAN_WIDTH <= length) {
+        newlines += __builtin_popcount(to_mask(eq(load_block(&source[i]), splat('\n'))));
+        i += SCAN_WIDTH;
+    }
+    return newlines + count_newlines_scalar(source, i, length);
+}
+
+#else // no vector path in this build, the scalar loops are the only path
+
+size_t scan_whitespace(const char* source, size_t i, size_t length)
+{
+    return scan_whitespace_scalar(source, i, length);
+}
+
+size_t scan_identifier(const char* source, size_t i, size_t length)
+{
+    return scan_identifier_scalar(source, i, length);
+}
+
+size_t scan_digits(const char* source, size_t i, size_t length)
+{
+    return scan_digits_scalar(source, i, length);
+}
+
+size_t scan_line_end(const char* source, size_t i, size_t length)
+{
+    return scan_line_end_scalar(source, i, length);
+}
+
+size_t count_newlines(const char* source, size_t i, size_t length)
+{
+    return count_newlines_scalar(source, i, length);
+}
+
+#endif
+
+const char* scan_backend_name(void)
+{
+#if SCAN_WIDTH == 32
+    return "avx2";
+#elif SCAN_WIDTH == 16
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
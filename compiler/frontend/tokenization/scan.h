@@ -0,0 +1,28 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include "utilities/utils.h"
+#include <stddef.h>
+
+// Each scanner starts at source[i] and returns the index of the first byte that does not belong to the run.
+// They never read at or past length, the vector paths fall back to the scalar loop for the tail.
+
+size_t scan_whitespace(const char* source, size_t i, size_t length);
+size_t scan_identifier(const char* source, size_t i, size_t length);
+size_t scan_digits(const char* source, size_t i, size_t length);
+size_t scan_line_end(const char* source, size_t i, size_t length);
+
+// number of '\n' bytes in source[i..length), only needed when a diagnostic has to name a line
+size_t count_newlines(const char* source, size_t i, size_t length);
+
+// byte at a time versions, used for the tails and for benchmarking against the vector paths
+size_t scan_whitespace_scalar(const char* source, size_t i, size_t length);
+size_t scan_identifier_scalar(const char* source, size_t i, size_t length);
+size_t scan_digits_scalar(const char* source, size_t i, size_t length);
+size_t scan_line_end_scalar(const char* source, size_t i, size_t length);
+size_t count_newlines_scalar(const char* source, size_t i, size_t length);
+
+// name of the vector path compiled in ("avx2", "sse2" or "scalar")
+const char* scan_backend_name(void);
+
+#endif
@@ -1,10 +1,16 @@
 #include "frontend/tokenization/tokenize.h"
+#include "frontend/tokenization/scan.h"
+#include "frontend/tokenization/keywords.h"
+#include "symbol_table/string_table.h"
 #include "utilities/utils.h"
 #include "arena/arena.h"
 #include "error_handler/error_handler.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 
 const uint8_t CHAR_TYPE[256] = {
     ['0'] = 11, ['1'] = 11, ['2'] = 11, ['3'] = 11, ['4'] = 11, 
@@ -28,380 +34,628 @@ const uint8_t CHAR_TYPE[256] = {
     ['&'] = 21, ['.'] = 22, ['['] = 23, [']'] = 24
 };
 
-static inline int identify_token(const char* value, size_t length, token* the_token, size_t* function_count){
-    switch (length){
+// appends one token, the caller has already checked it fits
+static inline void emit_token(token_stream* stream, TokenType type, size_t offset){
+    size_t slot = token_slot(stream, stream->count);
+    stream->types[slot] = (uint8_t)type;
+    stream->offsets[slot] = (uint32_t)offset;
+    stream->count++;
+}
 
-        case 6:
-            if (value[0] == 'r' && value[1] == 'e' && value[2] == 't' && value[3] == 'u' && value[4] == 'r' && value[5] == 'n') {
-                the_token->type = TOK_RETURN;
-                return 0;
-            }
-            break;
+// typical source averages 4 to 6 bytes per token, so file_length / 4 covers most files without growing
+#define SOURCE_BYTES_PER_TOKEN 4
 
-        case 5:
-            if (value[0] == 'w' && value[1] == 'h' && value[2] == 'i' && value[3] == 'l' && value[4] == 'e') {
-                the_token->type = TOK_WHILE;
-                return 0;
-            }
-            if (value[0] == 'b' && value[1] == 'r' && value[2] == 'e' && value[3] == 'a' && value[4] == 'k') {
-                the_token->type = TOK_BREAK;
-                return 0;
-            }
-            break;
+static void* resize_array(void* array, size_t size, Compiler* compiler){
+    void* resized = realloc(array, size);
+    if (!resized) panic(ERROR_MEMORY_ALLOCATION, "Not enough memory to grow the token stream", compiler);
+    return resized;
+}
 
-        case 4:
-            if (value[0] == 'e' && value[1] == 'x' && value[2] == 'i' && value[3] == 't') {
-                the_token->type = TOK_EXIT;
-                return 0;
-            }
-            if (value[0] == 'v' && value[1] == 'o' && value[2] == 'i' && value[3] == 'd') {
-                the_token->type = TOK_VOID;
-                return 0;
-            }
-            if (value[0] == 'e' && value[1] == 'l' &&  value[2] == 's' && value[3] == 'e')
-            {
-                the_token->type = TOK_ELSE;
-                return 0;
-            }
-            if (value[0] == 'l' && value[1] == 'o' &&  value[2] == 'n' && value[3] == 'g')
-            {
-                the_token->type = TOK_LONG;
-                return 0;
-            }
-            if (value[0] == 'v' && value[1] == 'o' &&  value[2] == 'i' && value[3] == 'd')
-            {
-                the_token->type = TOK_VOID;
-                return 0;
-            }
-        
-            
-            break;
-            
-        case 3:
-            if (value[0] == 'l' && value[1] == 'e' && value[2] == 't') {
-                the_token->type = TOK_LET;
-                return 1;
-            }
-            if (value[0] == 'i' && value[1] == 'n' && value[2] == 't') {
-                the_token->type = TOK_INT;
-                return 1;
-            }
-            break;
-            
-        case 2:
-            if (value[0] == 'f' && value[1] == 'n') {
-                *function_count += 1;
-                the_token->type = TOK_FN;
-                return 0;
-            }
-            if (value[0] == 'i' && value[1] == 'f')
-            {
-                the_token->type = TOK_IF;
-                return 0;
-            }
-            
-            break;
+// every loop iteration of tokenize() emits at most one token and one payload, this makes room for both
+// while always leaving a slot for TOK_EOF
+static inline void reserve_token(token_stream* stream, Compiler* compiler){
+    if (stream->count + 2 > stream->capacity) {
+        stream->capacity *= 2;
+        stream->types = resize_array(stream->types, sizeof(uint8_t) * stream->capacity, compiler);
+        stream->offsets = resize_array(stream->offsets, sizeof(uint32_t) * stream->capacity, compiler);
+    }
+    if (stream->payload_count + 1 > stream->payload_capacity) {
+        stream->payload_capacity *= 2;
+        stream->payloads = resize_array(stream->payloads, sizeof(token_payload) * stream->payload_capacity, compiler);
     }
-    the_token->type = TOK_IDENTIFIER;
-    return 0;
 }
 
-void tokenize(const char* source, Compiler* compiler, size_t* token_count, size_t* file_length, size_t* function_count){
-    token* tokens = arena_alloc(compiler->token_arena, sizeof(token) * (*file_length + 1), compiler);
+// appends a token with a payload, the token's offsets slot points at the payload, which keeps the offset.
+// a streaming window has one payload slot per token slot
+static inline token_payload* emit_payload_token(token_stream* stream, TokenType type, size_t offset){
+    size_t slot = token_slot(stream, stream->count);
+    size_t payload_index = stream->window ? slot : stream->payload_count++;
+    token_payload* payload = &stream->payloads[payload_index];
+    payload->token_index = (uint32_t)stream->count;
+    payload->offset = (uint32_t)offset;
+    stream->types[slot] = (uint8_t)type;
+    stream->offsets[slot] = (uint32_t)payload_index;
+    stream->count++;
+    return payload;
+}
 
-    *function_count = 0;
-    *token_count = 0;
-    size_t i = 0;
-    size_t line_number = 1;
-    while (i < *file_length) {
-        if (source[i] == '\0') break;
+size_t estimate_token_count(size_t file_length){
+    return file_length / SOURCE_BYTES_PER_TOKEN + 16;
+}
 
-        while (i < *file_length && CHAR_TYPE[(unsigned char)source[i]] == 3) {
-            if (source[i] == '\n') line_number++;
-            i++;
+static token_stream* make_token_stream(const char* source, size_t file_length, size_t capacity, size_t payload_capacity, Compiler* compiler){
+    if (file_length >= UINT32_MAX) {
+        panic(ERROR_UNDEFINED, "source file too large, token offsets are 32 bit", compiler);
+    }
+    token_stream* stream = arena_alloc(compiler->token_arena, sizeof(token_stream), compiler);
+    stream->source = source;
+    stream->source_length = file_length;
+    stream->capacity = capacity;
+    stream->payload_capacity = payload_capacity;
+    stream->types = malloc(sizeof(uint8_t) * stream->capacity);
+    stream->offsets = malloc(sizeof(uint32_t) * stream->capacity);
+    stream->payloads = malloc(sizeof(token_payload) * stream->payload_capacity);
+    if (!stream->types || !stream->offsets || !stream->payloads) {
+        panic(ERROR_MEMORY_ALLOCATION, "Token stream allocation failed", compiler);
+    }
+    stream->payload_count = 0;
+    stream->count = 0;
+    stream->function_count = 0;
+    stream->function_tokens = NULL;
+    stream->function_capacity = 0;
+    stream->strings = compiler->strings;
+    stream->compiler = compiler;
+    stream->failed = false;
+    stream->window = 0;
+    stream->cursor = 0;
+    stream->finished = false;
+    stream->line_starts = NULL;
+    stream->line_count = 0;
+    compiler->tokens = stream;
+    return stream;
+}
+
+// signature collection jumps straight to these instead of walking every token
+static inline void record_function(token_stream* stream, Compiler* compiler){
+    if (!stream->window) {
+        if (stream->function_count == stream->function_capacity) {
+            stream->function_capacity = stream->function_capacity ? stream->function_capacity * 2 : 64;
+            stream->function_tokens = resize_array(stream->function_tokens, sizeof(uint32_t) * stream->function_capacity, compiler);
         }
-        if (i >= *file_length) break;
-        
-        // Process token at position i
-        size_t token_start = i;
-        switch (CHAR_TYPE[(unsigned char)source[i]])
-        {
-        case 11: {
-            int int_part = source[i] - '0';
+        stream->function_tokens[stream->function_count] = (uint32_t)stream->count;
+    }
+    stream->function_count += 1;
+}
+
+// stops a tokenizer thread at its first bad character, the serial tokenizer reports it afterwards
+static size_t lex_failed(token_stream* stream){
+    stream->failed = true;
+    return stream->source_length;
+}
+
+// skips whitespace and comments from i and lexes at most one token, returns where the next one starts
+static inline size_t lex_step(token_stream* stream, size_t i, Compiler* compiler){
+    const char* source = stream->source;
+    size_t length = stream->source_length;
+
+    i = scan_whitespace(source, i, length);
+    if (i >= length) return i;
+    
+    // Process token at position i
+    size_t token_start = i;
+    switch (CHAR_TYPE[(unsigned char)source[i]])
+    {
+    case 11: {
+        size_t digits_end = scan_digits(source, i, length);
+        int int_part = 0;
+        while (i < digits_end) {
+            int_part = int_part * 10 + (source[i] - '0');
             i++;
-            while (i < *file_length && source[i] >= '0' && source[i] <= '9') {
-                int_part = int_part * 10 + (source[i] - '0');
+        }
+
+        if (i < length && source[i] == '.') {
+            i++; // consume '.'
+            double value = (double)int_part;
+            double factor = 0.1;
+            while (i < length && source[i] >= '0' && source[i] <= '9') {
+                value += (source[i] - '0') * factor;
+                factor *= 0.1;
                 i++;
             }
-
-            if (i < *file_length && source[i] == '.') {
-                i++; // consume '.'
-                double value = (double)int_part;
-                double factor = 0.1;
-                while (i < *file_length && source[i] >= '0' && source[i] <= '9') {
-                    value += (source[i] - '0') * factor;
-                    factor *= 0.1;
-                    i++;
-                }
-                tokens[*token_count].type = TOK_FLOAT;
-                tokens[*token_count].float_value = value;
-            } else {
-                tokens[*token_count].type = TOK_NUMBER;
-                tokens[*token_count].int_value = int_part;
+            emit_payload_token(stream, TOK_FLOAT, token_start)->float_value = value;
+        } else {
+            emit_payload_token(stream, TOK_NUMBER, token_start)->int_value = int_part;
+        }
+        break;
+    }
+    case 2:{
+        if (i + 1 < length && source[i + 1] == '=')
+            {
+                // It's '=='
+                emit_token(stream, TOK_EQ, token_start);
+                i += 2;  // Consume both '=' characters
             }
+        else {
+                // It's just '='
+                emit_token(stream, TOK_EQUAL, token_start);
+                i++;  // Consume one '=' character
+            }
+            break;
+    }
+
+    case 5:{
+        emit_token(stream, TOK_SUB, token_start);
+        i++;
+        break;
+    }
+
+    case 4:{
+        emit_token(stream, TOK_ADD, token_start);
+        i++;
+        break;
+    }
 
-            tokens[*token_count].line = line_number;
-            (*token_count)++;
+    case 6: {
+    
+        emit_token(stream, TOK_MUL, token_start);
+        i++;
+        break;
+    }
+    case 7: {
+        if (i + 1 < length && source[i + 1] == '/') {
+            i = scan_line_end(source, i + 2, length); // Skip both backslashes and the rest of the line
             break;
         }
-        case 2:{
-            if (i + 1 < *file_length && source[i + 1] == '=')
-                {
-                    // It's '=='
-                    tokens[*token_count].line = line_number;
-                    tokens[*token_count].type = TOK_EQ;
-                    (*token_count)++;
-                    i += 2;  // Consume both '=' characters
-                }
-            else {
-                    // It's just '='
-                    tokens[*token_count].line = line_number;
-                    tokens[*token_count].type = TOK_EQUAL;
-                    (*token_count)++;
-                    i++;  // Consume one '=' character
-                }
-                break;
+        emit_token(stream, TOK_DIV, token_start);
+        i++;
+        break;
+    }
+
+    case 8: {
+    
+        emit_token(stream, TOK_LPAREN, token_start); // LPAREN
+        i++;
+        break;
+    }
+    
+    case 9:{
+    
+        emit_token(stream, TOK_RPAREN, token_start); // RPAREN
+        i++;
+        break;
+    }
+
+    case 1 :{
+        // Identifiers can START only with letters or underscore
+        i = scan_identifier(source, i, length);
+        TokenType type = classify_identifier(&source[token_start], i - token_start);
+        if (type == TOK_FN) {
+            record_function(stream, compiler);
+        }
+        if (type == TOK_IDENTIFIER) {
+            token_payload* payload = emit_payload_token(stream, TOK_IDENTIFIER, token_start);
+            payload->symbol_id = intern_identifier(stream->strings, &source[token_start], i - token_start, compiler);
+            payload->length = (uint32_t)(i - token_start);
         }
+        else emit_token(stream, type, token_start);
+        break;
+    }
 
-        case 5:{
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_SUB;
-            (*token_count)++;
-            i++;
+    case 10:{
+    
+        emit_token(stream, TOK_SEMICOLON, token_start); // SEMICOLUMN
+        i++;
+        break;
+    }
+    case 13: {
+        emit_token(stream, TOK_COMMA, token_start); // COMMA
+        i++;
+        break;
+    }
+
+    case 14: {
+        emit_token(stream, TOK_LBRACE, token_start); // {
+        i++;
+        break;
+    }
+
+    case 15: {
+        emit_token(stream, TOK_RBRACE, token_start); // }
+        i++; 
+        break;
+    }
+
+    case 17: {
+        if (source[i + 1] == '=') { // <=
+            emit_token(stream, TOK_LE, token_start);
+            i+=2; 
             break;
         }
-
-        case 4:{
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_ADD;
-            (*token_count)++;
-            i++;
+        else {   // <
+            emit_token(stream, TOK_LT, token_start);
+            i++; 
             break;
         }
+    }
 
-        case 6: {
-        
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_MUL;
-            (*token_count)++;
-            i++;
+    case 18: {
+        if (source[i + 1] == '=') { // >=
+            emit_token(stream, TOK_GE, token_start);
+            i+=2; 
             break;
         }
-        case 7: {
-            if (i + 1 < *file_length && source[i + 1] == '/') {
-                i += 2;  // Skip both backslashes
-                while (i < *file_length && source[i] != '\n') {
-                    i++;
-                }
-                break;
-            }
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_DIV;
-            (*token_count)++;
-            i++;
+        else {   // >
+            emit_token(stream, TOK_GT, token_start);
+            i++; 
             break;
         }
+    }
 
-        case 8: {
-        
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_LPAREN; // LPAREN           
-            (*token_count)++;
-            i++;
+    case 19: {
+        if (source[i + 1] == '=') { // !=
+            emit_token(stream, TOK_NE, token_start);
+            i+=2; 
             break;
         }
-        
-        case 9:{
-        
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_RPAREN; // RPAREN            
-            (*token_count)++;
-            i++;
-            break;
+        else {   // ! only
+            if (!stream->compiler) return lex_failed(stream);
+            char buffer[100];
+            source_position position = token_position(stream, i);
+            snprintf(buffer, sizeof(buffer), "unidentified token at line %zu, column %zu '!', did you mean '!='", position.line, position.column);
+            panic(ERROR_UNDEFINED, buffer , compiler);
         }
+        break;
+    }
 
-        case 1 :{
-            // Identifiers can START only with letters or underscore
-            while (i < *file_length && (CHAR_TYPE[(unsigned char)source[i]] == 1 || (source[i] >= '0' && source[i] <= '9'))) {
-                i++;
-            }
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].str_value.starting_value = (char*)&source[token_start];
-            tokens[*token_count].str_value.length = i - token_start;
-            identify_token(tokens[*token_count].str_value.starting_value, tokens[*token_count].str_value.length, &tokens[*token_count], function_count);
+    case 20: {
+        emit_token(stream, TOK_PERCENT, token_start); // %
+        i++;
+        break;
+    }
 
-            (*token_count)++;
+    case 12:{
+        emit_token(stream, TOK_COLON, token_start); // :
+        i++;
+        break;
+    }
+    case 21:{
+        if (i + 1 < length && source[i + 1] == '&') { // &&
+            emit_token(stream, TOK_AND, token_start);
+            i+=2; 
             break;
         }
-
-        case 10:{
-        
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_SEMICOLON; // SEMICOLUMN            
-            (*token_count)++;
+        else {   // & only
+            emit_token(stream, TOK_BIT_AND, token_start); // &
             i++;
             break;
         }
-        case 13: {
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_COMMA; // COMMA            
-            (*token_count)++;
-            i++;
+        break;
+    }
+
+    case 22: {
+        if (i + 1 < length && source[i + 1] == '*') { // .*
+            emit_token(stream, TOK_POINTER_DEREF, token_start);
+            i+=2; 
             break;
         }
-
-        case 14: {
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_LBRACE; // {            
-            (*token_count)++;
+        else {   // & only
+            emit_token(stream, TOK_DOT, token_start); // .
             i++;
             break;
         }
+        break;
+    }
 
-        case 15: {
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_RBRACE; // }           
-            (*token_count)++;
-            i++; 
-            break;
-        }
+    case 23:{
+        emit_token(stream, TOK_LBRACKET, token_start); // [
+        i++;
+        break;
+    }
+    case 24:{
+        emit_token(stream, TOK_RBRACKET, token_start); // ]
+        i++;
+        break;
+    }
 
-        case 17: {
-            if (source[i + 1] == '=') { // <=
-                tokens[*token_count].line = line_number;
-                tokens[*token_count].type = TOK_LE;           
-                (*token_count)++;
-                i+=2; 
-                break;
-            }
-            else {   // <
-                tokens[*token_count].line = line_number;
-                tokens[*token_count].type = TOK_LT;           
-                (*token_count)++;
-                i++; 
-                break;
-            }
-        }
+    
 
-        case 18: {
-            if (source[i + 1] == '=') { // >=
-                tokens[*token_count].line = line_number;
-                tokens[*token_count].type = TOK_GE;           
-                (*token_count)++;
-                i+=2; 
-                break;
-            }
-            else {   // >
-                tokens[*token_count].line = line_number;
-                tokens[*token_count].type = TOK_GT;           
-                (*token_count)++;
-                i++; 
-                break;
-            }
-        }
+    default: {
+        if (!stream->compiler) return lex_failed(stream);
+        source_position position = token_position(stream, i);
+        printf("Error: Unrecognized character '%c' (ASCII %d) at line %zu, column %zu\n", 
+       source[i], source[i], position.line, position.column);
+        panic(ERROR_UNDEFINED, "unidentified token", compiler);
+    }
+    }
+    return i;
+}
 
-        case 19: {
-            if (source[i + 1] == '=') { // !=
-                tokens[*token_count].line = line_number;
-                tokens[*token_count].type = TOK_NE;           
-                (*token_count)++;
-                i+=2; 
-                break;
-            }
-            else {   // ! only
-                char buffer[100];
-                snprintf(buffer, sizeof(buffer), "unidentified token at line %lu '!', did you mean '!='", line_number);
-                panic(ERROR_UNDEFINED, buffer , compiler);
-            }
-            break;
-        }
+// below this much source per chunk a thread costs more to start than it saves
+#define PARALLEL_CHUNK_MIN (256 * 1024)
 
-        case 20: {
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_PERCENT;           // %
-            (*token_count)++;
-            i++;
-            break;
+// one slice of the source tokenized on its own thread, its token indexes, payload indexes and
+// symbol ids are local to the chunk until merge_chunks() renumbers them
+typedef struct
+{
+    token_stream stream; // source_length is the end of the chunk, offsets still index the whole source
+    size_t start;
+    Compiler compiler;   // the main compiler with the chunk's own recovery point, only for running out of memory
+    pthread_t thread;
+    bool on_thread;
+    jmp_buf recover;     // where a panic on the chunk's thread lands when the compile is recoverable
+} tokenize_chunk;
+
+static size_t tokenize_chunk_count(const char* source, size_t file_length, size_t threads){
+    size_t chunk_count = file_length / PARALLEL_CHUNK_MIN;
+    if (chunk_count > threads) chunk_count = threads;
+    // the serial tokenizer stops at a '\0', chunks after it would not
+    if (chunk_count < 2 || file_length >= UINT32_MAX || memchr(source, '\0', file_length)) return 1;
+    return chunk_count;
+}
+
+static void init_chunk(tokenize_chunk* chunk, const char* source, size_t start, size_t end, Compiler* compiler){
+    token_stream* stream = &chunk->stream;
+    stream->source = source;
+    stream->source_length = end;
+    stream->capacity = estimate_token_count(end - start);
+    stream->payload_capacity = stream->capacity / 2;
+    stream->types = malloc(sizeof(uint8_t) * stream->capacity);
+    stream->offsets = malloc(sizeof(uint32_t) * stream->capacity);
+    stream->payloads = malloc(sizeof(token_payload) * stream->payload_capacity);
+    if (!stream->types || !stream->offsets || !stream->payloads) {
+        panic(ERROR_MEMORY_ALLOCATION, "Token stream allocation failed", compiler);
+    }
+    stream->payload_count = 0;
+    stream->count = 0;
+    stream->function_count = 0;
+    stream->function_tokens = NULL;
+    stream->function_capacity = 0;
+    stream->strings = make_string_table(1024, compiler);
+    stream->compiler = NULL;
+    stream->failed = false;
+    stream->window = 0;
+    stream->line_starts = NULL;
+    chunk->start = start;
+    // a panic on another thread has no parser position to report and must not free the main compiler
+    chunk->compiler = *compiler;
+    chunk->compiler.parser = NULL;
+    chunk->compiler.parse_worker = true;
+    chunk->compiler.failure = 0;
+    chunk->on_thread = false;
+}
+
+static void* tokenize_chunk_worker(void* argument){
+    tokenize_chunk* chunk = argument;
+    token_stream* stream = &chunk->stream;
+    // a recoverable compile stops only this chunk, tokenize_parallel passes the error on once all are done
+    if (chunk->compiler.recover) {
+        chunk->compiler.recover = &chunk->recover;
+        if (setjmp(chunk->recover)) return NULL;
+    }
+    size_t i = chunk->start;
+    while (i < stream->source_length) {
+        reserve_token(stream, &chunk->compiler);
+        i = lex_step(stream, i, &chunk->compiler);
+    }
+    return NULL;
+}
+
+static void free_chunk(tokenize_chunk* chunk){
+    free(chunk->stream.types);
+    free(chunk->stream.offsets);
+    free(chunk->stream.payloads);
+    free(chunk->stream.function_tokens);
+    free_string_table(chunk->stream.strings);
+}
+
+// concatenates the chunks in source order. names are interned chunk by chunk in the order each chunk first
+// saw them, which is the order the serial tokenizer meets them, so every symbol id comes out the same
+static token_stream* merge_chunks(tokenize_chunk* chunks, size_t chunk_count, const char* source, size_t file_length, Compiler* compiler){
+    size_t token_total = 0, payload_total = 0, function_total = 0;
+    for (size_t c = 0; c < chunk_count; c++) {
+        token_total += chunks[c].stream.count;
+        payload_total += chunks[c].stream.payload_count;
+        function_total += chunks[c].stream.function_count;
+    }
+    token_stream* stream = make_token_stream(source, file_length, token_total + 1, payload_total + 1, compiler);
+    stream->function_capacity = function_total + 1;
+    stream->function_tokens = malloc(sizeof(uint32_t) * stream->function_capacity);
+    if (!stream->function_tokens) panic(ERROR_MEMORY_ALLOCATION, "Token stream allocation failed", compiler);
+
+    for (size_t c = 0; c < chunk_count; c++) {
+        token_stream* chunk = &chunks[c].stream;
+        memcpy(&stream->types[stream->count], chunk->types, sizeof(uint8_t) * chunk->count);
+        memcpy(&stream->offsets[stream->count], chunk->offsets, sizeof(uint32_t) * chunk->count);
+
+        uint32_t* symbol_ids = malloc(sizeof(uint32_t) * (chunk->strings->count + 1));
+        if (!symbol_ids) panic(ERROR_MEMORY_ALLOCATION, "Token stream allocation failed", compiler);
+        for (uint32_t id = 0; id < chunk->strings->count; id++) {
+            symbol_ids[id] = intern_hashed_identifier(compiler->strings, chunk->strings->names[id], chunk->strings->name_lengths[id], chunk->strings->name_hashes[id], compiler);
         }
 
-        case 12:{
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_COLON;           // :
-            (*token_count)++;
-            i++;
-            break;
+        for (size_t p = 0; p < chunk->payload_count; p++) {
+            token_payload payload = chunk->payloads[p];
+            if (chunk->types[payload.token_index] == TOK_IDENTIFIER) payload.symbol_id = symbol_ids[payload.symbol_id];
+            payload.token_index += (uint32_t)stream->count;
+            stream->offsets[payload.token_index] = (uint32_t)stream->payload_count;
+            stream->payloads[stream->payload_count++] = payload;
         }
-        case 21:{
-            if (i + 1 < *file_length && source[i + 1] == '&') { // &&
-                tokens[*token_count].line = line_number;
-                tokens[*token_count].type = TOK_AND;           
-                (*token_count)++;
-                i+=2; 
-                break;
-            }
-            else {   // & only
-                tokens[*token_count].line = line_number;
-                tokens[*token_count].type = TOK_BIT_AND;           // &
-                (*token_count)++;
-                i++;
-                break;
-            }
-            break;
+        for (size_t f = 0; f < chunk->function_count; f++) {
+            stream->function_tokens[stream->function_count++] = chunk->function_tokens[f] + (uint32_t)stream->count;
         }
+        stream->count += chunk->count;
+        free(symbol_ids);
+    }
+    return stream;
+}
 
-        case 22: {
-            if (i + 1 < *file_length && source[i + 1] == '*') { // .*
-                tokens[*token_count].line = line_number;
-                tokens[*token_count].type = TOK_POINTER_DEREF;           
-                (*token_count)++;
-                i+=2; 
-                break;
-            }
-            else {   // & only
-                tokens[*token_count].line = line_number;
-                tokens[*token_count].type = TOK_DOT;           // .
-                (*token_count)++;
-                i++;
-                break;
-            }
-            break;
+// splits the source after newlines, no token or comment crosses one, so every chunk lexes exactly like
+// the serial tokenizer would at that point. NULL if a chunk hit a lexing error
+static token_stream* tokenize_parallel(const char* source, Compiler* compiler, size_t file_length, size_t chunk_count){
+    tokenize_chunk* chunks = malloc(sizeof(tokenize_chunk) * chunk_count);
+    if (!chunks) panic(ERROR_MEMORY_ALLOCATION, "Token stream allocation failed", compiler);
+
+    size_t start = 0;
+    for (size_t c = 0; c < chunk_count; c++) {
+        size_t end = file_length;
+        if (c + 1 < chunk_count) {
+            size_t target = file_length / chunk_count * (c + 1);
+            if (target < start) target = start;
+            const char* newline = memchr(&source[target], '\n', file_length - target);
+            end = newline ? (size_t)(newline - source) + 1 : file_length;
         }
+        init_chunk(&chunks[c], source, start, end, compiler);
+        start = end;
+    }
 
-        case 23:{
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_LBRACKET;           // [
-            (*token_count)++;
-            i++;
-            break;
+    // the first chunk runs on this thread, a chunk whose thread could not start runs here too
+    for (size_t c = 1; c < chunk_count; c++) {
+        chunks[c].on_thread = pthread_create(&chunks[c].thread, NULL, tokenize_chunk_worker, &chunks[c]) == 0;
+    }
+    tokenize_chunk_worker(&chunks[0]);
+    for (size_t c = 1; c < chunk_count; c++) {
+        if (chunks[c].on_thread) pthread_join(chunks[c].thread, NULL);
+        else tokenize_chunk_worker(&chunks[c]);
+    }
+
+    bool failed = false;
+    error_code failure = 0;
+    for (size_t c = 0; c < chunk_count; c++) {
+        failed |= chunks[c].stream.failed;
+        if (!failure) failure = chunks[c].compiler.failure;
+    }
+    token_stream* stream = failed || failure ? NULL : merge_chunks(chunks, chunk_count, source, file_length, compiler);
+
+    for (size_t c = 0; c < chunk_count; c++) free_chunk(&chunks[c]);
+    free(chunks);
+    if (failure) stop_compilation(failure, compiler);
+    if (stream) emit_token(stream, TOK_EOF, file_length); // end of file
+    return stream;
+}
+
+token_stream* tokenize(const char* source, Compiler* compiler, size_t* token_count, size_t* file_length, size_t* function_count){
+    size_t chunk_count = tokenize_chunk_count(source, *file_length, compiler->threads);
+    if (chunk_count > 1) {
+        token_stream* stream = tokenize_parallel(source, compiler, *file_length, chunk_count);
+        if (stream) {
+            *token_count = stream->count;
+            *function_count = stream->function_count;
+            return stream;
         }
-        case 24:{
-            tokens[*token_count].line = line_number;
-            tokens[*token_count].type = TOK_RBRACKET;           // ]
-            (*token_count)++;
-            i++;
-            break;
+        // a chunk hit a bad character, the serial pass below reports the first one in the file
+    }
+
+    size_t capacity = estimate_token_count(*file_length);
+    token_stream* stream = make_token_stream(source, *file_length, capacity, capacity / 2, compiler);
+
+    size_t i = 0;
+    while (i < *file_length) {
+        if (source[i] == '\0') break;
+        reserve_token(stream, compiler);
+        i = lex_step(stream, i, compiler);
+    }
+
+    emit_token(stream, TOK_EOF, i < *file_length ? i : *file_length); // end of file
+    *token_count = stream->count;
+    *function_count = stream->function_count;
+    return stream;
+}
+
+// the parser never looks more than two tokens past the one it is on, the rest of the window is slack
+#define TOKEN_WINDOW 64
+
+token_stream* open_token_stream(const char* source, size_t file_length, Compiler* compiler){
+    token_stream* stream = make_token_stream(source, file_length, TOKEN_WINDOW, TOKEN_WINDOW, compiler);
+    stream->window = TOKEN_WINDOW;
+    return stream;
+}
+
+void rewind_token_stream(token_stream* stream){
+    // a whole-file stream still holds every token
+    if (!stream->window) return;
+    stream->count = 0;
+    stream->cursor = 0;
+    stream->finished = false;
+    stream->function_count = 0;
+}
+
+bool fill_token_window(token_stream* stream, size_t index, size_t oldest){
+    if (index >= oldest + stream->window) {
+        panic(ERROR_INTERNAL, "parser looked further ahead than the token window", stream->compiler);
+    }
+    while (stream->count <= index && !stream->finished) {
+        if (stream->cursor < stream->source_length && stream->source[stream->cursor] != '\0') {
+            stream->cursor = lex_step(stream, stream->cursor, stream->compiler);
+        }
+        else {
+            emit_token(stream, TOK_EOF, stream->cursor < stream->source_length ? stream->cursor : stream->source_length);
+            stream->finished = true;
         }
+    }
+    return stream->count > index;
+}
 
-        
+token token_at(const token_stream* stream, size_t index){
+    size_t slot = token_slot(stream, index);
+    token result;
+    result.type = (TokenType)stream->types[slot];
+    result.symbol_id = 0;
 
-        default: {
-            printf("Error: Unrecognized character '%c' (ASCII %d) at line %zu, position %zu\n", 
-           source[i], source[i], line_number, i);
-            panic(ERROR_UNDEFINED, "unidentified token", compiler);
+    if (token_has_payload(result.type)) {
+        const token_payload* payload = &stream->payloads[stream->offsets[slot]];
+        result.offset = payload->offset;
+        if (result.type == TOK_NUMBER) result.int_value = payload->int_value;
+        else if (result.type == TOK_FLOAT) result.float_value = payload->float_value;
+        else {
+            result.symbol_id = payload->symbol_id;
+            result.str_value.starting_value = (char*)&stream->source[payload->offset];
+            result.str_value.length = payload->length;
         }
-    }}
+        return result;
+    }
 
-    tokens[*token_count].line = line_number;
-    tokens[*token_count].type = TOK_EOF; // end of file            
-    (*token_count)++;
-}
\ No newline at end of file
+    size_t offset = stream->offsets[slot];
+    result.offset = (uint32_t)offset;
+    result.str_value.starting_value = (char*)&stream->source[offset];
+    // keywords are the only other tokens that start with a letter
+    result.str_value.length = CHAR_TYPE[(unsigned char)stream->source[offset]] == 1
+        ? scan_identifier(stream->source, offset, stream->source_length) - offset
+        : 0;
+    return result;
+}
+
+// one pass to count the lines so the index is allocated once, then one scan_line_end per line
+static bool build_line_index(token_stream* stream){
+    size_t line_count = count_newlines(stream->source, 0, stream->source_length) + 1;
+    uint32_t* line_starts = malloc(line_count * sizeof(uint32_t));
+    if (!line_starts) return false;
+
+    line_starts[0] = 0;
+    size_t i = 0;
+    for (size_t line = 1; line < line_count; line++) {
+        i = scan_line_end(stream->source, i, stream->source_length) + 1;
+        line_starts[line] = (uint32_t)i;
+    }
+    stream->line_starts = line_starts;
+    stream->line_count = line_count;
+    return true;
+}
+
+source_position token_position(token_stream* stream, size_t offset){
+    if (offset > stream->source_length) offset = stream->source_length;
+    if (!stream->line_starts && !build_line_index(stream)) {
+        // no memory for the index, count up to the offset instead
+        size_t line_start = offset;
+        while (line_start > 0 && stream->source[line_start - 1] != '\n') line_start--;
+        return (source_position){ count_newlines(stream->source, 0, offset) + 1, offset - line_start + 1 };
+    }
+
+    // last line starting at or before offset
+    size_t low = 0, high = stream->line_count;
+    while (high - low > 1) {
+        size_t middle = low + (high - low) / 2;
+        if (stream->line_starts[middle] <= offset) low = middle;
+        else high = middle;
+    }
+    return (source_position){ low + 1, offset - stream->line_starts[low] + 1 };
+}
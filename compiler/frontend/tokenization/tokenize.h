@@ -7,7 +7,40 @@
 
 extern const uint8_t CHAR_TYPE[256];
 
-void tokenize(const char* source, Compiler* compiler, size_t* token_count, size_t* file_length, size_t* function_count);
+token_stream* tokenize(const char* source, Compiler* compiler, size_t* token_count, size_t* file_length, size_t* function_count);
+
+// rough token count of a source file, used to size storage before the real count is known
+size_t estimate_token_count(size_t file_length);
+
+// streaming mode: tokens are lexed only when the parser reaches them and only the last few are kept
+token_stream* open_token_stream(const char* source, size_t file_length, Compiler* compiler);
+// starts a streaming token_stream over from the first token
+void rewind_token_stream(token_stream* stream);
+// lexes until token index exists, false if the source ends first,
+// tokens before oldest may be dropped to make room
+bool fill_token_window(token_stream* stream, size_t index, size_t oldest);
+
+// array slot holding token index
+static inline size_t token_slot(const token_stream* stream, size_t index){
+    return stream->window ? index & (stream->window - 1) : index;
+}
+
+static inline bool token_has_payload(TokenType type){
+    return type == TOK_IDENTIFIER || type == TOK_NUMBER || type == TOK_FLOAT;
+}
+
+// byte offset of token index in the source
+static inline uint32_t token_offset(const token_stream* stream, size_t index){
+    size_t slot = token_slot(stream, index);
+    uint32_t offset = stream->offsets[slot];
+    return token_has_payload((TokenType)stream->types[slot]) ? stream->payloads[offset].offset : offset;
+}
+
+// rebuilds the full token at index from the stream's arrays
+token token_at(const token_stream* stream, size_t index);
+
+// line and column of a source offset, the first call builds the stream's line index
+source_position token_position(token_stream* stream, size_t offset);
 
 #endif
 
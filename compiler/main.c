@@ -1,121 +1,87 @@
 #include "utilities/utils.h"
 #include "arena/arena.h"
-#include "error_handler/error_handler.h"
-#include "frontend/parsing/parsing.h"
-#include "frontend/tokenization/tokenize.h"
-#include "frontend/parsing/parsing.h"
-#include "backend/assembly_generator/x86_64/x86_64.h"
+#include "driver/compile.h"
+#include "driver/server.h"
+#include "driver/batch.h"
 #include <stdio.h>
+#include <unistd.h>
 
 
 int main(int argc, char** argv) { 
     // test
     clock_t start = clock();
-    // parameter checker for ./phc <filename>
-    if (argc != 4) {
-        printf("Usage: %s <file.ph> <architecture> <output program name>\n", argv[0]);
-        return 1;
+    // parameter checker for ./phc <filename>, options can go anywhere
+    compile_options options = { 0 };
+    const char* serve_socket = NULL;
+    const char* connect_socket = NULL;
+    const char* architecture = "x86_64";
+    bool batch = false;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    // a batch takes any number of inputs, a single compile exactly three
+    char* args[argc];
+    int arg_count = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mem-report") == 0) options.mem_report = true;
+        else if (strcmp(argv[i], "--mem-report-json") == 0 && i + 1 < argc) options.mem_report_json = argv[++i];
+        else if (strcmp(argv[i], "--stream") == 0) options.stream_tokens = true;
+        else if (strcmp(argv[i], "--parallel-parse") == 0) options.parallel_parse = true;
+        else if (strcmp(argv[i], "--reserve-arenas") == 0) options.arenas = ARENA_RESERVED;
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) threads = strtol(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) serve_socket = argv[++i];
+        else if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc) connect_socket = argv[++i];
+        else if (strcmp(argv[i], "--arch") == 0 && i + 1 < argc) architecture = argv[++i];
+        else if (strcmp(argv[i], "--batch") == 0) batch = true;
+        else args[arg_count++] = argv[i];
     }
-    
-    //read file
-    size_t* file_length = malloc(sizeof(size_t));
-    char* source = readfile(argv[1], file_length);
-    
-    
-    //initialize compiler arenas
-    Compiler* compiler = init_compiler_arenas(*file_length);
-    // tokenize
-    size_t* token_count = malloc(sizeof(size_t));
-    size_t* function_count = malloc(sizeof(size_t));
-
-    
-    tokenize(source, compiler, token_count, file_length, function_count);
-    if (*token_count == 0) {
-        panic(ERROR_INTERNAL, "ERROR: No tokens created! Check your tokenizer.", compiler);
-    }
-    
-    //create parser
-    Parser* parser = make_parser(compiler);
-    compiler->parser = parser;
-    parser->tokens = (token*)compiler->token_arena->data;
-    parser->token_count = *token_count;
-    // Abstract Syntax Tree
-    AST* ast = arena_alloc(compiler->statements_arena, sizeof(AST), compiler);
-
-    compiler->ast = ast;
-    ast->nodes = arena_alloc(compiler->statements_arena, sizeof(node*) * *token_count, compiler);  // Allocate pointer array
-    
-    ast->function_nodes = arena_alloc(compiler->statements_arena, (sizeof(node*) * (*function_count + 20)), compiler);  // Allocate pointer array
-    ast->node_count = 0;
-    ast->function_node_count = 0;
-    ast->parser = parser;
-    // First pass
-    while (parser->current < (*token_count - 1)) {
-        if (peek(parser, 0)->type == TOK_FN) {
-            ast->function_nodes[ast->function_node_count++] = parse_function_node(compiler, parser);
-        }
-        else {
-            advance(parser);
+    if (batch && !serve_socket && !connect_socket && arg_count > 0) {
+        // a .qk argument is a program, anything else a list of them
+        batch_list programs = { 0 };
+        for (int i = 0; i < arg_count; i++) {
+            size_t length = strlen(args[i]);
+            if (length > 3 && strcmp(args[i] + length - 3, ".qk") == 0) add_batch_source(&programs, args[i], NULL);
+            else if (!add_batch_list(&programs, args[i])) {
+                free_batch_list(&programs);
+                return 1;
+            }
         }
+        int status = compile_batch(&programs, architecture, threads > 0 ? (size_t)threads : 1, &options);
+        free_batch_list(&programs);
+        return status;
     }
-    // reset parser
-    compiler->parser->current = 0;
-
-    // parse code
-    while (parser->current < *token_count - 1) {
-        node* parsed_node = parse_statement(compiler, parser);
-        if (parsed_node != NULL) {
-            ast->nodes[ast->node_count++] = parsed_node;
-        }
-
-        if (peek(parser, 0)->type == TOK_SEMICOLON)
-        {
-            advance(parser);
-        }
+    if (serve_socket && arg_count == 0) {
+        return serve(serve_socket, threads > 0 ? (size_t)threads : 1, &options);
     }
-    
-    if (ast->nodes == NULL) {
-        panic(ERROR_INTERNAL, "ERROR: AST creation failed!", compiler);
+    if (serve_socket || batch || arg_count != 3) {
+        printf("Usage: %s [--mem-report] [--mem-report-json <file>] [--stream] [--threads N] [--parallel-parse] [--reserve-arenas] [--connect <socket>] <file.ph> <architecture> <output program name>\n", argv[0]);
+        printf("       %s [--mem-report] [--mem-report-json <file>] [--stream] [--threads N] [--parallel-parse] [--reserve-arenas] --serve <socket>\n", argv[0]);
+        printf("       %s [--mem-report] [--mem-report-json <file>] [--stream] [--threads N] [--parallel-parse] [--reserve-arenas] [--arch <architecture>] --batch <list file | file.qk>...\n", argv[0]);
+        return 1;
     }
-
-    // create output file
-    FILE* output = fopen("output.asm", "wb");
-    if(!output) {
-        panic(ERROR_INTERNAL, "Failed to create output file", compiler);
+    if (connect_socket) {
+        return request_compile(connect_socket, args[0], args[1], args[2]);
     }
-
-    // generate code
-    if (strncmp("x86_64", argv[2], 6) == 0) {
-        generate_assembly_x86_64 ((const AST*)ast, compiler, output, argv[3]);
-        /*else if (strcasecmp("arm64", argv[2]) == 0) {
-        generate_assembly_arm_64 ((const AST*)ast, compiler);
-        }*/
-    } else
-    {
-        panic(ERROR_UNDEFINED, "undefined system architecture, currently supporting x86_64 only", compiler);
+    
+    //read file
+    source_file file;
+    if (!readfile(args[0], &file)) {
+        return 1;
     }
+    
+    //initialize compiler arenas
+    Compiler* compiler = init_compiler_arenas(options.arenas);
+    compiler->threads = threads > 0 ? (size_t)threads : 1;
+    compile_source(compiler, &file, args[1], args[2], &options);
 
     // terminate program and free memory
-    free(source);
-    free(token_count);
-    free(file_length);
+    close_source_file(&file);
     free_global_arenas(compiler);
     
     clock_t end = clock();
 
-    char command[512];
-    // build the command string
-    // nasm -f elf64 output.asm && ld output.o -o output
-    snprintf(command, sizeof(command),  "nasm -f elf64 %s.asm && ld %s.o -o %s", argv[3], argv[3], argv[3]);
-
     double time_spent = ((double)(end - start)) / CLOCKS_PER_SEC;
     
     printf("Code compiled in %.6f seconds\n", time_spent);
     printf("Compilation Successful\n");
-    int result = system(command);
-
-    if (result != 0) {
-        fprintf(stderr, "Assembling or linking failed.\n");
-    }
+    link_program(args[2]);
     return 0;
 }
@@ -4,7 +4,8 @@
 # Compiler Test Suite
 # ============================================
 
-COMPILER="./quark"
+COMPILER="${COMPILER:-./quark}"
+COMPILER_FLAGS=""
 GREEN='\033[0;32m'
 RED='\033[0;31m'
 YELLOW='\033[1;33m'
@@ -49,7 +50,7 @@ run_test() {
     echo "$code" > "$temp_file"
     TEMP_FILES+=("$temp_file")
 
-    "$COMPILER" "$temp_file" x86_64 output >/dev/null 2>&1
+    "$COMPILER" $COMPILER_FLAGS "$temp_file" x86_64 output >/dev/null 2>&1
     local compile_status=$?
 
     if [ $compile_status -ne 0 ]; then
@@ -152,6 +153,17 @@ run_test "1.6" "Modulo operator" \
  " \
 2
 
+run_test "1.7" "Identifiers that start with keywords" \
+"fn main(void): int {
+    let format :int = 3;
+    let iffy :int = 4;
+    let doubled :int = 5;
+    let nullable :int = format + iffy;
+    return nullable + doubled;
+}
+ " \
+12
+
 # ============================================
 # Comparison Operators
 # ============================================
@@ -521,6 +533,22 @@ fn main(void): int {
  " \
 42
 
+run_test "5.8" "Functions between top-level statements" \
+"fn twice(x: int): int {
+    let y :int = x * 2;
+    return y;
+}
+let base :int = 3;
+if (base > 2) {
+    let step :int = 1;
+    base = base + step;
+}
+fn main(void): int {
+    return twice(4) + 1;
+}
+ " \
+9
+
 # ============================================
 # Mixed Features
 # ============================================
@@ -679,8 +707,8 @@ run_test "8.2" "Multiple comparisons accumulate" \
 
 run_test "8.3" "Function chaining" \
 "fn inc(x: int): int { return x + 1; }
-fn double(x: int): int { return x * 2; }
-fn process(x: int): int { return double(inc(x)); }
+fn twice(x: int): int { return x * 2; }
+fn process(x: int): int { return twice(inc(x)); }
 fn main(void): int {
     return process(5);
 }
@@ -1181,6 +1209,179 @@ run_test "13.10" "3D array indexing" \
 }" \
 8
 
+# ============================================
+# Compile Server
+# ============================================
+print_header "Compile Server"
+
+SERVER_SOCKET=$(mktemp -u /tmp/quark_test_XXXXXX.sock)
+"$COMPILER" --serve "$SERVER_SOCKET" >/dev/null 2>&1 &
+SERVER_PID=$!
+for attempt in $(seq 50); do
+    [ -S "$SERVER_SOCKET" ] && break
+    sleep 0.1
+done
+COMPILER_FLAGS="--connect $SERVER_SOCKET"
+
+run_test "14.1" "Compile through the server" \
+"fn factorial(n: int): int {
+    if (n <= 1) { return 1; }
+    return n * factorial(n - 1);
+}
+fn main(void): int {
+    return factorial(5);
+}
+exit main();" \
+120
+
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+print_test "14.2" "Server reports a compile error"
+bad_file=$(mktemp /tmp/test_XXXXXX.qk)
+TEMP_FILES+=("$bad_file")
+echo "fn main(void): int {
+    let x :int = ;
+}" > "$bad_file"
+if "$COMPILER" $COMPILER_FLAGS "$bad_file" x86_64 output >/dev/null 2>&1; then
+    echo -e "${RED}FAIL (compiled)${NC}"
+    FAILED_TESTS=$((FAILED_TESTS + 1))
+else
+    echo -e "${GREEN}PASS (rejected)${NC}"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+fi
+
+run_test "14.3" "Server keeps serving after an error" \
+"fn main(void): int {
+    let x :int = 3;
+    let y :int = 4;
+    return x + y;
+}
+exit main();" \
+7
+
+# integer literals once took their type from whatever the reused arenas held, a fresh process saw zeroes
+run_test "14.4" "Literals keep their type in a reused compiler" \
+"fn scale(n: int): int {
+    return n * 3 + 1;
+}
+fn main(void): int {
+    let big :long = 40;
+    let x :int = scale(2 + 2) - 1;
+    let y :int = big - 40 + x;
+    return y;
+}
+exit main();" \
+12
+
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+print_test "14.5" "Paths with spaces through the server"
+space_dir=$(mktemp -d "/tmp/quark test XXXXXX")
+echo "fn main(void): int {
+    return 9;
+}
+exit main();" > "$space_dir/nine lives.qk"
+"$COMPILER" $COMPILER_FLAGS "$space_dir/nine lives.qk" x86_64 "$space_dir/nine lives" >/dev/null 2>&1
+space_status=$?
+"$space_dir/nine lives" >/dev/null 2>&1
+space_exit=$?
+if [ $space_status -eq 0 ] && [ $space_exit -eq 9 ]; then
+    echo -e "${GREEN}PASS (exit $space_exit)${NC}"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    echo -e "${RED}FAIL (compile $space_status, exit $space_exit)${NC}"
+    FAILED_TESTS=$((FAILED_TESTS + 1))
+fi
+rm -rf "$space_dir"
+
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+print_test "14.6" "Server reports a failed link"
+link_dir=$(mktemp -d /tmp/quark_link_XXXXXX)
+echo "fn main(void): int {
+    return 3;
+}
+exit main();" > "$link_dir/three.qk"
+# a directory where the binary should go, the assembly is written but ld can't create the output
+mkdir "$link_dir/three"
+if "$COMPILER" $COMPILER_FLAGS "$link_dir/three.qk" x86_64 "$link_dir/three" >/dev/null 2>&1; then
+    echo -e "${RED}FAIL (reported success)${NC}"
+    FAILED_TESTS=$((FAILED_TESTS + 1))
+else
+    echo -e "${GREEN}PASS (rejected)${NC}"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+fi
+rm -rf "$link_dir"
+
+COMPILER_FLAGS=""
+kill "$SERVER_PID"
+wait "$SERVER_PID" 2>/dev/null
+
+# ============================================
+# Batch Compilation
+# ============================================
+print_header "Batch Compilation"
+
+batch_dir=$(mktemp -d /tmp/quark_batch_XXXXXX)
+echo "fn main(void): int {
+    return 7;
+}
+exit main();" > "$batch_dir/seven.qk"
+echo "fn factorial(n: int): int {
+    if (n <= 1) { return 1; }
+    return n * factorial(n - 1);
+}
+exit factorial(5);" > "$batch_dir/factorial.qk"
+echo "fn main(void): int {
+    let x :int = ;
+}" > "$batch_dir/broken.qk"
+printf '# programs of the batch test\n%s\n%s %s\n' "$batch_dir/seven.qk" "$batch_dir/factorial.qk" "$batch_dir/fact" > "$batch_dir/list.txt"
+
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+print_test "15.1" "Batch builds every program of a list"
+"$COMPILER" --threads 2 --batch "$batch_dir/list.txt" >/dev/null 2>&1
+batch_status=$?
+"$batch_dir/seven" >/dev/null 2>&1
+seven_exit=$?
+"$batch_dir/fact" >/dev/null 2>&1
+fact_exit=$?
+if [ $batch_status -eq 0 ] && [ $seven_exit -eq 7 ] && [ $fact_exit -eq 120 ]; then
+    echo -e "${GREEN}PASS (exits 7 and 120)${NC}"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+else
+    echo -e "${RED}FAIL (batch $batch_status, exits $seven_exit and $fact_exit)${NC}"
+    FAILED_TESTS=$((FAILED_TESTS + 1))
+fi
+
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+print_test "15.2" "A broken program fails the batch but not the others"
+rm -f "$batch_dir/seven"
+if "$COMPILER" --batch "$batch_dir/broken.qk" "$batch_dir/seven.qk" >/dev/null 2>&1; then
+    echo -e "${RED}FAIL (batch succeeded)${NC}"
+    FAILED_TESTS=$((FAILED_TESTS + 1))
+else
+    "$batch_dir/seven" >/dev/null 2>&1
+    seven_exit=$?
+    if [ $seven_exit -eq 7 ]; then
+        echo -e "${GREEN}PASS (rejected, neighbour built)${NC}"
+        PASSED_TESTS=$((PASSED_TESTS + 1))
+    else
+        echo -e "${RED}FAIL (neighbour exited $seven_exit)${NC}"
+        FAILED_TESTS=$((FAILED_TESTS + 1))
+    fi
+fi
+
+TOTAL_TESTS=$((TOTAL_TESTS + 1))
+print_test "15.3" "A program that compiles but can't be linked fails the batch"
+# a directory where the binary should go, the assembly is written but ld can't create the output
+mkdir "$batch_dir/blocked"
+printf '%s\n%s %s\n' "$batch_dir/seven.qk" "$batch_dir/factorial.qk" "$batch_dir/blocked" > "$batch_dir/unlinked.txt"
+if "$COMPILER" --batch "$batch_dir/unlinked.txt" >/dev/null 2>&1; then
+    echo -e "${RED}FAIL (batch succeeded)${NC}"
+    FAILED_TESTS=$((FAILED_TESTS + 1))
+else
+    echo -e "${GREEN}PASS (rejected)${NC}"
+    PASSED_TESTS=$((PASSED_TESTS + 1))
+fi
+rm -rf "$batch_dir"
+
 
 # ============================================
 # Summary
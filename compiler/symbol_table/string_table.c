@@ -0,0 +1,98 @@
+#include "utilities/utils.h"
+#include "symbol_table/string_table.h"
+#include "symbol_table/symbol_table.h"
+#include "error_handler/error_handler.h"
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+static uint32_t* make_slots(uint32_t slot_count, Compiler* compiler) {
+    uint32_t* slots = calloc(slot_count, sizeof(uint32_t));
+    if (!slots) panic(ERROR_MEMORY_ALLOCATION, "string table allocation failed", compiler);
+    return slots;
+}
+
+string_table* make_string_table(size_t expected_names, Compiler* compiler) {
+    string_table* table = malloc(sizeof(string_table));
+    if (!table) panic(ERROR_MEMORY_ALLOCATION, "string table allocation failed", compiler);
+
+    table->capacity = expected_names < 64 ? 64 : (uint32_t)expected_names;
+    table->count = 0;
+    table->names = malloc(table->capacity * sizeof(char*));
+    table->name_lengths = malloc(table->capacity * sizeof(uint32_t));
+    table->name_hashes = malloc(table->capacity * sizeof(uint32_t));
+    if (!table->names || !table->name_lengths || !table->name_hashes) panic(ERROR_MEMORY_ALLOCATION, "string table allocation failed", compiler);
+
+    // keep the slots at most half full
+    uint32_t slot_count = 128;
+    while (slot_count < table->capacity * 2) slot_count *= 2;
+    table->slots = make_slots(slot_count, compiler);
+    table->slot_mask = slot_count - 1;
+    return table;
+}
+
+void free_string_table(string_table* table) {
+    free(table->names);
+    free(table->name_lengths);
+    free(table->name_hashes);
+    free(table->slots);
+    free(table);
+}
+
+// forgets every name but keeps the memory, for a compiler that goes on to its next program
+void reset_string_table(string_table* table) {
+    table->count = 0;
+    memset(table->slots, 0, (table->slot_mask + 1) * sizeof(uint32_t));
+}
+
+static void grow_string_table(string_table* table, Compiler* compiler) {
+    table->capacity *= 2;
+    const char** names = realloc(table->names, table->capacity * sizeof(char*));
+    if (names) table->names = names;
+    uint32_t* name_lengths = realloc(table->name_lengths, table->capacity * sizeof(uint32_t));
+    if (name_lengths) table->name_lengths = name_lengths;
+    uint32_t* name_hashes = realloc(table->name_hashes, table->capacity * sizeof(uint32_t));
+    if (name_hashes) table->name_hashes = name_hashes;
+    if (!names || !name_lengths || !name_hashes) panic(ERROR_MEMORY_ALLOCATION, "too many identifiers, string table out of memory", compiler);
+
+    // reinsert every name into a table twice the size, the hashes are kept so nothing is rehashed
+    uint32_t slot_count = (table->slot_mask + 1) * 2;
+    free(table->slots);
+    table->slots = make_slots(slot_count, compiler);
+    table->slot_mask = slot_count - 1;
+    for (uint32_t id = 0; id < table->count; id++) {
+        size_t slot = table->name_hashes[id] & table->slot_mask;
+        while (table->slots[slot] != 0) slot = (slot + 1) & table->slot_mask;
+        table->slots[slot] = id + 1;
+    }
+}
+
+uint32_t intern_identifier(string_table* table, const char* name, size_t length, Compiler* compiler) {
+    return intern_hashed_identifier(table, name, length, (uint32_t)hash_function(name, length), compiler);
+}
+
+uint32_t intern_hashed_identifier(string_table* table, const char* name, size_t length, uint32_t hash, Compiler* compiler) {
+    size_t slot = hash & table->slot_mask;
+    while (table->slots[slot] != 0) {
+        uint32_t id = table->slots[slot] - 1;
+        // names only get compared once the full hash and the length agree
+        if (table->name_hashes[id] == hash && table->name_lengths[id] == length && memcmp(table->names[id], name, length) == 0) {
+            return id;
+        }
+        slot = (slot + 1) & table->slot_mask;
+    }
+
+    if (table->count == table->capacity) {
+        grow_string_table(table, compiler);
+        // the slot found above belongs to the old table
+        slot = hash & table->slot_mask;
+        while (table->slots[slot] != 0) slot = (slot + 1) & table->slot_mask;
+    }
+
+    uint32_t id = table->count++;
+    table->names[id] = name;
+    table->name_lengths[id] = (uint32_t)length;
+    table->name_hashes[id] = hash;
+    table->slots[slot] = id + 1;
+    return id;
+}
@@ -0,0 +1,16 @@
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include "utilities/utils.h"
+#include <stddef.h>
+
+string_table* make_string_table(size_t expected_names, Compiler* compiler);
+void free_string_table(string_table* table);
+void reset_string_table(string_table* table);
+
+// returns the symbol id of name, adding it the first time it is seen
+uint32_t intern_identifier(string_table* table, const char* name, size_t length, Compiler* compiler);
+// same, for a name whose hash_function() value is already known (merging another table's names)
+uint32_t intern_hashed_identifier(string_table* table, const char* name, size_t length, uint32_t hash, Compiler* compiler);
+
+#endif
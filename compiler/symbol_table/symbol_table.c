@@ -3,25 +3,40 @@
 #include "symbol_table/symbol_table.h"
 #include "error_handler/error_handler.h"
 #include <stddef.h>
+#include <string.h>
 
-size_t get_data_type_size(data_type* type, Compiler* compiler) {
-    switch (type->data_type_family) {
-        case FAMILY_FLAT:
-            return Data_type_sizes_from_data_types[type->general_data_type];
-        case FAMILY_POINTER:
-            return 8; // A pointer is 8 bytes
-        case FAMILY_ARRAY:
-            return type->array_type.array_length * get_data_type_size(type->array_type.array_of, compiler);
-        case FAMILY_ADDRESS:
-            return 8; // An address is also 8 bytes
-        default:
-            panic(ERROR_INTERNAL, "Unkown DATA TYPE, trying to get its size", compiler);
-    }
+// the type table worked the size out when the type was interned, an array's from its element's
+size_t get_data_type_size(data_type* type) {
+    return type->size;
+}
+
+// FxHash style: fold the name in 8 byte words with a rotate, xor and multiply, then finalize so masking
+// with a power of two table size still sees every byte of the name
+#define HASH_MULTIPLIER 0x517cc1b727220a95ull
+
+static inline uint64_t hash_word(uint64_t hash, uint64_t word)
+{
+    return (((hash << 5) | (hash >> 59)) ^ word) * HASH_MULTIPLIER;
 }
 
 size_t hash_function(const char* var_name, size_t var_name_length)
 {
-    return ((var_name[0] + 'a') * var_name_length + var_name[var_name_length - 1] * var_name_length / 2);
+    uint64_t hash = var_name_length;
+    size_t i = 0;
+    for (; i + 8 <= var_name_length; i += 8) {
+        uint64_t word;
+        memcpy(&word, &var_name[i], 8);
+        hash = hash_word(hash, word);
+    }
+    if (i < var_name_length) {
+        uint64_t word = 0;
+        memcpy(&word, &var_name[i], var_name_length - i);
+        hash = hash_word(hash, word);
+    }
+    // a multiply only moves entropy upwards, so fold the top half back down and mix once more
+    hash ^= hash >> 32;
+    hash *= HASH_MULTIPLIER;
+    return (size_t)(hash ^ (hash >> 29));
 }
 
 symbol_table* peek_symbol_stack(Compiler* compiler) {
@@ -35,13 +50,103 @@ symbol_table* peek_symbol_stack(Compiler* compiler) {
     return current_table;
 }
 
-void enter_new_function_scope(Compiler* compiler, data_type* return_data_type) {
-    if (!compiler) panic(ERROR_UNDEFINED, "Compiler not initialized", compiler);
+static scope_binding* make_bindings(uint32_t slot_count, Compiler* compiler) {
+    scope_binding* bindings = calloc(slot_count, sizeof(scope_binding));
+    if (!bindings) panic(ERROR_MEMORY_ALLOCATION, "Symbol table allocation failed", compiler);
+    return bindings;
+}
+
+// the bindings start empty, or as a copy of visible's for a body parsing worker that sees the global scope
+void init_scope_bindings(symbol_table_stack* stack, const symbol_table_stack* visible, Compiler* compiler) {
+    uint32_t slot_count = visible ? visible->binding_mask + 1 : 64;
+    stack->bindings = make_bindings(slot_count, compiler);
+    stack->binding_mask = slot_count - 1;
+    stack->binding_count = 0;
+    if (visible) {
+        memcpy(stack->bindings, visible->bindings, slot_count * sizeof(scope_binding));
+        stack->binding_count = visible->binding_count;
+    }
+    stack->undo_capacity = 64;
+    stack->undo_count = 0;
+    stack->undo = malloc(stack->undo_capacity * sizeof(scope_undo));
+    if (!stack->undo) panic(ERROR_MEMORY_ALLOCATION, "Symbol table allocation failed", compiler);
+}
+
+// forgets every name but keeps the memory, for a compiler that goes on to its next program
+void reset_scope_bindings(symbol_table_stack* stack) {
+    memset(stack->bindings, 0, (stack->binding_mask + 1) * sizeof(scope_binding));
+    stack->binding_count = 0;
+    stack->undo_count = 0;
+}
+
+void free_scope_bindings(symbol_table_stack* stack) {
+    free(stack->bindings);
+    free(stack->undo);
+    stack->bindings = NULL;
+    stack->undo = NULL;
+}
+
+// symbol ids are dense, the multiply spreads neighbouring ids over the whole of a table keyed by them
+static inline uint32_t spread_symbol_id(uint32_t symbol_id) {
+    uint32_t hash = symbol_id * 0x9e3779b1u;
+    return hash ^ (hash >> 15);
+}
+
+// the slot of symbol_id, or the empty one it would take
+static uint32_t binding_slot(const symbol_table_stack* stack, uint32_t symbol_id) {
+    uint32_t slot = spread_symbol_id(symbol_id) & stack->binding_mask;
+    while (stack->bindings[slot].symbol_id != 0 && stack->bindings[slot].symbol_id != symbol_id + 1) {
+        slot = (slot + 1) & stack->binding_mask;
+    }
+    return slot;
+}
+
+static void grow_bindings(symbol_table_stack* stack, Compiler* compiler) {
+    scope_binding* old_bindings = stack->bindings;
+    uint32_t old_count = stack->binding_mask + 1;
+    stack->bindings = make_bindings(old_count * 2, compiler);
+    stack->binding_mask = old_count * 2 - 1;
+    for (uint32_t s = 0; s < old_count; s++) {
+        if (old_bindings[s].symbol_id != 0) stack->bindings[binding_slot(stack, old_bindings[s].symbol_id - 1)] = old_bindings[s];
+    }
+    free(old_bindings);
+}
+
+// makes node the innermost declaration of its name, what it hides goes on the undo log
+static void bind_symbol(Compiler* compiler, symbol_node* node) {
+    symbol_table_stack* stack = compiler->symbol_table_stack;
+    // keep the slots at most half full
+    if ((stack->binding_count + 1) * 2 > stack->binding_mask + 1) grow_bindings(stack, compiler);
+    if (stack->undo_count == stack->undo_capacity) {
+        scope_undo* undo = realloc(stack->undo, stack->undo_capacity * 2 * sizeof(scope_undo));
+        if (!undo) panic(ERROR_MEMORY_ALLOCATION, "Declared too many variables for your memory", compiler);
+        stack->undo = undo;
+        stack->undo_capacity *= 2;
+    }
+
+    scope_binding* binding = &stack->bindings[binding_slot(stack, node->symbol_id)];
+    if (binding->symbol_id == 0) {
+        binding->symbol_id = node->symbol_id + 1;
+        stack->binding_count++;
+    }
+    stack->undo[stack->undo_count++] = (scope_undo){ node->symbol_id, binding->depth, binding->node };
+    binding->depth = stack->current_size - 1;
+    binding->node = node;
+}
+
+static void push_scope(Compiler* compiler, symbol_table* new_table) {
     if (compiler->symbol_table_stack->current_size + 1 >= compiler->symbol_table_stack->capacity) {
         compiler->symbol_table_stack->storage = realloc(compiler->symbol_table_stack->storage, compiler->symbol_table_stack->capacity * 2 * sizeof(symbol_table*));
         compiler->symbol_table_stack->capacity *= 2;
     }
     if (!compiler->symbol_table_stack->storage) panic(ERROR_MEMORY_ALLOCATION, "Entered too many scopes for your memory", compiler);
+    new_table->undo_mark = compiler->symbol_table_stack->undo_count;
+    compiler->symbol_table_stack->storage[compiler->symbol_table_stack->current_size] = new_table;
+    compiler->symbol_table_stack->current_size++;
+}
+
+void enter_new_function_scope(Compiler* compiler, data_type* return_data_type) {
+    if (!compiler) panic(ERROR_UNDEFINED, "Compiler not initialized", compiler);
     symbol_table* new_table = arena_alloc(compiler->symbol_arena, sizeof(symbol_table), compiler);
     if (!new_table) panic(ERROR_MEMORY_ALLOCATION, "New symbol table allocation failed", compiler);
     
@@ -49,23 +154,13 @@ void enter_new_function_scope(Compiler* compiler, data_type* return_data_type) {
     new_table->scope_data_type = return_data_type;
     new_table->scope_offset = 0;
 
-    new_table->symbol_map = arena_alloc(compiler->symbol_arena, 16 * sizeof(symbol_node*), compiler);
-    if (!new_table->symbol_map) panic(ERROR_MEMORY_ALLOCATION, "new scope unable to be declared, not enough memory", compiler);
-    memset(new_table->symbol_map, 0, 16 * sizeof(symbol_node*));
-    
-    compiler->symbol_table_stack->storage[compiler->symbol_table_stack->current_size] = new_table;
-    compiler->symbol_table_stack->current_size++;
+    push_scope(compiler, new_table);
     compiler->current_function_symbol_table = new_table;
 }
 
 
 void enter_new_scope(Compiler* compiler, data_type* scope_data_type) {
     if (!compiler) panic(ERROR_UNDEFINED, "Compiler not initialized", compiler);
-    if (compiler->symbol_table_stack->current_size + 1 >= compiler->symbol_table_stack->capacity) {
-        compiler->symbol_table_stack->storage = realloc(compiler->symbol_table_stack->storage, compiler->symbol_table_stack->capacity * 2 * sizeof(symbol_table*));
-        compiler->symbol_table_stack->capacity *= 2;
-    }
-    if (!compiler->symbol_table_stack->storage) panic(ERROR_MEMORY_ALLOCATION, "Entered too many scopes for your memory", compiler);
     symbol_table* new_table = arena_alloc(compiler->symbol_arena, sizeof(symbol_table), compiler);
     if (!new_table) panic(ERROR_MEMORY_ALLOCATION, "New symbol table allocation failed", compiler);
     
@@ -73,68 +168,51 @@ void enter_new_scope(Compiler* compiler, data_type* scope_data_type) {
     new_table->scope_data_type = scope_data_type;
     new_table->scope_offset = compiler->current_function_symbol_table->scope_offset;
 
-    new_table->symbol_map = arena_alloc(compiler->symbol_arena, 16 * sizeof(symbol_node*), compiler);
-    if (!new_table->symbol_map) panic(ERROR_MEMORY_ALLOCATION, "new scope unable to be declared, not enough memory", compiler);
-    memset(new_table->symbol_map, 0, 16 * sizeof(symbol_node*));
-    
-    compiler->symbol_table_stack->storage[compiler->symbol_table_stack->current_size] = new_table;
-    compiler->symbol_table_stack->current_size++;
+    push_scope(compiler, new_table);
 }
 
 
 symbol_node* add_var_to_current_scope(Compiler* compiler, expression* variable, variable_storage_type storage_type, normal_register reg_location) {
-    symbol_node** new_symbol;
-    size_t hash = hash_function(variable->variable.name, variable->variable.length);
-    if (peek_symbol_stack(compiler)->parent_scope == NULL)
-    {
-        new_symbol = &peek_symbol_stack(compiler)->symbol_map[hash % BUCKETS_IN_EACH_SYMBOL_MAP];
-    }
-    else
-    {
-        new_symbol = &peek_symbol_stack(compiler)->symbol_map[hash % BUCKETS_IN_EACH_SYMBOL_MAP];
-    }
-    
-    while (*new_symbol != NULL) {
-        if ((*new_symbol)->var_name_size == variable->variable.length && 
-            !strncmp((*new_symbol)->var_name, variable->variable.name, variable->variable.length)) {
-            panic(ERROR_INTERNAL, "Variable already declared in this scope", compiler);
-        }
-        new_symbol = &(*new_symbol)->next;
+    uint32_t symbol_id = variable->variable.symbol_id;
+    symbol_table_stack* stack = compiler->symbol_table_stack;
+    const scope_binding* previous = &stack->bindings[binding_slot(stack, symbol_id)];
+    if (previous->node && previous->depth == stack->current_size - 1) {
+        panic(ERROR_INTERNAL, "Variable already declared in this scope", compiler);
     }
 
-    (*new_symbol) = arena_alloc(compiler->symbol_arena, sizeof(symbol_node), compiler);
-    (*new_symbol)->next = NULL;
-    (*new_symbol)->var_name = variable->variable.name;
-    (*new_symbol)->var_name_size = variable->variable.length;
-    (*new_symbol)->data_type = variable->variable.data_type;
-    (*new_symbol)->where_it_is_stored = storage_type;
+    symbol_node* new_symbol = arena_alloc(compiler->symbol_arena, sizeof(symbol_node), compiler);
+    new_symbol->var_name = variable->variable.name;
+    new_symbol->var_name_size = variable->variable.length;
+    new_symbol->symbol_id = symbol_id;
+    new_symbol->data_type = variable->result_type;
+    new_symbol->where_it_is_stored = storage_type;
     switch (storage_type)
     {
     case STORE_IN_STACK:
-        if (variable->variable.data_type->data_type_family == FAMILY_ARRAY) {
-            size_t len = variable->variable.data_type->array_type.array_length;
-            size_t element_size = get_data_type_size(variable->variable.data_type->array_type.array_of, compiler);
+        if (variable->result_type->data_type_family == FAMILY_ARRAY) {
+            size_t len = variable->result_type->array_type.array_length;
+            size_t element_size = get_data_type_size(variable->result_type->array_type.array_of);
             peek_symbol_stack(compiler)->scope_offset += (len * element_size);
             if (peek_symbol_stack(compiler)->scope_offset > compiler->current_function_symbol_table->scope_offset) {
                 compiler->current_function_symbol_table->scope_offset = peek_symbol_stack(compiler)->scope_offset;
             }
-            (*new_symbol)->offset = peek_symbol_stack(compiler)->scope_offset;
+            new_symbol->offset = peek_symbol_stack(compiler)->scope_offset;
             break;
         }
         else {
-            peek_symbol_stack(compiler)->scope_offset += get_data_type_size(variable->variable.data_type, compiler);
+            peek_symbol_stack(compiler)->scope_offset += get_data_type_size(variable->result_type);
             if (peek_symbol_stack(compiler)->scope_offset > compiler->current_function_symbol_table->scope_offset) {
                 compiler->current_function_symbol_table->scope_offset = peek_symbol_stack(compiler)->scope_offset;
             }
-            (*new_symbol)->offset = peek_symbol_stack(compiler)->scope_offset;
+            new_symbol->offset = peek_symbol_stack(compiler)->scope_offset;
             break;
         }
     case STORE_IN_REGISTER:
-        (*new_symbol)->register_location = reg_location;
+        new_symbol->register_location = reg_location;
         break;
     case STORE_AS_PARAM:
-        peek_symbol_stack(compiler)->param_offset += get_data_type_size(variable->variable.data_type, compiler);
-        (*new_symbol)->param_offset = 8 + peek_symbol_stack(compiler)->param_offset; // 8 for the return pointer
+        peek_symbol_stack(compiler)->param_offset += get_data_type_size(variable->result_type);
+        new_symbol->param_offset = 8 + peek_symbol_stack(compiler)->param_offset; // 8 for the return pointer
         break;
     case STORE_IN_FLOAT_REGISTER:
         //TO DO     
@@ -143,77 +221,103 @@ symbol_node* add_var_to_current_scope(Compiler* compiler, expression* variable,
     default:
         break;
     }
-    return (*new_symbol);
+    bind_symbol(compiler, new_symbol);
+    return new_symbol;
 }
 
 
-symbol_node* find_variable(Compiler* compiler, uint32_t hash, char* var_name, uint32_t var_name_length) {
+symbol_node* find_variable(Compiler* compiler, uint32_t symbol_id) {
     if(!compiler || !compiler->symbol_table_stack) panic(ERROR_UNDEFINED, "Scope Stack not initialized.", compiler);
-    if(!compiler->symbol_table_stack->storage) panic(ERROR_UNDEFINED, "Scope Stack storage not initialized.", compiler);
-    int64_t i = compiler->symbol_table_stack->current_size - 1;
-    while (i >= 0)
-    {
-        symbol_table* current_table = compiler->symbol_table_stack->storage[i];
-        symbol_node* searcher;
-        if (current_table->parent_scope == NULL)
-        {
-            searcher = current_table->symbol_map[hash % BUCKETS_IN_EACH_SYMBOL_MAP];
-        }
-        else{
-            searcher = current_table->symbol_map[hash % BUCKETS_IN_EACH_SYMBOL_MAP];
-        }
-        while (searcher != NULL)
-        {
-            if (searcher->var_name_size == var_name_length)
-            {
-                if (strncmp(searcher->var_name, var_name, var_name_length) == 0)
-                {
-                    return searcher;
-                }
-                
-            }
-            searcher = searcher->next;
-        }
-        i--;
-    }
-    return NULL;
+    if(!compiler->symbol_table_stack->bindings) panic(ERROR_UNDEFINED, "Scope Stack storage not initialized.", compiler);
+    return compiler->symbol_table_stack->bindings[binding_slot(compiler->symbol_table_stack, symbol_id)].node;
 }
 
 
 
-void append_function_to_func_map(function_node* function_node_input, size_t hash, Compiler* compiler) {
-    
-    function_node** bucket = &(compiler->function_map[hash % BUCKETS_FUNCTION_TABLE]);
-    while (*bucket != NULL) {
-        if ((*bucket)->name_length == function_node_input->name_length && 
-            !strncmp((*bucket)->name, function_node_input->name, function_node_input->name_length)) {
-            panic(ERROR_INTERNAL, "Function already declared before", compiler);
-        }
-        bucket = &(*bucket)->next;
+static function_slot* make_function_slots(uint32_t slot_count, Compiler* compiler) {
+    function_slot* slots = calloc(slot_count, sizeof(function_slot));
+    if (!slots) panic(ERROR_MEMORY_ALLOCATION, "Function map allocation failed", compiler);
+    return slots;
+}
+
+function_table* make_function_map(Compiler* compiler) {
+    function_table* map = malloc(sizeof(function_table));
+    if (!map) panic(ERROR_MEMORY_ALLOCATION, "Function map allocation failed", compiler);
+    map->slots = make_function_slots(64, compiler);
+    map->slot_mask = 63;
+    map->count = 0;
+    return map;
+}
+
+void free_function_map(function_table* map) {
+    free(map->slots);
+    free(map);
+}
+
+// forgets every function but keeps the slots, for a compiler that goes on to its next program
+void reset_function_map(function_table* map) {
+    memset(map->slots, 0, (map->slot_mask + 1) * sizeof(function_slot));
+    map->count = 0;
+}
+
+// the slot of symbol_id, or the empty one it would take
+static uint32_t function_slot_of(const function_table* map, uint32_t symbol_id) {
+    uint32_t slot = spread_symbol_id(symbol_id) & map->slot_mask;
+    while (map->slots[slot].symbol_id != 0 && map->slots[slot].symbol_id != symbol_id + 1) {
+        slot = (slot + 1) & map->slot_mask;
     }
-    *bucket = function_node_input;
-    function_node_input->next = NULL;
+    return slot;
 }
 
+// makes room for functions in all without growing again, the functions already in the map are moved over
+void reserve_function_map(function_table* map, size_t functions, Compiler* compiler) {
+    uint32_t slot_count = map->slot_mask + 1;
+    while (slot_count < functions * 2) slot_count *= 2;
+    if (slot_count == map->slot_mask + 1) return;
 
-function_node* find_function_symbol_node (char* function_name, size_t function_name_length, size_t hash, Compiler* compiler) {
-    
-    function_node** bucket = &(compiler->function_map[hash % BUCKETS_FUNCTION_TABLE]);
-    while (*bucket != NULL) {
-        if ((*bucket)->name_length == function_name_length && 
-            !strncmp((*bucket)->name, function_name, function_name_length)) {
-            return *bucket;
-        }
-        bucket = &(*bucket)->next;
+    function_slot* old_slots = map->slots;
+    uint32_t old_count = map->slot_mask + 1;
+    map->slots = make_function_slots(slot_count, compiler);
+    map->slot_mask = slot_count - 1;
+    for (uint32_t s = 0; s < old_count; s++) {
+        if (old_slots[s].symbol_id != 0) map->slots[function_slot_of(map, old_slots[s].symbol_id - 1)] = old_slots[s];
+    }
+    free(old_slots);
+}
+
+void append_function_to_func_map(function_node* function_node_input, Compiler* compiler) {
+    function_table* map = compiler->function_map;
+    // keep the slots at most half full
+    reserve_function_map(map, (size_t)map->count + 1, compiler);
+    function_slot* slot = &map->slots[function_slot_of(map, function_node_input->symbol_id)];
+    if (slot->symbol_id != 0) {
+        panic(ERROR_INTERNAL, "Function already declared before", compiler);
     }
-    panic(ERROR_UNDEFINED_FUNCTION, "Function not defined", compiler);
-    return NULL; 
+    slot->symbol_id = function_node_input->symbol_id + 1;
+    slot->node = function_node_input;
+    map->count++;
 }
 
 
+function_node* find_function_symbol_node (uint32_t symbol_id, Compiler* compiler) {
+    function_slot* slot = &compiler->function_map->slots[function_slot_of(compiler->function_map, symbol_id)];
+    if (slot->symbol_id == 0) panic(ERROR_UNDEFINED_FUNCTION, "Function not defined", compiler);
+    return slot->node;
+}
+
+
+// puts back every binding the scope's declarations replaced
 void exit_current_scope(Compiler* compiler) {
-    if (compiler->symbol_table_stack->current_size > 1) {
-        compiler->symbol_table_stack->current_size--;
+    symbol_table_stack* stack = compiler->symbol_table_stack;
+    if (stack->current_size > 1) {
+        uint32_t mark = stack->storage[stack->current_size - 1]->undo_mark;
+        while (stack->undo_count > mark) {
+            scope_undo* undo = &stack->undo[--stack->undo_count];
+            scope_binding* binding = &stack->bindings[binding_slot(stack, undo->symbol_id)];
+            binding->depth = undo->depth;
+            binding->node = undo->node;
+        }
+        stack->current_size--;
     } else {
         panic(ERROR_INTERNAL, "Tried to exit global scope", compiler);
     }
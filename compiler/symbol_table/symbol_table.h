@@ -7,14 +7,21 @@
 size_t hash_function(const char* var_name, size_t var_name_length);
 symbol_node* add_var_to_current_scope(Compiler* compiler, expression* variable, variable_storage_type storage_type, normal_register reg_location);
 symbol_table* peek_symbol_stack(Compiler* compiler);
-symbol_node* find_variable(Compiler* compiler, uint32_t hash, char* var_name, uint32_t var_name_length);
+symbol_node* find_variable(Compiler* compiler, uint32_t symbol_id);
 
 void enter_new_scope(Compiler* compiler, data_type* scope_data_type);
 void exit_current_scope(Compiler* compiler);
 void enter_new_function_scope(Compiler* compiler, data_type* return_data_type);
+void init_scope_bindings(symbol_table_stack* stack, const symbol_table_stack* visible, Compiler* compiler);
+void reset_scope_bindings(symbol_table_stack* stack);
+void free_scope_bindings(symbol_table_stack* stack);
 
-size_t get_data_type_size(data_type* type, Compiler* compiler);
-void append_function_to_func_map(function_node* function_node_input, size_t hash, Compiler* compiler);
-function_node* find_function_symbol_node (char* function_name, size_t function_name_length, size_t hash, Compiler* compiler);
+size_t get_data_type_size(data_type* type);
+void append_function_to_func_map(function_node* function_node_input, Compiler* compiler);
+function_node* find_function_symbol_node (uint32_t symbol_id, Compiler* compiler);
+function_table* make_function_map(Compiler* compiler);
+void free_function_map(function_table* map);
+void reset_function_map(function_table* map);
+void reserve_function_map(function_table* map, size_t functions, Compiler* compiler);
 
 #endif
\ No newline at end of file
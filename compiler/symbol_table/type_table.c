@@ -0,0 +1,171 @@
+#include "utilities/utils.h"
+#include "arena/arena.h"
+#include "symbol_table/type_table.h"
+#include "error_handler/error_handler.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TYPE_HASH_MULTIPLIER 0x9e3779b97f4a7c15ull
+
+static data_type** make_slots(uint32_t slot_count, Compiler* compiler) {
+    data_type** slots = calloc(slot_count, sizeof(data_type*));
+    if (!slots) panic(ERROR_MEMORY_ALLOCATION, "type table allocation failed", compiler);
+    return slots;
+}
+
+type_table* make_type_table(Compiler* compiler) {
+    type_table* table = malloc(sizeof(type_table));
+    if (!table) panic(ERROR_MEMORY_ALLOCATION, "type table allocation failed", compiler);
+    memset(table->flat, 0, sizeof(table->flat));
+    for (Data_type type = 0; type <= DATA_TYPE_VOID; type++) {
+        data_type* flat = &table->flat[type];
+        flat->data_type_family = FAMILY_FLAT;
+        flat->general_data_type = type;
+        flat->size = Data_type_sizes_from_data_types[type];
+        flat->is_signed = Data_is_signed[type];
+    }
+    table->flat[DATA_TYPE_INT].flat_type.flat_data_type = TOK_INT;
+    table->flat[DATA_TYPE_LONG].flat_type.flat_data_type = TOK_LONG;
+    table->flat[DATA_TYPE_FLOAT].flat_type.flat_data_type = TOK_FLOAT;
+    table->flat[DATA_TYPE_DOUBLE].flat_type.flat_data_type = TOK_DOUBLE;
+
+    // a program writes a handful of pointer and array types, the slots double when that is not enough
+    table->slots = make_slots(64, compiler);
+    table->slot_mask = 63;
+    table->count = 0;
+    table->arena = initialize_arena(4 * 1024);
+    if (!table->arena) panic(ERROR_MEMORY_ALLOCATION, "type table allocation failed", compiler);
+    pthread_mutex_init(&table->lock, NULL);
+    return table;
+}
+
+void free_type_table(type_table* table) {
+    pthread_mutex_destroy(&table->lock);
+    free_arena(table->arena);
+    free(table->slots);
+    free(table);
+}
+
+// forgets the derived types but keeps the memory, the flat ones never change
+void reset_type_table(type_table* table) {
+    arena_reset(table->arena);
+    memset(table->slots, 0, (table->slot_mask + 1) * sizeof(data_type*));
+    table->count = 0;
+}
+
+data_type* intern_flat_type(Data_type type, Compiler* compiler) {
+    if (type > DATA_TYPE_VOID) panic(ERROR_INTERNAL, "Not a flat data type", compiler);
+    return &compiler->types->flat[type];
+}
+
+// a derived type is found by its family, what it is made from and its length
+static data_type* base_of(const data_type* type) {
+    switch (type->data_type_family) {
+        case FAMILY_POINTER:
+            return type->pointer_type.base_type;
+        case FAMILY_ADDRESS:
+            return type->address_type.base_type;
+        case FAMILY_ARRAY:
+            return type->array_type.array_of;
+        default:
+            return NULL;
+    }
+}
+
+static size_t length_of(const data_type* type) {
+    return type->data_type_family == FAMILY_ARRAY ? type->array_type.array_length : 0;
+}
+
+static uint32_t type_hash(data_type_family family, const data_type* base, size_t length) {
+    uint64_t hash = ((uint64_t)(uintptr_t)base ^ family) * TYPE_HASH_MULTIPLIER;
+    hash = (hash ^ length) * TYPE_HASH_MULTIPLIER;
+    return (uint32_t)(hash >> 32);
+}
+
+static size_t find_slot(type_table* table, data_type_family family, const data_type* base, size_t length) {
+    size_t slot = type_hash(family, base, length) & table->slot_mask;
+    for (data_type* type = table->slots[slot]; type; type = table->slots[slot]) {
+        if (type->data_type_family == family && base_of(type) == base && length_of(type) == length) break;
+        slot = (slot + 1) & table->slot_mask;
+    }
+    return slot;
+}
+
+static void grow_type_table(type_table* table, Compiler* compiler) {
+    uint32_t slot_count = (table->slot_mask + 1) * 2;
+    data_type** slots = calloc(slot_count, sizeof(data_type*));
+    if (!slots) {
+        pthread_mutex_unlock(&table->lock);
+        panic(ERROR_MEMORY_ALLOCATION, "too many data types, type table out of memory", compiler);
+    }
+    data_type** old_slots = table->slots;
+    uint32_t old_count = table->slot_mask + 1;
+    table->slots = slots;
+    table->slot_mask = slot_count - 1;
+    for (uint32_t s = 0; s < old_count; s++) {
+        data_type* type = old_slots[s];
+        if (type) table->slots[find_slot(table, type->data_type_family, base_of(type), length_of(type))] = type;
+    }
+    free(old_slots);
+}
+
+static data_type* intern_derived_type(data_type_family family, data_type* base, size_t length, Compiler* compiler) {
+    type_table* table = compiler->types;
+    pthread_mutex_lock(&table->lock);
+    size_t slot = find_slot(table, family, base, length);
+    data_type* type = table->slots[slot];
+    if (type) {
+        pthread_mutex_unlock(&table->lock);
+        return type;
+    }
+
+    // keep the slots at most half full
+    if ((table->count + 1) * 2 > table->slot_mask + 1) {
+        grow_type_table(table, compiler);
+        slot = find_slot(table, family, base, length);
+    }
+    // a panic longjmps out, a server or batch compiler would find the lock still held on its next program
+    type = arena_try_alloc(table->arena, sizeof(data_type));
+    if (!type) {
+        pthread_mutex_unlock(&table->lock);
+        panic(ERROR_MEMORY_ALLOCATION, "too many data types, type table out of memory", compiler);
+    }
+    memset(type, 0, sizeof(data_type));
+    type->data_type_family = family;
+    switch (family) {
+        case FAMILY_POINTER:
+            type->general_data_type = DATA_TYPE_POINTER;
+            type->pointer_type.base_type = base;
+            type->size = 8;
+            break;
+        case FAMILY_ADDRESS:
+            type->general_data_type = DATA_TYPE_ADDRESS;
+            type->address_type.base_type = base;
+            type->size = 8;
+            break;
+        default:
+            type->general_data_type = DATA_TYPE_ARRAY;
+            type->array_type.array_of = base;
+            type->array_type.array_length = length;
+            type->size = length * base->size;
+            break;
+    }
+    table->slots[slot] = type;
+    table->count++;
+    pthread_mutex_unlock(&table->lock);
+    return type;
+}
+
+data_type* intern_pointer_type(data_type* base_type, Compiler* compiler) {
+    return intern_derived_type(FAMILY_POINTER, base_type, 0, compiler);
+}
+
+data_type* intern_address_type(data_type* base_type, Compiler* compiler) {
+    return intern_derived_type(FAMILY_ADDRESS, base_type, 0, compiler);
+}
+
+data_type* intern_array_type(data_type* element_type, size_t array_length, Compiler* compiler) {
+    return intern_derived_type(FAMILY_ARRAY, element_type, array_length, compiler);
+}
@@ -0,0 +1,17 @@
+#ifndef TYPE_TABLE_H
+#define TYPE_TABLE_H
+
+#include "utilities/utils.h"
+#include <stddef.h>
+
+type_table* make_type_table(Compiler* compiler);
+void free_type_table(type_table* table);
+void reset_type_table(type_table* table);
+
+// the one data_type of each kind, made the first time it is asked for
+data_type* intern_flat_type(Data_type type, Compiler* compiler);
+data_type* intern_pointer_type(data_type* base_type, Compiler* compiler);
+data_type* intern_address_type(data_type* base_type, Compiler* compiler);
+data_type* intern_array_type(data_type* element_type, size_t array_length, Compiler* compiler);
+
+#endif
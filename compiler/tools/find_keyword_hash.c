@@ -0,0 +1,55 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// Searches for the multiplier used by classify_identifier() in frontend/tokenization/keywords.h.
+// A keyword (at most 8 bytes) is packed into a zero padded little endian u64 and lands in slot
+// ((word * multiplier) >> 32) % KEYWORD_COUNT, the search stops at the first multiplier that gives every
+// keyword its own slot and prints the table in the order keywords.h wants it.
+// build: gcc -O2 tools/find_keyword_hash.c -o tools/find_keyword_hash
+
+static const char* keywords[] = {
+    "exit", "let", "if", "else", "while", "for", "fn", "return", "break", "continue",
+    "int", "float", "double", "char", "long", "bool", "void", "true", "false", "null",
+};
+#define KEYWORD_COUNT (sizeof(keywords) / sizeof(keywords[0]))
+
+int main(void)
+{
+    uint64_t words[KEYWORD_COUNT];
+    for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+        if (strlen(keywords[i]) > 8) {
+            fprintf(stderr, "keyword '%s' is longer than 8 bytes\n", keywords[i]);
+            return 1;
+        }
+        words[i] = 0;
+        memcpy(&words[i], keywords[i], strlen(keywords[i]));
+    }
+
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for (uint64_t attempt = 0; attempt < 4000000000ull; attempt++) {
+        // xorshift64
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint64_t multiplier = state | 1;
+
+        const char* slots[KEYWORD_COUNT] = {0};
+        bool collision = false;
+        for (size_t i = 0; i < KEYWORD_COUNT && !collision; i++) {
+            uint32_t slot = (uint32_t)((words[i] * multiplier) >> 32) % KEYWORD_COUNT;
+            if (slots[slot]) collision = true;
+            slots[slot] = keywords[i];
+        }
+        if (collision) continue;
+
+        printf("#define KEYWORD_COUNT %zu\n#define KEYWORD_HASH_MULTIPLIER 0x%016llxull\n\n", KEYWORD_COUNT, (unsigned long long)multiplier);
+        for (size_t slot = 0; slot < KEYWORD_COUNT; slot++) {
+            printf("    [%zu] = {\"%s\", TOK_...},\n", slot, slots[slot]);
+        }
+        return 0;
+    }
+    fprintf(stderr, "no multiplier found\n");
+    return 1;
+}
@@ -1,9 +1,6 @@
 #ifndef DEFINITIONS_H
 #define DEFINITIONS_H
 
-#define BUCKETS_GLOBAL_SYMBOLTABLE 32
-#define BUCKETS_FUNCTION_TABLE 32
-#define BUCKETS_IN_EACH_SYMBOL_MAP 16
 
 #define default_capacity 1024 * 1024 * 4;
 
@@ -0,0 +1,45 @@
+#include "utilities/heap_check.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// only linked into quark_heapcheck, where -Wl,--wrap sends the compiler's calls here. libc's own
+// allocations (stdio buffers, tmpfile) are not wrapped and not counted
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+
+// batch workers generate code side by side, each guards its own phases
+static _Thread_local const char* guarded_phase = NULL;
+
+const char* heap_guard(const char* phase)
+{
+    const char* previous = guarded_phase;
+    guarded_phase = phase;
+    return previous;
+}
+
+static void check_allocation(const char* function, size_t size)
+{
+    if (!guarded_phase) return;
+    fprintf(stderr, "heap check: %s(%zu) during %s\n", function, size, guarded_phase);
+    abort();
+}
+
+void* __wrap_malloc(size_t size)
+{
+    check_allocation("malloc", size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+    check_allocation("calloc", count * size);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size)
+{
+    check_allocation("realloc", size);
+    return __real_realloc(pointer, size);
+}
@@ -0,0 +1,20 @@
+#ifndef HEAP_CHECK_H
+#define HEAP_CHECK_H
+
+#include <stddef.h>
+
+// `make heapcheck` builds quark_heapcheck with HEAP_CHECK defined and the compiler's own malloc, calloc
+// and realloc calls wrapped at link time. an allocation while a phase is guarded aborts with the phase
+// and the size. heap_guard sets the guarded phase for this thread, NULL for none, and returns the
+// previous one so it can be put back. in a normal build it does nothing
+#ifdef HEAP_CHECK
+const char* heap_guard(const char* phase);
+#else
+static inline const char* heap_guard(const char* phase)
+{
+    (void)phase;
+    return NULL;
+}
+#endif
+
+#endif
@@ -1,4 +1,9 @@
 #include "utilities/utils.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 const int Data_type_sizes[] = {
     [TOK_INT] = 4,
@@ -140,32 +145,104 @@ const normal_register registers[] = {
     [5] = R9
 };
 
-char* readfile(const char* filename, size_t* file_length) {
-    FILE *file = fopen(filename, "rb");
-    if (file == NULL) {
-        perror("Error opening file");
-        return NULL;
-    }
-    
-    // Get file size
-    fseek(file, 0, SEEK_END);
-    size_t size = ftell(file);
-    fseek(file, 0, SEEK_SET);
-    
-    // Allocate exact size needed
-    char* content = malloc(size + 1);
+// reads a whole pipe/stdin/special file into a malloc'd buffer, growing it as data arrives
+static bool read_stream(int fd, source_file* file) {
+    size_t capacity = 64 * 1024;
+    size_t length = 0;
+    char* content = malloc(capacity + 1);
     if (content == NULL) {
         perror("Memory allocation failed");
-        fclose(file);
-        return NULL;
+        return false;
     }
-    
-    // Read entire file at once
-    *file_length = fread(content, 1, size, file);
-    content[*file_length] = '\0';
-    fclose(file);
-    return content;
+
+    while (true) {
+        if (length == capacity) {
+            char* grown = realloc(content, capacity * 2 + 1);
+            if (grown == NULL) {
+                perror("Memory allocation failed");
+                free(content);
+                return false;
+            }
+            content = grown;
+            capacity *= 2;
+        }
+        ssize_t got = read(fd, content + length, capacity - length);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            perror("Error reading file");
+            free(content);
+            return false;
+        }
+        if (got == 0) break;
+        length += (size_t)got;
+    }
+
+    content[length] = '\0';
+    file->content = content;
+    file->length = length;
+    file->mapping_size = 0;
+    return true;
+}
+
+bool readfile(const char* filename, source_file* file) {
+    if (strcmp(filename, "-") == 0) {
+        return read_stream(STDIN_FILENO, file);
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror("Error opening file");
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0) {
+        // pipes, fifos and /dev/stdin can't be mapped
+        bool ok = read_stream(fd, file);
+        close(fd);
+        return ok;
+    }
+
+    // Map the file privately (copy on write, nothing is ever written back) on top of an anonymous
+    // reservation that is at least one page larger, so content[length] is always a readable '\0'
+    // even when the file size is an exact multiple of the page size.
+    size_t size = (size_t)info.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapping_size = (size / page + 1) * page;
+
+    char* reserved = mmap(NULL, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+        bool ok = read_stream(fd, file);
+        close(fd);
+        return ok;
+    }
+    char* content = mmap(reserved, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    close(fd);
+    if (content == MAP_FAILED) {
+        perror("Error mapping file");
+        munmap(reserved, mapping_size);
+        return false;
+    }
+    // the tokenizer walks the file once front to back
+    madvise(content, size, MADV_SEQUENTIAL);
+
+    file->content = content;
+    file->length = size;
+    file->mapping_size = mapping_size;
+    return true;
+}
+
+void close_source_file(source_file* file) {
+    if (file->content == NULL) return;
+    if (file->mapping_size) {
+        munmap(file->content, file->mapping_size);
+    }
+    else {
+        free(file->content);
+    }
+    file->content = NULL;
 }
+
 void print_token(TokenType type) {
     switch (type) {
         // Control tokens
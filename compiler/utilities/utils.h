@@ -2,6 +2,8 @@
 #define UTILS_H
 #include "includes.h"
 #include "definetions.h"
+#include <pthread.h>
+#include <setjmp.h>
 #include <stdbool.h>
 #include <stddef.h>
 
@@ -152,10 +154,15 @@ typedef enum {
 } Data_type;
 
 
+// data types are interned by the type table (symbol_table/type_table.c), each distinct type exists once
+// and two types are the same type exactly when their pointers are. never build one by hand
 typedef struct data_type
 {
     data_type_family data_type_family;
     Data_type general_data_type; // general info on what the data type is
+    // worked out once when the type is interned
+    size_t size;      // bytes, an array's elements all together
+    bool is_signed;
     union{
         struct
         {
@@ -181,10 +188,12 @@ typedef struct data_type
     };
 } data_type;
 
+// a single token as handed out by peek()/advance(), built on demand from the token_stream
 typedef struct token
 {
-    size_t line;
+    uint32_t offset;    // byte offset in the source, diagnostics turn it into a line and column
     TokenType type;
+    uint32_t symbol_id; // interned name, only set for TOK_IDENTIFIER
     union
     {
         struct
@@ -193,16 +202,90 @@ typedef struct token
             size_t length;
         } str_value;
         long long int_value;
-        long double float_value;
+        double float_value;
     };
 } token;
 
+// payload of a TOK_NUMBER, TOK_FLOAT or TOK_IDENTIFIER token, most tokens carry none so they live in a side table
+typedef struct
+{
+    uint32_t token_index;
+    uint32_t offset; // the token's byte offset in the source, its slot in offsets holds the payload's index
+    union
+    {
+        long long int_value;
+        double float_value;
+        struct
+        {
+            uint32_t symbol_id;
+            uint32_t length; // of the name, so a peek does not scan it again
+        };
+    };
+} token_payload;
+
+// every distinct identifier in the program, interned once by the tokenizer,
+// symbol ids are dense indexes into names/name_lengths
+typedef struct
+{
+    const char **names;
+    uint32_t *name_lengths;
+    uint32_t *name_hashes; // hash_function() of each name, computed once when it is interned
+    uint32_t count;
+    uint32_t capacity;
+
+    uint32_t *slots;    // open addressing on the name hash, holds symbol id + 1 and 0 when empty
+    uint32_t slot_mask; // slot count - 1, slot count is a power of two
+} string_table;
+
+// tokenizer output stored as parallel arrays, token i is types[i] and offsets[i]. a token with a payload
+// has its payload's index in offsets instead of a source offset, so peeking it needs no search.
+// a streaming token_stream (window != 0) is lexed on demand and only keeps the last window tokens,
+// token i then lives in slot i & (window - 1) of every array
+typedef struct token_stream
+{
+    const char *source;
+    size_t source_length;
+
+    uint8_t *types;     // TokenType of every token
+    uint32_t *offsets;  // byte offset of every token in source, or its payload's index (see token_offset)
+
+    token_payload *payloads; // in token order, one per slot when streaming
+    size_t payload_count;
+    size_t payload_capacity;
+
+    size_t count;    // tokens produced so far, indexes keep counting up when streaming
+    size_t capacity; // of types and offsets, they grow together
+    size_t function_count;
+    uint32_t *function_tokens; // index of every TOK_FN, not kept when streaming since those tokens go away
+    size_t function_capacity;
+    string_table *strings; // where identifiers are interned, a tokenizer thread has its own
+
+    // lexing errors are reported through compiler, a tokenizer thread's chunk has none and sets failed instead
+    struct Compiler *compiler;
+    bool failed;
+
+    // streaming only
+    size_t window;   // ring size, a power of two, 0 when the whole file is tokenized up front
+    size_t cursor;   // source offset the next token is lexed from
+    bool finished;   // TOK_EOF has been produced
+
+    // offset of the first byte of every line, built by the first diagnostic that needs a line number
+    uint32_t *line_starts;
+    size_t line_count;
+} token_stream;
+
+// 1 based line and column of a byte in the source
+typedef struct
+{
+    size_t line;
+    size_t column;
+} source_position;
+
 // parser structure
 typedef struct Parser
 {
-    token *tokens;  // Array of tokens from tokenizer
+    token_stream *tokens;  // Array of tokens from tokenizer
     size_t current; // Current position in token array
-    size_t token_count;
     // error reporting
     size_t current_line; // Current line number
 } Parser;
@@ -252,9 +335,9 @@ typedef struct symbol_node
 {
     char *var_name;
     uint32_t var_name_size;
+    uint32_t symbol_id;
     variable_storage_type where_it_is_stored;
     data_type* data_type;
-    struct symbol_node *next;
     bool address_is_taken;
     union
     {
@@ -265,6 +348,11 @@ typedef struct symbol_node
     };
 } symbol_node;
 
+// the AST is kept in the typed arrays of struct AST, nodes refer to each other by their index there (ast/ast.h),
+// index 0 is never handed out so it stands for no node
+typedef uint32_t expr_id;
+typedef uint32_t stmt_id;
+
 typedef struct expression
 {
     ExpressionType type;   // the type of the expression
@@ -288,64 +376,63 @@ typedef struct expression
             bool bool_value;
         } boolean;
 
-        struct // variables
+        struct // variables, their data type is the result_type
         {
             char *name;
-            size_t length;
+            uint32_t length;
+            uint32_t symbol_id;
             symbol_node *node_in_table;
-            size_t hash;
-            data_type* data_type;
         } variable;
 
         // binary expressions (x + y)
         struct
         {
-            bool constant_foldable;
-            struct expression *left;
-            struct expression *right;
+            expr_id left;
+            expr_id right;
             TokenType op;
+            bool constant_foldable;
         } binary;
 
         // unary expression (-x or !x)
         struct
         {
             TokenType op; // operator
-            struct expression *operand;
+            expr_id operand;
         } unary;
 
         // function call
         struct
         {
             char *name;
-            size_t name_length;
-            struct expression *arguments;
-            size_t parameter_count;
+            uint32_t name_length;
+            uint32_t parameter_count;
+            uint32_t arguments; // where the argument ids start in the AST's id lists
         } func_call;
 
         // address (&var)
         struct
         {
-            struct expression* operand;
+            expr_id operand;
             size_t stack_offset; // for code generation, how much to subtract from rsp to get to the variable's address after leaking
         } address;
 
         // pointer dereference (ptr.*)
         struct
         {
-            struct expression* operand;
+            expr_id operand;
         } dereference;
 
         // {1, 2, 4}
         struct {
-            struct expression* elements;
-            size_t count;
+            uint32_t elements; // where the element ids start in the AST's id lists
+            uint32_t count;
         } init_list;
 
         // arr[expr]
         struct
         {
-            struct expression* array;  // could be another array_index, or a variable
-            struct expression* index;
+            expr_id array;  // could be another array_index, or a variable
+            expr_id index;
         } array_index;
     };
 
@@ -376,16 +463,32 @@ typedef struct function_node
 {
     char *name;
     size_t name_length;
-    expression *parameters;
+    uint32_t symbol_id;
+    expression *parameters; // copies, they are not part of the AST
     size_t param_count;
-    struct statement *code_block;
-    struct function_node *next;
+    stmt_id code_block;
     data_type* return_type;
 } function_node;
 
+// a function map slot, the symbol id sits next to the node so probing never leaves the slot array
+typedef struct
+{
+    uint32_t symbol_id; // + 1, 0 when empty
+    function_node *node;
+} function_slot;
+
+// every declared function, open addressing on the symbol id. malloced and kept across programs, it is
+// sized from the tokenizer's function count and doubles before it gets more than half full
+typedef struct
+{
+    function_slot *slots;
+    uint32_t slot_mask; // slot count - 1, slot count is a power of two
+    uint32_t count;
+} function_table;
+
 typedef struct symbol_table
 {
-    symbol_node **symbol_map;
+    uint32_t undo_mark; // length of the stack's undo log when the scope was entered
     struct symbol_table *parent_scope; // for fast recursion to parent scope
 
     data_type* scope_data_type; // for stuff to know what is the data type it should return
@@ -403,80 +506,78 @@ typedef struct statement
         // exit statement
         struct
         {
-            expression *exit_code;
+            expr_id exit_code;
         } stmnt_exit;
 
         // let statement
         struct
         {
-            char *name;
-            size_t name_length;
-            expression *value;
-            size_t hash;
+            symbol_node *variable; // the declaration, made when the statement is parsed
+            uint32_t symbol_id;
+            expr_id value;
         } stmnt_let;
 
         // assign an existing variable sth
         struct
         {
-            char *name;
-            size_t name_length;
-            size_t hash;
-            expression *value;
+            symbol_node *variable; // what the name meant where the statement was parsed
+            uint32_t symbol_id;
+            expr_id value;
         } stmnt_assign;
 
         // expressions that could also be considered statements (like i++, function calls)
         struct
         {
-            expression *value;
+            expr_id value;
         } stmnt_expression;
 
         // statement block, {some statements} like the ones of for loops, functions, if statements, etc
         struct
         {
-            struct statement **statements;
-            size_t statement_count;
+            uint32_t statements; // where the statement ids start in the AST's id lists
+            uint32_t statement_count;
             symbol_table *table;
         } stmnt_block;
 
         // if, else and else if
         struct
         {
-            expression *condition;     // probably a bin operation, but all could work
-            struct statement *then;    // what to do
-            struct statement *or_else; // or else what to do. could be nested for else if or NULL if there is nothing
+            expr_id condition; // probably a bin operation, but all could work
+            stmt_id then;      // what to do
+            stmt_id or_else;   // or else what to do. could be nested for else if or 0 if there is nothing
             int return_percent;
         } stmnt_if;
 
         // while
         struct
         {
-            expression *condition;
-            struct statement *body;
+            expr_id condition;
+            stmt_id body;
             size_t counter; // for labels
         } stmnt_while;
 
         // for
         struct
         {
-            struct statement *initializer; // initializer
-            expression *condition;
-            expression *increment;
-            struct statement *body;
+            stmt_id initializer; // initializer
+            expr_id condition;
+            expr_id increment;
+            stmt_id body;
         } stmnt_for;
 
         // function declaration
         struct
         {
             char *name;
-            size_t name_length;
+            uint32_t name_length;
+            uint32_t symbol_id;
             function_node *function_node;
-            size_t index;
         } stmnt_function_declaration;
 
         // return
         struct
         {
-            expression *value; // NULL for "return;"
+            expr_id value; // 0 for "return;"
             data_type* return_data_type;
         } stmnt_return;
 
@@ -488,74 +589,195 @@ typedef struct statement
 
 } statement;
 
-typedef enum
-{
-    NODE_STATEMENT,
-    NODE_EXPRESSION,
-} NodeType;
-
-// Node storage
-typedef struct node
+// token range of a function body found after signature collection, so the bodies can be parsed out of order
+typedef struct
 {
-    NodeType type;
-
-    union
-    {
-        expression *expr;
-        statement *stmnt;
-    };
-
-} node;
+    size_t start;       // its '{'
+    size_t end;         // the matching '}'
+    size_t while_base;  // while labels a serial parse hands out before this body
+    size_t while_count; // and inside it
+} function_body;
 
 typedef struct AST
 {
     Parser *parser;
-    node **nodes;
-    node **function_nodes;
+    stmt_id *nodes;       // top level statements, malloced and grown as they are parsed
+    size_t node_capacity;
+    stmt_id *function_nodes; // malloced and grown like nodes
+    size_t function_node_capacity;
     size_t function_node_count;
     size_t node_count;
+    function_body *function_bodies; // one per function node when the bodies are parsed on worker threads, else NULL
+
+    // every expression and statement of the program, malloced and doubled when full
+    expression *expressions;
+    uint32_t expression_count;
+    uint32_t expression_capacity;
+    statement *statements;
+    uint32_t statement_count;
+    uint32_t statement_capacity;
+
+    // block statements, call arguments and initializer elements, each list is a run of ids in here
+    uint32_t *lists;
+    uint32_t list_count;
+    uint32_t list_capacity;
 } AST;
 
-// Arena
-typedef struct
+// one block of an arena, what it handed out never moves, a full chunk stays and a new one is linked in
+typedef struct arena_chunk
 {
+    struct arena_chunk *next;
     size_t capacity;
-    size_t current_size;
-    uint8_t *data;
+    size_t used;
+    uint8_t data[];
+} arena_chunk;
+
+// where an arena's memory comes from, see init_compiler_arenas
+typedef enum
+{
+    ARENA_MALLOC,   // chunks are malloced as the arena grows
+    ARENA_RESERVED, // one large range of address space is reserved up front and committed as it is used
+} arena_backing;
+
+// Arena, a list of chunks with the one being allocated from first
+typedef struct
+{
+    size_t capacity;     // bytes in all chunks
+    size_t current_size; // bytes handed out
+    size_t chunk_count;
+    size_t next_chunk;   // size of the next regular chunk
+    arena_chunk *chunks;
+    arena_chunk *spare;  // the largest chunk a rewind let go of, the next growth takes it instead of mallocing
+    arena_chunk *reservation; // the chunk at the start of a reserved range, its capacity is the committed part
+
+    // what the program asked of the arena, kept for --mem-report and cleared by arena_reset
+    size_t allocations;  // arena_alloc calls
+    size_t requested;    // bytes asked for
+    size_t padding;      // bytes added to align them
+    size_t high_water;   // most bytes handed out at once
+    size_t growths;      // chunks added after the first, or commits of a reserved range
+    size_t stranded;     // free space left behind in chunks that filled up
 } Arena;
 
+// every data type of the program, the flat ones are made up front and pointers, addresses and arrays are
+// added the first time they are written. the types live in the table's own arena so the per-function rewind
+// of the expressions arena never takes one, and parse workers intern into their compiler's table under lock
+typedef struct
+{
+    data_type flat[DATA_TYPE_VOID + 1]; // indexed by Data_type
+    data_type **slots;  // open addressing on (family, base type, length), NULL when empty
+    uint32_t slot_mask; // slot count - 1, slot count is a power of two
+    uint32_t count;     // derived types in the slots
+    Arena *arena;
+    pthread_mutex_t lock;
+} type_table;
+
+// where an arena was, arena_rewind gives back everything allocated after it
+typedef struct
+{
+    arena_chunk *chunk;  // the chunk being allocated from
+    arena_chunk *behind; // what followed it, dedicated chunks linked in after the mark sit in between
+    size_t used;
+    size_t current_size;
+} arena_checkpoint;
+
+
+// the arenas --mem-report follows, bodies is every parse worker's arenas added up
+typedef enum
+{
+    REPORT_TOKENS,
+    REPORT_STATEMENTS,
+    REPORT_EXPRESSIONS,
+    REPORT_SYMBOLS,
+    REPORT_BODIES,
+    REPORT_ARENA_COUNT
+} report_arena;
+
+// an arena's numbers at the end of a compile phase
+typedef struct
+{
+    size_t allocations;
+    size_t requested;
+    size_t padding;
+    size_t used;
+    size_t high_water;
+    size_t reserved;
+    size_t stranded;
+    size_t chunks;
+    size_t growths;
+} arena_stats;
+
+typedef struct
+{
+    const char *name;
+    arena_stats arenas[REPORT_ARENA_COUNT];
+} memory_phase;
+
+// a name's innermost declaration among the scopes on the stack
+typedef struct
+{
+    uint32_t symbol_id; // + 1, 0 for a slot no name has taken
+    uint32_t depth;     // where the declaring scope is on the stack
+    symbol_node *node;  // NULL while no scope on the stack declares the name
+} scope_binding;
+
+// the binding a declaration replaced, put back when the declaring scope is left
+typedef struct
+{
+    uint32_t symbol_id;
+    uint32_t depth;
+    symbol_node *node;
+} scope_undo;
+
 typedef struct
 {
     uint32_t capacity;
     uint32_t current_size;
     struct symbol_table **storage;
+
+    // one open-addressing table on the symbol id for all the scopes at once, a lookup is a single probe
+    // whatever the nesting. a name keeps its slot when its scope is left, only the binding goes
+    scope_binding *bindings;
+    uint32_t binding_mask;  // slot count - 1, slot count is a power of two
+    uint32_t binding_count; // slots taken
+    scope_undo *undo;
+    uint32_t undo_count;
+    uint32_t undo_capacity;
 } symbol_table_stack;
 
+// ids of the elements of the lists being parsed (block statements, call arguments, ...) are pushed here until the
+// list closes and are then copied into the AST's id lists in one piece, nested lists sit on top of their parent's elements
+typedef struct
+{
+    size_t capacity;
+    size_t current_size;
+    uint32_t *storage;
+} parse_stack;
+
 typedef struct
 {
 
     // If statement counter
     size_t if_statements;
 
-    size_t* end_ifs_stack;
-    size_t end_ifs_current;
-    size_t end_ifs_capacity;
-
     // While statements counter
     size_t while_statements;
 
-    size_t* end_whiles_stack;
-    size_t end_whiles_current;
-    size_t end_whiles_capacity;
+    // the counter + 1 of the loop whose body is being generated, 0 outside loops. each while keeps
+    // the one around it on the C stack
+    size_t enclosing_while;
 } counters;
 
-typedef struct
+typedef struct Compiler
 {
     Arena *token_arena;       // For tokens and lexer data
     Arena *statements_arena;  // For AST nodes and parser data
     Arena *expressions_arena; // For string literals and identifiers
     Arena *symbol_arena;      // For symbol table (if you keep it)
 
+    // tokenizer output, the arrays are malloced and grow with the token count
+    token_stream *tokens;
+
     // parser
     Parser *parser;
 
@@ -565,8 +787,37 @@ typedef struct
     // Symbol Stack
     symbol_table_stack *symbol_table_stack;
 
-    // function map
-    function_node **function_map;
+    // elements of the lists the parser has open
+    parse_stack *parse_stack;
+
+    // function map, shared with the body parsing workers which only look functions up
+    function_table *function_map;
+
+    // interned identifiers
+    string_table *strings;
+
+    // interned data types, shared with the body parsing workers
+    type_table *types;
+
+    // worker threads a compile may use, 1 keeps everything on the calling thread
+    size_t threads;
+    // how the parse arenas get their memory, the body parsing workers make theirs the same way
+    arena_backing backing;
+
+    // statement, expression and symbol arenas the body parsing workers filled, they live as long as the AST
+    Arena **body_arenas;
+    size_t body_arena_count;
+
+    // a body parsing worker's copy of the compiler, it owns none of the memory the main compiler frees
+    bool parse_worker;
+
+    // panic() and warning() report here, stderr unless a compile server sends them to its client
+    FILE *diagnostics;
+    // when set, panic() stores the error code in failure and jumps back here instead of exiting (compile server requests)
+    jmp_buf *recover;
+    error_code failure;
+    // the assembly file being written, closed by reset_compiler_arenas if a panic leaves it open
+    FILE *output;
 
     // Buffer
     char buffer[16 * 1024];
@@ -583,6 +834,16 @@ typedef struct
 
 } Compiler;
 
+// what main's command line options ask of a compile, a compile server applies them to every request
+typedef struct compile_options
+{
+    bool mem_report;
+    const char *mem_report_json; // also write the report to this file as JSON
+    bool stream_tokens;
+    bool parallel_parse;
+    arena_backing arenas; // for the compilers a server or a batch makes
+} compile_options;
+
 // Arrays:
 extern const int Data_type_sizes[];
 extern const int Data_type_sizes_from_data_types[];
@@ -619,8 +880,17 @@ typedef enum {
 
 
 
-// file readung utility
-char *readfile(const char *filename, size_t *file_length);
+// source file, either mmapped straight from disk or read into a malloc buffer (pipes and stdin)
+typedef struct
+{
+    char *content;       // always followed by a '\0'
+    size_t length;
+    size_t mapping_size; // bytes mapped for content, 0 when content is a malloc buffer
+} source_file;
+
+// file readung utility, "-" reads stdin
+bool readfile(const char *filename, source_file *file);
+void close_source_file(source_file *file);
 void print_token(TokenType type);
 
 #endif
\ No newline at end of file